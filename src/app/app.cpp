@@ -17,6 +17,7 @@
 #include <WiFi.h>
 #include <WiFiManager.h>
 #include <Wire.h>
+#include <esp_log.h>
 
 // Configuration
 #include "../config/config_manager.h"
@@ -25,13 +26,22 @@
 
 // Core
 #include "../core/globals.h"
+#include "../core/i2c_monitor.h"
 #include "../core/messages/boot_manager.h"
 #include "../core/messages/message_center.h"
 #include "../core/messages/message_codes.h"
 
 // Services
+#include "../services/i2c_manager/i2c_clock.h"
+#include "../services/i2c_manager/i2c_engine.h"
+#include "../services/i2c_manager/i2c_trace.h"
+#include "../services/i2c_manager/presence_scanner.h"
 #include "../services/serialwombat/serialwombat_manager.h"
+#include "../services/tcp_bridge/bridge_capture_writer.h"
+#include "../services/tcp_bridge/bridge_task.h"
+#include "../services/tcp_bridge/serial_bridge.h"
 #include "../services/tcp_bridge/tcp_bridge.h"
+#include "../services/tcp_bridge/udp_bridge.h"
 #include "../services/web_server/api_handlers.h"
 #include "../services/web_server/html_templates.h"
 
@@ -94,7 +104,7 @@ App& App::getInstance() {
 }
 
 // Private constructor
-App::App() : server(80), tcpServer(TCP_PORT), tcpClient() {}
+App::App() : server(80), tcpServer(TCP_PORT) {}
 
 // ===================================================================================
 // Application Lifecycle - Initialization
@@ -173,6 +183,31 @@ void App::initConfiguration() {
   }
 }
 
+// Boot self-test: CPU cycles per trace append, best of TRACE_TEST_BATCHES
+// batches so an interrupt landing in one does not inflate the figure. Runs
+// before the I2C engine starts and empties the ring afterwards.
+#define TRACE_TEST_BATCHES 8
+#define TRACE_TEST_APPENDS 32
+
+static uint32_t measureTraceAppend() {
+  I2cTrace& trace = I2cTrace::getInstance();
+  I2cTransaction txn;
+  txn.tx_len = 2;
+  txn.rx_len = 8;
+
+  trace.setEnabled(true);
+  uint32_t best = UINT32_MAX;
+  for (int batch = 0; batch < TRACE_TEST_BATCHES; batch++) {
+    uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < TRACE_TEST_APPENDS; i++) trace.append(txn);
+    uint32_t cycles = (ESP.getCycleCount() - start) / TRACE_TEST_APPENDS;
+    if (cycles < best) best = cycles;
+  }
+  trace.clear();
+  trace.setAppendCycles(best);
+  return best;
+}
+
 void App::initHardware() {
   // Keep WiFi responsive during long flash operations
   WiFi.setSleep(false);
@@ -182,15 +217,51 @@ void App::initHardware() {
            g_cfg.i2c_sda, g_cfg.i2c_scl);
 
   Wire.begin(g_cfg.i2c_sda, g_cfg.i2c_scl);
-  Wire.setClock(100000);
+  i2cBusSetPins(I2C_BUS_PRIMARY_PORT, g_cfg.i2c_sda, g_cfg.i2c_scl);
+  uint32_t traceCycles = measureTraceAppend();
+  I2cTrace::getInstance().setEnabled(g_cfg.i2c_trace_enable);
+  msg_info("i2c", I2C_INIT_OK, "I2C Trace", "Trace append: %lu cycles (%lu ns at %lu MHz)",
+           (unsigned long)traceCycles,
+           (unsigned long)(traceCycles * 1000UL / ESP.getCpuFreqMHz()),
+           (unsigned long)ESP.getCpuFreqMHz());
+
+  // Fastest clock every device handles cleanly (probed before the engine owns the bus)
+  uint32_t hz = I2cClockController::getInstance().begin(
+      g_cfg.i2c_clock_max_hz, g_cfg.i2c_clock_auto, currentWombatAddress);
+
+  msg_info("i2c", I2C_BUS_OK, "I2C Bus Ready", "I2C initialized at %lu Hz (%s)",
+           (unsigned long)hz, g_cfg.i2c_clock_auto ? "probed" : "fixed");
+
+  // Transaction engine shares the bridge task's core so bus work stays off the loop core
+  if (!I2cEngine::getInstance().begin(g_cfg.bridge_task_core, g_cfg.bridge_task_priority)) {
+    msg_error("i2c", I2C_COMM_ERROR, "I2C Engine Failed",
+              "Could not start I2C engine task; transactions run inline");
+  }
+
+  // Optional second bus: fixed clock, its own engine task next to the first
+  if (g_cfg.i2c1_sda >= 0 && g_cfg.i2c1_scl >= 0) {
+    Wire1.begin(g_cfg.i2c1_sda, g_cfg.i2c1_scl, g_cfg.i2c1_clock_hz);
+    i2cBusSetPins(I2C_BUS_SECONDARY_PORT, g_cfg.i2c1_sda, g_cfg.i2c1_scl);
+    if (I2cEngine::getInstance(I2C_BUS_SECONDARY_PORT)
+            .begin(g_cfg.bridge_task_core, g_cfg.bridge_task_priority)) {
+      msg_info("i2c", I2C_BUS_OK, "I2C Bus 1 Ready", "SDA=%d, SCL=%d at %lu Hz", g_cfg.i2c1_sda,
+               g_cfg.i2c1_scl, (unsigned long)g_cfg.i2c1_clock_hz);
+    } else {
+      msg_error("i2c", I2C_COMM_ERROR, "I2C Bus 1 Failed",
+                "Could not start the bus 1 engine task; bus 1 is unavailable");
+    }
+  }
 
-  msg_info("i2c", I2C_BUS_OK, "I2C Bus Ready", "I2C initialized at 100kHz");
+  // Presence map for /scan-data and hot-plug events, probed between bridge transactions
+  PresenceScanner::getInstance().begin(
+      g_cfg.i2c_presence_interval_ms > 0 ? (uint32_t)g_cfg.i2c_presence_interval_ms : 0);
 
   // Initialize SerialWombat
   msg_info("serialwombat", SW_INIT_BEGIN, "SerialWombat Initialization",
-           "Initializing SerialWombat at address 0x%02X", currentWombatAddress);
+           "Initializing SerialWombat at address 0x%02X on bus %u", i2cAddr7(currentWombatAddress),
+           i2cAddrBus(currentWombatAddress));
 
-  sw.begin(Wire, currentWombatAddress);
+  swAttachCurrent();
 
   msg_info("serialwombat", SW_INIT_OK, "SerialWombat Ready",
            "SerialWombat initialized successfully");
@@ -410,6 +481,42 @@ void App::initWebServer() {
   // ===================================================================================
   server.on("/api/system", HTTP_GET, []() { handleApiSystem(App::getInstance().getWebServer()); });
 
+  // ===================================================================================
+  // Bridge diagnostics API
+  // ===================================================================================
+  server.on("/api/bridge/sessions", HTTP_GET,
+            []() { handleApiBridgeSessions(App::getInstance().getWebServer()); });
+  server.on("/api/bridge/stats", HTTP_GET,
+            []() { handleApiBridgeStats(App::getInstance().getWebServer()); });
+  server.on("/api/bridge/stats/reset", HTTP_POST,
+            []() { handleApiBridgeStatsReset(App::getInstance().getWebServer()); });
+  server.on("/api/bridge/capture", HTTP_GET,
+            []() { handleApiBridgeCapture(App::getInstance().getWebServer()); });
+  server.on("/api/bridge/capture/start", HTTP_POST,
+            []() { handleApiBridgeCaptureStart(App::getInstance().getWebServer()); });
+  server.on("/api/bridge/capture/stop", HTTP_POST,
+            []() { handleApiBridgeCaptureStop(App::getInstance().getWebServer()); });
+  server.on("/api/bridge/capture/download", HTTP_GET,
+            []() { handleApiBridgeCaptureDownload(App::getInstance().getWebServer()); });
+
+  // ===================================================================================
+  // I2C Transaction Trace API
+  // ===================================================================================
+  server.on("/api/i2c/trace", HTTP_GET,
+            []() { handleApiI2cTrace(App::getInstance().getWebServer()); });
+  server.on("/api/i2c/trace/enable", HTTP_POST,
+            []() { handleApiI2cTraceEnable(App::getInstance().getWebServer()); });
+
+  // ===================================================================================
+  // Deep Scan API (background job)
+  // ===================================================================================
+  server.on("/api/scan/start", HTTP_POST,
+            []() { handleApiScanStart(App::getInstance().getWebServer()); });
+  server.on("/api/scan/status", HTTP_GET,
+            []() { handleApiScanStatus(App::getInstance().getWebServer()); });
+  server.on("/api/scan/result", HTTP_GET,
+            []() { handleApiScanResult(App::getInstance().getWebServer()); });
+
 #if SD_SUPPORT_ENABLED
   // ===================================================================================
   // SD Card Manager API (only registered when enabled)
@@ -443,6 +550,8 @@ void App::initWebServer() {
   // ===================================================================================
   server.on("/api/variant", HTTP_GET,
             []() { handleApiVariant(App::getInstance().getWebServer()); });
+  server.on("/api/variant/invalidate", HTTP_POST,
+            []() { handleApiVariantInvalidate(App::getInstance().getWebServer()); });
   server.on("/api/apply", HTTP_POST, []() { handleApiApply(App::getInstance().getWebServer()); });
   server.on("/api/config/save", HTTP_POST,
             []() { handleConfigSave(App::getInstance().getWebServer()); });
@@ -459,9 +568,44 @@ void App::initWebServer() {
   server.begin();
   msg_info("web", WEB_SERVER_START, "Web Server Started", "HTTP server listening on port 80");
 
-  tcpServer.begin();
-  msg_info("tcp", TCP_BRIDGE_START, "TCP Bridge Started", "TCP bridge listening on port %d",
-           TCP_PORT);
+  if (!initTcpBridge(tcpServer, TCP_PORT)) {
+    msg_error("tcp", TCP_BRIDGE_FAIL, "TCP Bridge Failed", "Could not listen on TCP port %d",
+              TCP_PORT);
+  }
+  if (g_cfg.bridge_udp_enable) {
+    if (initUdpBridge(TCP_PORT)) {
+      msg_info("tcp", UDP_BRIDGE_START, "UDP Bridge Started", "UDP bridge listening on port %d",
+               TCP_PORT);
+    } else {
+      msg_error("tcp", UDP_BRIDGE_FAIL, "UDP Bridge Failed", "Could not open UDP port %d",
+                TCP_PORT);
+    }
+  }
+  if (g_cfg.bridge_serial_enable) {
+    // The bridge owns Serial from here on; keep console text out of its stream
+#if ARDUINO_USB_CDC_ON_BOOT
+    Serial0.begin(115200);
+    MessageCenter::getInstance().setConsole(&Serial0);
+    const char* console = "moved to UART0";
+#else
+    MessageCenter::getInstance().setConsole(nullptr);
+    // ESP-IDF components (WiFi, lwIP, drivers) log to UART0 too, bypassing
+    // Serial.setDebugOutput(): silence them as well
+    esp_log_level_set("*", ESP_LOG_NONE);
+    const char* console = "disabled, ESP-IDF logging off";
+#endif
+    Serial.setDebugOutput(false);  // Arduino log_x output
+    initSerialBridge();
+    msg_info("tcp", SERIAL_BRIDGE_START, "Serial Bridge Started",
+             "Bridge on the Serial port; debug console %s", console);
+  }
+  if (startBridgeTask(tcpServer, g_cfg.bridge_task_core, g_cfg.bridge_task_priority)) {
+    msg_info("tcp", TCP_BRIDGE_START, "TCP Bridge Started",
+             "TCP bridge listening on port %d (%s backend, task core %d, priority %d)", TCP_PORT,
+             tcpBridgeBackendName(), g_cfg.bridge_task_core, g_cfg.bridge_task_priority);
+  } else {
+    msg_error("tcp", TCP_BRIDGE_FAIL, "TCP Bridge Failed", "Could not create bridge tasks");
+  }
 
   boot_stage_ok(BootStage::BOOT_09_SERVICES,
                 "Web server (port 80) and TCP bridge (port %d) started", TCP_PORT);
@@ -507,9 +651,12 @@ void App::initOTA() {
 void App::update() {
   updateOTA();
   updateWebServer();
-  updateTCPBridge();
   updateDisplay();
   updateHealthSnapshot();
+  updateBridgeCapture();
+  updateI2cClock();
+  updateI2cPresence();
+  updateI2cStats();
 }
 
 // ===================================================================================
@@ -527,6 +674,82 @@ void App::updateHealthSnapshot() {
   }
 }
 
+void App::updateBridgeCapture() {
+  bridgeCaptureService();
+}
+
+void App::updateI2cClock() {
+  // Bus clears run on the engine task; report them from here
+  static uint32_t seenClears = 0;
+  static uint32_t seenClearFailures = 0;
+  I2cErrorCounters ec;
+  I2cEngine::getInstance().getErrorCounters(ec);
+  if (ec.bus_clear_failures != seenClearFailures) {
+    msg_error("i2c", I2C_BUS_STUCK, "I2C Bus Stuck",
+              "SDA still held low after bus clear (%lu failed clears)",
+              (unsigned long)ec.bus_clear_failures);
+  } else if (ec.bus_clears != seenClears) {
+    msg_warn("i2c", I2C_BUS_STUCK, "I2C Bus Recovered",
+             "SDA was held low; freed by bus clear (%lu so far)", (unsigned long)ec.bus_clears);
+  }
+  seenClears = ec.bus_clears;
+  seenClearFailures = ec.bus_clear_failures;
+
+  I2cClockChange change;
+  if (!I2cClockController::getInstance().poll(change)) return;
+
+  if (change.down) {
+    msg_warn("i2c", I2C_CLOCK_CHANGED, "I2C Clock Reduced",
+             "%lu -> %lu Hz: device 0x%02X at %u.%u%% errors", (unsigned long)change.from_hz,
+             (unsigned long)change.to_hz, change.addr, change.permille / 10,
+             change.permille % 10);
+  } else {
+    msg_info("i2c", I2C_CLOCK_CHANGED, "I2C Clock Raised", "%lu -> %lu Hz after error-free traffic",
+             (unsigned long)change.from_hz, (unsigned long)change.to_hz);
+  }
+}
+
+void App::updateI2cPresence() {
+  PresenceScanner& presence = PresenceScanner::getInstance();
+  presence.service();
+
+  PresenceEvent ev;
+  bool added = false;
+  while (presence.poll(ev)) {
+    if (ev.present) {
+      msg_info("i2c", I2C_DEVICE_ADDED, "I2C Device Added", "Device 0x%02X appeared on bus %u",
+               i2cAddr7(ev.addr), i2cAddrBus(ev.addr));
+      if (i2cAddrBus(ev.addr) == I2C_BUS_PRIMARY_PORT) added = true;
+    } else {
+      msg_warn("i2c", I2C_DEVICE_REMOVED, "I2C Device Removed",
+               "Device 0x%02X stopped answering on bus %u", i2cAddr7(ev.addr),
+               i2cAddrBus(ev.addr));
+    }
+  }
+
+  // A bus that was empty at boot runs at the floor until a device has
+  // passed the clock probe
+  I2cClockController& clock = I2cClockController::getInstance();
+  if (!added || !clock.needsLateProbe()) return;
+
+  PresenceSnapshot snap;
+  presence.getSnapshot(snap);
+  uint8_t addrs[I2C_CLOCK_MAX_TRACKED];
+  size_t count = 0;
+  for (uint8_t a = PRESENCE_FIRST_ADDR; a <= PRESENCE_LAST_ADDR; a++) {
+    if ((snap.bitmap[a >> 3] & (1 << (a & 7))) && count < I2C_CLOCK_MAX_TRACKED) {
+      addrs[count++] = a;
+    }
+  }
+  uint32_t hz = clock.probeLate(addrs, count);
+  msg_info("i2c", I2C_CLOCK_CHANGED, "I2C Clock Probed", "%lu Hz verified against %u device(s)",
+           (unsigned long)hz, (unsigned)count);
+}
+
+void App::updateI2cStats() {
+  i2cMonitorPoll();
+}
+
 void App::updateOTA() {
   ArduinoOTA.handle();
 }
@@ -535,10 +758,6 @@ void App::updateWebServer() {
   server.handleClient();
 }
 
-void App::updateTCPBridge() {
-  handleTcpBridge(tcpServer, tcpClient, currentWombatAddress);
-}
-
 void App::updateDisplay() {
 #if DISPLAY_SUPPORT_ENABLED
   if (g_lvgl_ready) {
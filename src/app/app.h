@@ -10,7 +10,7 @@
 #include <Arduino.h>
 
 #include <WebServer.h>
-#include <WiFiClient.h>
+#include <WiFiServer.h>
 
 #include "../core/messages/boot_manager.h"
 #include "../core/messages/message_center.h"
@@ -35,7 +35,6 @@ class App {
   // Core services
   WebServer server;
   WiFiServer tcpServer;
-  WiFiClient tcpClient;
 
   // Initialization phases
   void initSerial();
@@ -53,7 +52,10 @@ class App {
   // Runtime update phases
   void updateOTA();
   void updateWebServer();
-  void updateTCPBridge();
   void updateDisplay();
   void updateHealthSnapshot();
+  void updateBridgeCapture();
+  void updateI2cClock();
+  void updateI2cPresence();
+  void updateI2cStats();
 };
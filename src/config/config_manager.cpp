@@ -162,6 +162,13 @@ bool loadConfig(SystemConfig& cfg) {
 
   cfg.i2c_sda = doc["i2c_sda"] | cfg.i2c_sda;
   cfg.i2c_scl = doc["i2c_scl"] | cfg.i2c_scl;
+  cfg.i2c_clock_max_hz = doc["i2c_clock_max_hz"] | cfg.i2c_clock_max_hz;
+  cfg.i2c_clock_auto = doc["i2c_clock_auto"] | cfg.i2c_clock_auto;
+  cfg.i2c1_sda = doc["i2c1_sda"] | cfg.i2c1_sda;
+  cfg.i2c1_scl = doc["i2c1_scl"] | cfg.i2c1_scl;
+  cfg.i2c1_clock_hz = doc["i2c1_clock_hz"] | cfg.i2c1_clock_hz;
+  cfg.i2c_presence_interval_ms = doc["i2c_presence_interval_ms"] | cfg.i2c_presence_interval_ms;
+  cfg.i2c_trace_enable = doc["i2c_trace_enable"] | cfg.i2c_trace_enable;
 
   cfg.tft_sck = doc["tft_sck"] | cfg.tft_sck;
   cfg.tft_mosi = doc["tft_mosi"] | cfg.tft_mosi;
@@ -183,6 +190,17 @@ bool loadConfig(SystemConfig& cfg) {
   cfg.sd_miso = doc["sd_miso"] | cfg.sd_miso;
   cfg.sd_cs = doc["sd_cs"] | cfg.sd_cs;
 
+  cfg.bridge_max_batch = doc["bridge_max_batch"] | cfg.bridge_max_batch;
+  cfg.bridge_task_core = doc["bridge_task_core"] | cfg.bridge_task_core;
+  cfg.bridge_task_priority = doc["bridge_task_priority"] | cfg.bridge_task_priority;
+  cfg.bridge_udp_enable = doc["bridge_udp_enable"] | cfg.bridge_udp_enable;
+  cfg.bridge_serial_enable = doc["bridge_serial_enable"] | cfg.bridge_serial_enable;
+  cfg.bridge_cache_ms = doc["bridge_cache_ms"] | cfg.bridge_cache_ms;
+  cfg.bridge_queue_high = doc["bridge_queue_high"] | cfg.bridge_queue_high;
+  cfg.bridge_queue_low = doc["bridge_queue_low"] | cfg.bridge_queue_low;
+
+  cfg.bridge_priority_cmds = String(
+      (const char*)(doc["bridge_priority_cmds"] | cfg.bridge_priority_cmds.c_str()));
   cfg.splash_path = String((const char*)(doc["splash"] | cfg.splash_path.c_str()));
 
   // If the config says headless, forcibly disable local stack.
@@ -210,6 +228,13 @@ bool saveConfig(const SystemConfig& cfg) {
   doc["touch"] = (int)cfg.touch;
   doc["i2c_sda"] = cfg.i2c_sda;
   doc["i2c_scl"] = cfg.i2c_scl;
+  doc["i2c_clock_max_hz"] = cfg.i2c_clock_max_hz;
+  doc["i2c_clock_auto"] = cfg.i2c_clock_auto;
+  doc["i2c1_sda"] = cfg.i2c1_sda;
+  doc["i2c1_scl"] = cfg.i2c1_scl;
+  doc["i2c1_clock_hz"] = cfg.i2c1_clock_hz;
+  doc["i2c_presence_interval_ms"] = cfg.i2c_presence_interval_ms;
+  doc["i2c_trace_enable"] = cfg.i2c_trace_enable;
   doc["tft_sck"] = cfg.tft_sck;
   doc["tft_mosi"] = cfg.tft_mosi;
   doc["tft_miso"] = cfg.tft_miso;
@@ -227,6 +252,15 @@ bool saveConfig(const SystemConfig& cfg) {
   doc["sd_mosi"] = cfg.sd_mosi;
   doc["sd_miso"] = cfg.sd_miso;
   doc["sd_cs"] = cfg.sd_cs;
+  doc["bridge_max_batch"] = cfg.bridge_max_batch;
+  doc["bridge_task_core"] = cfg.bridge_task_core;
+  doc["bridge_task_priority"] = cfg.bridge_task_priority;
+  doc["bridge_udp_enable"] = cfg.bridge_udp_enable;
+  doc["bridge_serial_enable"] = cfg.bridge_serial_enable;
+  doc["bridge_cache_ms"] = cfg.bridge_cache_ms;
+  doc["bridge_queue_high"] = cfg.bridge_queue_high;
+  doc["bridge_queue_low"] = cfg.bridge_queue_low;
+  doc["bridge_priority_cmds"] = cfg.bridge_priority_cmds;
   doc["splash"] = cfg.splash_path;
 
   File f = LittleFS.open(CFG_PATH, "w");
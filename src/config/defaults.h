@@ -59,3 +59,65 @@ static const uint16_t AUTH_LOCKOUT_MS = 5000;  // 5 second lockout after failed
 
 // Battery ADC pin (set to -1 to disable)
 #define BATTERY_ADC_PIN -1
+
+// ===================================================================================
+// --- I2C Bus Configuration ---
+// ===================================================================================
+// Fastest bus clock (Hz). With auto clock on, the fastest stable rate up to
+// this is probed at boot and lowered/raised with observed error rates;
+// with it off the bus simply runs at this rate.
+#define DEFAULT_I2C_CLOCK_MAX_HZ 1000000
+#define DEFAULT_I2C_CLOCK_AUTO 1
+
+// Secondary bus (Wire1): off while either pin is -1. Its clock is fixed
+// (the adaptive clock manages the primary bus only).
+#define DEFAULT_I2C1_SDA -1
+#define DEFAULT_I2C1_SCL -1
+#define DEFAULT_I2C1_CLOCK_HZ 400000
+
+// Background presence scan: one address probe per interval (ms), ~3 s per
+// sweep at 25 ms; 0 turns it off and /scan-data probes on request instead
+#define DEFAULT_I2C_PRESENCE_INTERVAL_MS 25
+
+// Ring trace of the last I2C transactions (/api/i2c/trace)
+#define DEFAULT_I2C_TRACE_ENABLE 1
+
+// ===================================================================================
+// --- TCP Bridge Configuration ---
+// ===================================================================================
+// Default maximum number of frames executed per bridge drain cycle
+// (can be overridden by config.json, clamped to BRIDGE_RING_CAPACITY)
+#define DEFAULT_BRIDGE_MAX_BATCH 16
+
+// Bridge task placement: core (-1 = no affinity) and FreeRTOS priority.
+// The Arduino loop runs on core 1 at priority 1, so core 0 keeps the bridge
+// away from web server and display work.
+#define DEFAULT_BRIDGE_TASK_CORE 0
+#define DEFAULT_BRIDGE_TASK_PRIORITY 5
+
+// Enable the UDP bridge transport (same port number as TCP). Off by default:
+// any host that can reach the port, including a spoofed source, occupies a
+// UDP session slot for 30 s per datagram (TCP slots are not affected).
+#define DEFAULT_BRIDGE_UDP_ENABLE 0
+
+// Run the bridge on the Serial port (USB-CDC on S3 boards). The debug console
+// then moves to UART0 on USB-CDC boards and is silenced otherwise.
+#define DEFAULT_BRIDGE_SERIAL_ENABLE 0
+
+// Staleness window (ms) for cached public-data reads on the bridge; 0 disables
+// the read cache
+#define DEFAULT_BRIDGE_CACHE_MS 0
+
+// Per-session flow control, in frames queued or on the bus: a session at the
+// high watermark is no longer read from (TCP backpressure; UDP datagrams are
+// dropped) until it drains to the low watermark. Clamped to BRIDGE_RING_CAPACITY.
+#define DEFAULT_BRIDGE_QUEUE_HIGH 24
+#define DEFAULT_BRIDGE_QUEUE_LOW 8
+
+// SerialWombat command bytes that are high priority in every bridge session,
+// comma separated (e.g. "0x82,0x83"); clients can change their own with the
+// CMD_PRIORITY control op
+#define DEFAULT_BRIDGE_PRIORITY_CMDS ""
+
+// Default size limit for a bridge traffic capture file (KB)
+#define DEFAULT_BRIDGE_CAPTURE_MAX_KB 256
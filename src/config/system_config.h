@@ -26,6 +26,21 @@ struct SystemConfig {
   int i2c_sda = 21;
   int i2c_scl = 22;
 
+  // I2C clock ceiling and adaptive clock control (applied at boot)
+  int i2c_clock_max_hz = DEFAULT_I2C_CLOCK_MAX_HZ;
+  bool i2c_clock_auto = DEFAULT_I2C_CLOCK_AUTO;
+
+  // Secondary I2C bus (Wire1) pins, -1 = unused, and its fixed clock
+  int i2c1_sda = DEFAULT_I2C1_SDA;
+  int i2c1_scl = DEFAULT_I2C1_SCL;
+  int i2c1_clock_hz = DEFAULT_I2C1_CLOCK_HZ;
+
+  // Background presence scan probe interval (ms, 0 = off)
+  int i2c_presence_interval_ms = DEFAULT_I2C_PRESENCE_INTERVAL_MS;
+
+  // Record every I2C transaction in the trace ring
+  bool i2c_trace_enable = DEFAULT_I2C_TRACE_ENABLE;
+
   // SPI panel pins (ESP32-WROOM CYD family defaults)
   int tft_sck = 14;
   int tft_mosi = 13;
@@ -58,6 +73,29 @@ struct SystemConfig {
   int rgb_pclk = 42;
   int rgb_freq_write = 12000000;
 
+  // TCP bridge: maximum frames executed per drain cycle
+  int bridge_max_batch = DEFAULT_BRIDGE_MAX_BATCH;
+
+  // TCP bridge task placement (applied at boot)
+  int bridge_task_core = DEFAULT_BRIDGE_TASK_CORE;
+  int bridge_task_priority = DEFAULT_BRIDGE_TASK_PRIORITY;
+
+  // UDP bridge transport (applied at boot)
+  bool bridge_udp_enable = DEFAULT_BRIDGE_UDP_ENABLE;
+
+  // Serial (USB-CDC/UART) bridge transport (applied at boot)
+  bool bridge_serial_enable = DEFAULT_BRIDGE_SERIAL_ENABLE;
+
+  // Bridge read cache window in ms, 0 = off (applied at boot)
+  int bridge_cache_ms = DEFAULT_BRIDGE_CACHE_MS;
+
+  // Bridge per-session flow control watermarks in frames (applied at boot)
+  int bridge_queue_high = DEFAULT_BRIDGE_QUEUE_HIGH;
+  int bridge_queue_low = DEFAULT_BRIDGE_QUEUE_LOW;
+
+  // Bridge command bytes that are high priority, comma separated (applied at boot)
+  String bridge_priority_cmds = DEFAULT_BRIDGE_PRIORITY_CMDS;
+
   // Splash asset stored in LittleFS (/assets/...) after first boot selection.
   String splash_path = "/assets/splash";
 };
@@ -1,15 +1,153 @@
 /*
  * I2C Traffic Monitor - Implementation
- *
- * Global variables for I2C traffic monitoring.
- *
- * Extracted from original .ino file (lines 125-129).
  */
 
 #include "i2c_monitor.h"
 
-// I2C traffic counters - always available (used by both Web UI and LVGL)
-volatile uint32_t g_i2c_tx_count = 0;
-volatile uint32_t g_i2c_rx_count = 0;
-volatile bool g_i2c_tx_blink = false;
-volatile bool g_i2c_rx_blink = false;
+#include <Arduino.h>
+
+#include <atomic>
+
+// Entries an address can claim; the rest are the per-bus "other" entries
+#define I2C_MONITOR_ADDR_SLOTS (I2C_MONITOR_MAX_ADDRS - I2C_BUS_COUNT)
+static_assert(I2C_MONITOR_ADDR_SLOTS > 0, "I2C_MONITOR_MAX_ADDRS too small");
+
+namespace {
+struct Entry {
+  std::atomic<uint32_t> key;  // addr + 1 once claimed, 0 while free
+  std::atomic<uint32_t> transactions;
+  std::atomic<uint32_t> bytes;
+  std::atomic<uint32_t> errors;
+  std::atomic<uint32_t> bus_us;
+};
+
+struct CoreTable {
+  Entry entries[I2C_MONITOR_MAX_ADDRS];
+};
+}  // namespace
+
+static CoreTable s_tables[portNUM_PROCESSORS];
+static I2cMonitorRates s_rates = {};
+
+// ===================================================================================
+// Recording
+// ===================================================================================
+static Entry& entryFor(CoreTable& table, uint8_t addr, bool attributed) {
+  if (attributed) {
+    const uint32_t key = addr + 1u;
+    for (size_t i = 0; i < I2C_MONITOR_ADDR_SLOTS; i++) {
+      Entry& e = table.entries[i];
+      uint32_t k = e.key.load(std::memory_order_relaxed);
+      if (k == key) return e;
+      if (k != 0) continue;
+      // Another task on this core may claim the slot first
+      if (e.key.compare_exchange_strong(k, key, std::memory_order_relaxed) || k == key) return e;
+    }
+  }
+  return table.entries[I2C_MONITOR_ADDR_SLOTS + i2cAddrBus(addr)];
+}
+
+void i2cMonitorRecord(uint8_t addr, bool attributed, uint32_t bytes, bool error, uint32_t busUs) {
+  CoreTable& table = s_tables[xPortGetCoreID() % portNUM_PROCESSORS];
+  Entry& e = entryFor(table, addr, attributed);
+  e.transactions.fetch_add(1, std::memory_order_relaxed);
+  e.bytes.fetch_add(bytes, std::memory_order_relaxed);
+  if (error) e.errors.fetch_add(1, std::memory_order_relaxed);
+  e.bus_us.fetch_add(busUs, std::memory_order_relaxed);
+}
+
+// ===================================================================================
+// Reading
+// ===================================================================================
+// Address an entry counts for; 0xFFFF while unclaimed
+static uint16_t entryAddr(const Entry& e, size_t index) {
+  if (index >= I2C_MONITOR_ADDR_SLOTS) {
+    return I2C_MONITOR_OTHER + (uint16_t)(index - I2C_MONITOR_ADDR_SLOTS);
+  }
+  uint32_t key = e.key.load(std::memory_order_relaxed);
+  return key ? (uint16_t)(key - 1) : 0xFFFF;
+}
+
+static I2cMonitorCounters loadCounters(const Entry& e) {
+  I2cMonitorCounters c;
+  c.transactions = e.transactions.load(std::memory_order_relaxed);
+  c.bytes = e.bytes.load(std::memory_order_relaxed);
+  c.errors = e.errors.load(std::memory_order_relaxed);
+  c.bus_us = e.bus_us.load(std::memory_order_relaxed);
+  return c;
+}
+
+static void addCounters(I2cMonitorCounters& into, const I2cMonitorCounters& c) {
+  into.transactions += c.transactions;
+  into.bytes += c.bytes;
+  into.errors += c.errors;
+  into.bus_us += c.bus_us;
+}
+
+size_t i2cMonitorSnapshot(I2cMonitorAddrStats* out, size_t max, I2cMonitorCounters& totals) {
+  totals = I2cMonitorCounters();
+  size_t n = 0;
+  for (const CoreTable& table : s_tables) {
+    for (size_t i = 0; i < I2C_MONITOR_MAX_ADDRS; i++) {
+      uint16_t addr = entryAddr(table.entries[i], i);
+      if (addr == 0xFFFF) continue;
+      I2cMonitorCounters c = loadCounters(table.entries[i]);
+      if (c.transactions == 0) continue;
+      addCounters(totals, c);
+
+      // Insert sorted, merging the same address from another core
+      size_t at = 0;
+      while (at < n && out[at].addr < addr) at++;
+      if (at < n && out[at].addr == addr) {
+        addCounters(out[at].counters, c);
+      } else if (n < max) {
+        memmove(&out[at + 1], &out[at], (n - at) * sizeof(out[0]));
+        out[at].addr = addr;
+        out[at].counters = c;
+        n++;
+      }
+    }
+  }
+  return n;
+}
+
+// ===================================================================================
+// Rates
+// ===================================================================================
+void i2cMonitorPoll() {
+  static uint32_t windowStartMs = 0;
+  static I2cMonitorCounters last = {};
+  static uint32_t lastBusUs[I2C_BUS_COUNT] = {};
+
+  uint32_t now = millis();
+  uint32_t elapsed = now - windowStartMs;
+  if (elapsed < I2C_MONITOR_RATE_MS) return;
+  windowStartMs = now;
+
+  I2cMonitorCounters totals = {};
+  uint32_t busUs[I2C_BUS_COUNT] = {};
+  for (const CoreTable& table : s_tables) {
+    for (size_t i = 0; i < I2C_MONITOR_MAX_ADDRS; i++) {
+      uint16_t addr = entryAddr(table.entries[i], i);
+      if (addr == 0xFFFF) continue;
+      I2cMonitorCounters c = loadCounters(table.entries[i]);
+      addCounters(totals, c);
+      uint8_t bus = addr >= I2C_MONITOR_OTHER ? addr - I2C_MONITOR_OTHER : i2cAddrBus(addr);
+      busUs[bus] += c.bus_us;
+    }
+  }
+
+  // Counters wrap; differences stay right
+  s_rates.tx_per_sec = (uint64_t)(totals.transactions - last.transactions) * 1000 / elapsed;
+  s_rates.bytes_per_sec = (uint64_t)(totals.bytes - last.bytes) * 1000 / elapsed;
+  for (uint8_t bus = 0; bus < I2C_BUS_COUNT; bus++) {
+    uint32_t permille = (busUs[bus] - lastBusUs[bus]) / elapsed;  // us per ms
+    s_rates.util_permille[bus] = permille > 1000 ? 1000 : (uint16_t)permille;
+    lastBusUs[bus] = busUs[bus];
+  }
+  last = totals;
+}
+
+const I2cMonitorRates& i2cMonitorGetRates() {
+  return s_rates;
+}
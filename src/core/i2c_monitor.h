@@ -1,36 +1,63 @@
 /*
  * I2C Traffic Monitor - Header
  *
- * Provides counters and indicators for I2C TX/RX activity.
- * Used by UI status bar and web API to show I2C communication.
+ * Per-address I2C statistics (transactions, bytes, errors, cumulative bus
+ * time) for the UI status bar and web API. The I2C engine records every
+ * transaction from whichever task ran it; each CPU core has its own table, so
+ * the two engine tasks and inline callers on different cores never contend
+ * for a counter, and tasks sharing a core update it with relaxed atomics.
+ * Readers merge the tables on read.
  *
- * Extracted from original .ino file (lines 125-129).
+ * A table holds I2C_MONITOR_MAX_ADDRS addresses per core. Further addresses,
+ * and probes of absent devices (the presence scanner's misses), are counted
+ * under I2C_MONITOR_OTHER + bus so they still show in rates and bus
+ * utilization.
  */
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
-// Global I2C traffic counters
-extern volatile uint32_t g_i2c_tx_count;
-extern volatile uint32_t g_i2c_rx_count;
-extern volatile bool g_i2c_tx_blink;
-extern volatile bool g_i2c_rx_blink;
-
-// Mark I2C transmission (increments TX counter, sets blink flag)
-static inline void i2cMarkTx() {
-  g_i2c_tx_count++;
-  g_i2c_tx_blink = true;
-}
-
-// Mark I2C reception (increments RX counter, sets blink flag)
-static inline void i2cMarkRx() {
-  g_i2c_rx_count++;
-  g_i2c_rx_blink = true;
-}
-
-// Reset blink flags (call from UI after visual feedback shown)
-static inline void i2cClearBlink() {
-  g_i2c_tx_blink = false;
-  g_i2c_rx_blink = false;
-}
+#include "../hal/i2c/i2c_bus.h"
+
+// Entries per core, including one I2C_MONITOR_OTHER entry per bus
+#define I2C_MONITOR_MAX_ADDRS 16
+
+// Pseudo-address (plus bus number) for traffic without an entry of its own
+#define I2C_MONITOR_OTHER 0x100
+
+// Rate window (ms)
+#define I2C_MONITOR_RATE_MS 1000
+
+struct I2cMonitorCounters {
+  uint32_t transactions;
+  uint32_t bytes;   // Written plus read
+  uint32_t errors;  // Transactions that failed after every attempt
+  uint32_t bus_us;  // Cumulative time on the bus, retries included (wraps)
+};
+
+struct I2cMonitorAddrStats {
+  uint16_t addr;  // Bus-qualified address, or I2C_MONITOR_OTHER + bus
+  I2cMonitorCounters counters;
+};
+
+struct I2cMonitorRates {
+  uint32_t tx_per_sec;
+  uint32_t bytes_per_sec;
+  uint16_t util_permille[I2C_BUS_COUNT];  // Share of the window each bus was busy
+};
+
+// Any task: account one finished transaction. addr is bus-qualified;
+// attributed selects its own entry (false: the bus's I2C_MONITOR_OTHER).
+void i2cMonitorRecord(uint8_t addr, bool attributed, uint32_t bytes, bool error, uint32_t busUs);
+
+// Any task: per-address counters merged over all cores, sorted by address.
+// Returns the number of entries written (at most max); totals covers all.
+size_t i2cMonitorSnapshot(I2cMonitorAddrStats* out, size_t max, I2cMonitorCounters& totals);
+
+// Loop task: roll the rate window (call every loop)
+void i2cMonitorPoll();
+
+// Loop task: rates over the last complete window
+const I2cMonitorRates& i2cMonitorGetRates();
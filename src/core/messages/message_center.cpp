@@ -22,7 +22,8 @@ MessageCenter& MessageCenter::getInstance() {
   return instance;
 }
 
-MessageCenter::MessageCenter() : sequence_(0), next_msg_id_(1), update_callback_(nullptr) {
+MessageCenter::MessageCenter()
+    : sequence_(0), next_msg_id_(1), update_callback_(nullptr), console_(&Serial) {
   mutex_ = xSemaphoreCreateMutex();
 }
 
@@ -87,11 +88,13 @@ uint32_t MessageCenter::post(MessageSeverity severity, const char* source, const
     msg_id = msg.id;
     incrementSequence();
 
-    // Log to serial for debugging
+    // Log to the debug console
     const char* sev_str = (severity == MessageSeverity::INFO)   ? "INFO"
                           : (severity == MessageSeverity::WARN) ? "WARN"
                                                                 : "ERROR";
-    Serial.printf("[%s] %s: %s - %s\n", sev_str, source, title, details ? details : "");
+    if (console_) {
+      console_->printf("[%s] %s: %s - %s\n", sev_str, source, title, details ? details : "");
+    }
   }
 
   xSemaphoreGive(mutex_);
@@ -295,7 +298,7 @@ void MessageCenter::loadHistory() {
   file.close();
 
   if (error) {
-    Serial.println("MessageCenter: Failed to parse history file");
+    if (console_) console_->println("MessageCenter: Failed to parse history file");
     return;
   }
 
@@ -362,7 +365,7 @@ void MessageCenter::loadActive() {
   file.close();
 
   if (error) {
-    Serial.println("MessageCenter: Failed to parse active file");
+    if (console_) console_->println("MessageCenter: Failed to parse active file");
     return;
   }
 
@@ -113,6 +113,9 @@ class MessageCenter {
   // Update callback (called when messages change, for UI refresh)
   void setUpdateCallback(std::function<void()> callback) { update_callback_ = callback; }
 
+  // Debug console new messages are echoed to (Serial by default, nullptr = none)
+  void setConsole(Print* out) { console_ = out; }
+
  private:
   MessageCenter();  // Private constructor (singleton)
   ~MessageCenter() = default;
@@ -139,6 +142,9 @@ class MessageCenter {
   // Update callback
   std::function<void()> update_callback_;
 
+  // Debug console
+  Print* console_;
+
   // Persistence paths
   static const char* HISTORY_FILE;
   static const char* ACTIVE_FILE;
@@ -120,10 +120,13 @@
 #define I2C_INIT_BEGIN "I2C_INIT_BEGIN"
 #define I2C_INIT_OK "I2C_INIT_OK"
 #define I2C_BUS_OK "I2C_BUS_OK"
+#define I2C_CLOCK_CHANGED "I2C_CLOCK_CHANGED"
 #define I2C_BUS_STUCK "I2C_BUS_STUCK"
 #define I2C_DEVICE_NOT_FOUND "I2C_DEVICE_NOT_FOUND"
 #define I2C_COMM_ERROR "I2C_COMM_ERROR"
 #define I2C_SCAN_COMPLETE "I2C_SCAN_COMPLETE"
+#define I2C_DEVICE_ADDED "I2C_DEVICE_ADDED"
+#define I2C_DEVICE_REMOVED "I2C_DEVICE_REMOVED"
 
 // ===================================================================================
 // SerialWombat Messages
@@ -202,6 +205,9 @@
 #define TCP_CLIENT_CONNECTED "TCP_CLIENT_CONNECTED"
 #define TCP_CLIENT_DISCONNECTED "TCP_CLIENT_DISCONNECTED"
 #define TCP_BRIDGE_FAIL "TCP_BRIDGE_FAIL"
+#define UDP_BRIDGE_START "UDP_BRIDGE_START"
+#define UDP_BRIDGE_FAIL "UDP_BRIDGE_FAIL"
+#define SERIAL_BRIDGE_START "SERIAL_BRIDGE_START"
 
 // ===================================================================================
 // Security Messages
@@ -0,0 +1,62 @@
+/*
+ * Single-Producer / Single-Consumer Queue
+ *
+ * Lock-free bounded FIFO for handing fixed-size items between exactly two
+ * tasks (one pushes, one pops). Indices are free-running counters published
+ * with acquire/release ordering, so no mutex or critical section is needed.
+ *
+ * Capacity must be a power of two.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+template <typename T, size_t N>
+class SpscQueue {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+ public:
+  SpscQueue() : head_(0), tail_(0) {}
+
+  // Producer side: returns false when the queue is full
+  bool push(const T& item) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    uint32_t tail = tail_.load(std::memory_order_acquire);
+    if (head - tail >= N) return false;
+
+    items_[head & (N - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer side: returns false when the queue is empty
+  bool pop(T& out) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    uint32_t head = head_.load(std::memory_order_acquire);
+    if (head == tail) return false;
+
+    out = items_[tail & (N - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate when called from a third context; exact from either endpoint
+  size_t size() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+  size_t freeSlots() const { return N - size(); }
+  static constexpr size_t capacity() { return N; }
+
+ private:
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  T items_[N];
+  std::atomic<uint32_t> head_;  // Written by producer only
+  std::atomic<uint32_t> tail_;  // Written by consumer only
+};
@@ -0,0 +1,267 @@
+/*
+ * I2C Bus HAL - Implementation
+ *
+ * Arduino-ESP32 3.1 (ESP-IDF 5.3) installs the legacy master driver for Wire,
+ * so combined transfers go straight to i2c_master_write_read_device() on the
+ * same port. The driver's command mutex serialises these calls with any
+ * remaining Wire traffic. Newer cores that switch Wire to the i2c_master
+ * ("ng") driver cannot mix in legacy calls; there the transfer falls back to
+ * Wire with endTransmission(false), which the HAL also issues as a
+ * repeated-start write-read.
+ *
+ * Neither driver tells lost arbitration, a target stretching SCL past the
+ * controller's timeout and a target holding SDA apart: all surface as a
+ * timeout (or, on the ng driver, an unspecified error). The line levels
+ * straight after the failure do:
+ * - SDA low, SCL high: a target is still driving SDA -> BUS_STUCK
+ * - SCL low: a target is still stretching the clock -> TIMEOUT
+ * - both high, and the command ended well before its timeout: the controller
+ *   abandoned the transfer on its own, as it does on lost arbitration -> ARB_LOST
+ */
+
+#include "i2c_bus.h"
+
+#include <Arduino.h>
+
+#include <Wire.h>
+#include <driver/gpio.h>
+#include <esp_idf_version.h>
+
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 4, 0)
+#  define I2C_BUS_USE_IDF_LEGACY 1
+#  include <driver/i2c.h>
+#else
+#  define I2C_BUS_USE_IDF_LEGACY 0
+#endif
+
+// Ports with recorded pins
+#define I2C_BUS_MAX_PORTS 2
+
+// Half period of the bus-clear clock (5 us = 100 kHz)
+#define I2C_BUS_CLEAR_HALF_US 5
+
+// SCL pulses that free any target stuck mid-byte (8 data bits + ACK)
+#define I2C_BUS_CLEAR_PULSES 9
+
+struct BusPins {
+  int sda = -1;
+  int scl = -1;
+};
+static BusPins busPins[I2C_BUS_MAX_PORTS];
+
+// Serialises direct Wire/Wire1 users with i2cBusClear()
+static SemaphoreHandle_t busLock(uint8_t port) {
+  static SemaphoreHandle_t locks[I2C_BUS_MAX_PORTS] = {xSemaphoreCreateRecursiveMutex(),
+                                                       xSemaphoreCreateRecursiveMutex()};
+  return locks[port < I2C_BUS_MAX_PORTS ? port : I2C_BUS_PRIMARY_PORT];
+}
+
+void i2cBusLock(uint8_t port) {
+  xSemaphoreTakeRecursive(busLock(port), portMAX_DELAY);
+}
+
+void i2cBusUnlock(uint8_t port) {
+  xSemaphoreGiveRecursive(busLock(port));
+}
+
+void i2cBusSetPins(uint8_t port, int sda, int scl) {
+  if (port >= I2C_BUS_MAX_PORTS) return;
+  busPins[port].sda = sda;
+  busPins[port].scl = scl;
+}
+
+// Refine a timeout-like failure from the line levels (see top of file)
+static I2cStatus classifyBusFault(uint8_t port, I2cStatus status, uint32_t elapsedMs,
+                                  uint32_t timeoutMs) {
+  if (port >= I2C_BUS_MAX_PORTS || busPins[port].sda < 0) return status;
+
+  bool sda = gpio_get_level((gpio_num_t)busPins[port].sda);
+  bool scl = gpio_get_level((gpio_num_t)busPins[port].scl);
+  if (!sda && scl) return I2cStatus::BUS_STUCK;
+  if (!scl) return I2cStatus::TIMEOUT;
+  if (elapsedMs < timeoutMs / 2) return I2cStatus::ARB_LOST;
+  return status;
+}
+
+#if I2C_BUS_USE_IDF_LEGACY
+
+static I2cStatus fromEspErr(esp_err_t err) {
+  switch (err) {
+    case ESP_OK:
+      return I2cStatus::OK;
+    case ESP_FAIL:
+      return I2cStatus::NACK;
+    case ESP_ERR_TIMEOUT:
+      return I2cStatus::TIMEOUT;
+    default:
+      return I2cStatus::BUS_ERROR;
+  }
+}
+
+I2cStatus i2cBusTransfer(uint8_t port, uint8_t addr, const uint8_t* tx, size_t txLen,
+                         uint8_t* rx, size_t rxLen, size_t& rxGot, uint32_t timeoutMs) {
+  TickType_t ticks = pdMS_TO_TICKS(timeoutMs);
+  uint32_t start = millis();
+  esp_err_t err;
+
+  if (txLen > 0 && rxLen > 0) {
+    err = i2c_master_write_read_device((i2c_port_t)port, addr, tx, txLen, rx, rxLen, ticks);
+  } else if (txLen > 0) {
+    err = i2c_master_write_to_device((i2c_port_t)port, addr, tx, txLen, ticks);
+  } else {
+    err = i2c_master_read_from_device((i2c_port_t)port, addr, rx, rxLen, ticks);
+  }
+
+  // The legacy driver reads all requested bytes or fails the whole command
+  rxGot = (err == ESP_OK) ? rxLen : 0;
+  I2cStatus status = fromEspErr(err);
+  if (status == I2cStatus::TIMEOUT) {
+    status = classifyBusFault(port, status, millis() - start, timeoutMs);
+  }
+  return status;
+}
+
+I2cStatus i2cBusProbe(uint8_t port, uint8_t addr, uint32_t timeoutMs) {
+  i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+  if (!cmd) return I2cStatus::BUS_ERROR;
+
+  uint32_t start = millis();
+  i2c_master_start(cmd);
+  i2c_master_write_byte(cmd, (uint8_t)(addr << 1) | I2C_MASTER_WRITE, true);
+  i2c_master_stop(cmd);
+  esp_err_t err = i2c_master_cmd_begin((i2c_port_t)port, cmd, pdMS_TO_TICKS(timeoutMs));
+  i2c_cmd_link_delete(cmd);
+
+  I2cStatus status = fromEspErr(err);
+  if (status == I2cStatus::TIMEOUT) {
+    status = classifyBusFault(port, status, millis() - start, timeoutMs);
+  }
+  return status;
+}
+
+#else
+
+// endTransmission() result to status: 2/3 address/data NACK, 5 timeout,
+// 4 anything else the driver reported
+static I2cStatus fromWireErr(uint8_t port, uint8_t err, uint32_t elapsedMs, uint32_t timeoutMs) {
+  switch (err) {
+    case 0:
+      return I2cStatus::OK;
+    case 2:
+    case 3:
+      return I2cStatus::NACK;
+    case 4:
+      return classifyBusFault(port, I2cStatus::BUS_ERROR, elapsedMs, timeoutMs);
+    case 5:
+      return classifyBusFault(port, I2cStatus::TIMEOUT, elapsedMs, timeoutMs);
+    default:
+      return I2cStatus::BUS_ERROR;
+  }
+}
+
+I2cStatus i2cBusTransfer(uint8_t port, uint8_t addr, const uint8_t* tx, size_t txLen,
+                         uint8_t* rx, size_t rxLen, size_t& rxGot, uint32_t timeoutMs) {
+  TwoWire& bus = (port == I2C_BUS_PRIMARY_PORT) ? Wire : Wire1;
+  uint32_t start = millis();
+  rxGot = 0;
+
+  if (txLen > 0) {
+    bus.beginTransmission(addr);
+    bus.write(tx, txLen);
+    // Keep the bus for the read phase (repeated START) when one follows
+    uint8_t err = bus.endTransmission(rxLen == 0);
+    if (err != 0) return fromWireErr(port, err, millis() - start, timeoutMs);
+  }
+
+  if (rxLen > 0) {
+    size_t got = bus.requestFrom(addr, rxLen);
+    while (rxGot < got && rxGot < rxLen) {
+      rx[rxGot++] = bus.read();
+    }
+    if (got == 0) return I2cStatus::NACK;
+    if (rxGot < rxLen) return I2cStatus::SHORT_READ;
+  }
+  return I2cStatus::OK;
+}
+
+I2cStatus i2cBusProbe(uint8_t port, uint8_t addr, uint32_t timeoutMs) {
+  TwoWire& bus = (port == I2C_BUS_PRIMARY_PORT) ? Wire : Wire1;
+  uint32_t start = millis();
+  bus.beginTransmission(addr);
+  uint8_t err = bus.endTransmission(true);
+  return fromWireErr(port, err, millis() - start, timeoutMs);
+}
+
+#endif  // I2C_BUS_USE_IDF_LEGACY
+
+// ===================================================================================
+// Bus Clear
+// ===================================================================================
+static void busClearDelay() {
+  delayMicroseconds(I2C_BUS_CLEAR_HALF_US);
+}
+
+bool i2cBusClear(uint8_t port) {
+  if (port >= I2C_BUS_MAX_PORTS || busPins[port].sda < 0) return false;
+  const int sda = busPins[port].sda;
+  const int scl = busPins[port].scl;
+  TwoWire& bus = (port == I2C_BUS_PRIMARY_PORT) ? Wire : Wire1;
+  SemaphoreHandle_t lock = busLock(port);
+  if (xSemaphoreTakeRecursive(lock, pdMS_TO_TICKS(I2C_BUS_CLEAR_LOCK_MS)) != pdTRUE) return false;
+  uint32_t hz = bus.getClock();
+
+  // Take the pins away from the controller
+  bus.end();
+  pinMode(sda, INPUT_PULLUP);
+  pinMode(scl, OUTPUT_OPEN_DRAIN);
+  digitalWrite(scl, HIGH);
+  busClearDelay();
+
+  // Clock out the rest of whatever byte the target is sending
+  for (int i = 0; i < I2C_BUS_CLEAR_PULSES && digitalRead(sda) == LOW; i++) {
+    digitalWrite(scl, LOW);
+    busClearDelay();
+    digitalWrite(scl, HIGH);
+    busClearDelay();
+  }
+
+  // STOP (SDA rising while SCL is high) resets every target's state machine
+  pinMode(sda, OUTPUT_OPEN_DRAIN);
+  digitalWrite(scl, LOW);
+  digitalWrite(sda, LOW);
+  busClearDelay();
+  digitalWrite(scl, HIGH);
+  busClearDelay();
+  digitalWrite(sda, HIGH);
+  busClearDelay();
+
+  pinMode(sda, INPUT_PULLUP);
+  pinMode(scl, INPUT_PULLUP);
+  busClearDelay();
+  bool freed = digitalRead(sda) == HIGH && digitalRead(scl) == HIGH;
+
+  bus.begin(sda, scl, hz);
+  xSemaphoreGiveRecursive(lock);
+  return freed;
+}
+
+const char* i2cStatusToStr(I2cStatus s) {
+  switch (s) {
+    case I2cStatus::OK:
+      return "ok";
+    case I2cStatus::NACK:
+      return "nack";
+    case I2cStatus::TIMEOUT:
+      return "timeout";
+    case I2cStatus::BUS_ERROR:
+      return "bus_error";
+    case I2cStatus::ARB_LOST:
+      return "arb_lost";
+    case I2cStatus::SHORT_READ:
+      return "short_read";
+    case I2cStatus::BUS_STUCK:
+      return "bus_stuck";
+    default:
+      return "unknown";
+  }
+}
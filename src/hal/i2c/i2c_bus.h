@@ -0,0 +1,96 @@
+/*
+ * I2C Bus HAL - Header
+ *
+ * Thin wrapper over the ESP-IDF I2C master driver installed by Wire.begin().
+ * A transfer with both a write and a read phase is issued as one combined
+ * transaction (START, write, repeated START, read, STOP) instead of two
+ * stop-terminated Wire calls.
+ *
+ * Failures are classified so callers can decide what is worth retrying, and a
+ * bus whose SDA line is held low by a target can be recovered by clocking it
+ * free (i2cBusClear()) instead of power cycling.
+ *
+ * The SerialWombat library drives Wire/Wire1 directly, outside this HAL and
+ * the I2C engine. Such code holds the port's bus lock (I2cBusGuard) so a bus
+ * clear never takes the pins away in the middle of its transfers.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Outcome of one bus transfer. Values are sent to bridge clients: append only.
+enum class I2cStatus : uint8_t {
+  OK = 0,
+  NACK,        // Address or data byte not acknowledged
+  TIMEOUT,     // Transfer did not finish in time (clock held low)
+  BUS_ERROR,   // Driver not installed or invalid state
+  ARB_LOST,    // Controller lost the bus mid-transfer
+  SHORT_READ,  // Target sent fewer bytes than requested
+  BUS_STUCK,   // SDA held low by a target after the transfer
+};
+
+// Hardware controllers behind the global Wire and Wire1 objects
+#define I2C_BUS_PRIMARY_PORT 0
+#define I2C_BUS_SECONDARY_PORT 1
+#define I2C_BUS_COUNT 2
+
+// Above the HAL, targets are bus-qualified addresses: the 7-bit address, with
+// bit 7 set for a device on the secondary bus. The HAL itself takes a port and
+// a plain 7-bit address.
+#define I2C_ADDR_BUS_FLAG 0x80
+
+inline uint8_t i2cAddrBus(uint8_t addr) {
+  return (addr & I2C_ADDR_BUS_FLAG) ? I2C_BUS_SECONDARY_PORT : I2C_BUS_PRIMARY_PORT;
+}
+inline uint8_t i2cAddr7(uint8_t addr) {
+  return addr & (uint8_t)~I2C_ADDR_BUS_FLAG;
+}
+inline uint8_t i2cAddrOnBus(uint8_t bus, uint8_t addr7) {
+  return (uint8_t)(addr7 & 0x7F) | (bus == I2C_BUS_SECONDARY_PORT ? I2C_ADDR_BUS_FLAG : 0);
+}
+
+// Write txLen bytes then read rxLen bytes from addr. Either length may be zero.
+// rxGot receives the number of response bytes actually read.
+I2cStatus i2cBusTransfer(uint8_t port, uint8_t addr, const uint8_t* tx, size_t txLen,
+                         uint8_t* rx, size_t rxLen, size_t& rxGot, uint32_t timeoutMs);
+
+// Address-only probe (START, address + write, STOP). OK when the target ACKs.
+I2cStatus i2cBusProbe(uint8_t port, uint8_t addr, uint32_t timeoutMs);
+
+// Record the pins of a port after Wire.begin(); needed by i2cBusClear()
+void i2cBusSetPins(uint8_t port, int sda, int scl);
+
+// Free a bus whose SDA is held low: release the pins from the controller,
+// clock SCL until the target lets go of SDA (at most 9 pulses), send a STOP and
+// reinstall the driver at its previous clock. Returns true when both lines
+// read high afterwards. Takes the port's bus lock first and gives up, leaving
+// the bus untouched, if it stays held for I2C_BUS_CLEAR_LOCK_MS. Must not run
+// concurrently with other HAL transfers on the port (the I2C engine calls it
+// from its own task).
+bool i2cBusClear(uint8_t port);
+
+// Longest wait of i2cBusClear() for the bus lock (ms)
+#define I2C_BUS_CLEAR_LOCK_MS 2000
+
+// Bus lock of a port for direct Wire/Wire1 users (recursive). Hold it only
+// around library calls: never while waiting for the I2C engine, whose task
+// may be waiting for the lock to clear a stuck bus.
+void i2cBusLock(uint8_t port);
+void i2cBusUnlock(uint8_t port);
+
+// Holds a port's bus lock for the lifetime of the object
+class I2cBusGuard {
+ public:
+  explicit I2cBusGuard(uint8_t port) : port_(port) { i2cBusLock(port_); }
+  ~I2cBusGuard() { i2cBusUnlock(port_); }
+  I2cBusGuard(const I2cBusGuard&) = delete;
+  I2cBusGuard& operator=(const I2cBusGuard&) = delete;
+
+ private:
+  const uint8_t port_;
+};
+
+// Status name for logs and JSON
+const char* i2cStatusToStr(I2cStatus s);
@@ -0,0 +1,178 @@
+/*
+ * Fingerprint Cache - Implementation
+ */
+
+#include "fingerprint_cache.h"
+
+#include <LittleFS.h>
+
+// File layout: header, then count raw entries. A different entry size or
+// version discards the file (it is only a cache).
+#define FINGERPRINT_FILE_MAGIC "WBFP"
+#define FINGERPRINT_FILE_VERSION 2
+
+struct FingerprintFileHeader {
+  char magic[4];
+  uint8_t version;
+  uint8_t entry_size;
+  uint16_t count;
+};
+
+// ===================================================================================
+// Singleton Implementation
+// ===================================================================================
+FingerprintCache& FingerprintCache::getInstance() {
+  static FingerprintCache instance;
+  return instance;
+}
+
+FingerprintCache::FingerprintCache() : loaded_(false), next_stamp_(1), entries_(), stats_() {
+  mutex_ = xSemaphoreCreateMutex();
+}
+
+// ===================================================================================
+// Keys
+// ===================================================================================
+bool FingerprintCache::makeKey(const SerialWombat& sw, Entry& key) {
+  memset(&key, 0, sizeof(key));
+  size_t len = sw.uniqueIdentifierLength;
+  if (len > sizeof(key.uuid)) len = sizeof(key.uuid);
+  if (len > sizeof(sw.uniqueIdentifier)) len = sizeof(sw.uniqueIdentifier);
+  if (len == 0) return false;
+
+  memcpy(key.uuid, sw.uniqueIdentifier, len);
+  key.uuid_len = (uint8_t)len;
+  size_t fwLen = sizeof(sw.fwVersion) < sizeof(key.fw) - 1 ? sizeof(sw.fwVersion)
+                                                           : sizeof(key.fw) - 1;
+  strncpy(key.fw, (const char*)sw.fwVersion, fwLen);
+  return true;
+}
+
+FingerprintCache::Entry* FingerprintCache::find(const Entry& key) {
+  for (auto& e : entries_) {
+    if (e.uuid_len == key.uuid_len && memcmp(e.uuid, key.uuid, key.uuid_len) == 0 &&
+        strncmp(e.fw, key.fw, sizeof(e.fw)) == 0) {
+      return &e;
+    }
+  }
+  return nullptr;
+}
+
+// ===================================================================================
+// Persistence
+// ===================================================================================
+void FingerprintCache::load() {
+  loaded_ = true;
+  File f = LittleFS.open(FINGERPRINT_CACHE_PATH, "r");
+  if (!f) return;
+
+  FingerprintFileHeader hdr;
+  bool valid = f.read((uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+               memcmp(hdr.magic, FINGERPRINT_FILE_MAGIC, 4) == 0 &&
+               hdr.version == FINGERPRINT_FILE_VERSION && hdr.entry_size == sizeof(Entry);
+  size_t count = 0;
+  while (valid && count < hdr.count && count < FINGERPRINT_CACHE_ENTRIES) {
+    Entry& e = entries_[count];
+    if (f.read((uint8_t*)&e, sizeof(e)) != sizeof(e) || e.uuid_len > FINGERPRINT_UUID_MAX) {
+      memset(&e, 0, sizeof(e));
+      break;
+    }
+    if (e.stamp >= next_stamp_) next_stamp_ = e.stamp + 1;
+    count++;
+  }
+  f.close();
+}
+
+void FingerprintCache::save() {
+  File f = LittleFS.open(FINGERPRINT_CACHE_PATH, "w");
+  if (!f) return;
+
+  FingerprintFileHeader hdr;
+  memcpy(hdr.magic, FINGERPRINT_FILE_MAGIC, 4);
+  hdr.version = FINGERPRINT_FILE_VERSION;
+  hdr.entry_size = sizeof(Entry);
+  hdr.count = 0;
+  for (const auto& e : entries_) {
+    if (e.uuid_len) hdr.count++;
+  }
+  f.write((const uint8_t*)&hdr, sizeof(hdr));
+  for (const auto& e : entries_) {
+    if (e.uuid_len) f.write((const uint8_t*)&e, sizeof(e));
+  }
+  f.close();
+}
+
+// ===================================================================================
+// Public API
+// ===================================================================================
+bool FingerprintCache::lookup(const SerialWombat& sw, PinModeCaps& caps) {
+  Entry key;
+  if (!makeKey(sw, key)) return false;
+
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  if (!loaded_) load();
+  Entry* e = find(key);
+  if (e) {
+    caps.supported = e->supported;
+    caps.probed = e->probed;
+    stats_.hits++;
+  } else {
+    stats_.misses++;
+  }
+  xSemaphoreGive(mutex_);
+  return e != nullptr;
+}
+
+void FingerprintCache::store(const SerialWombat& sw, const PinModeCaps& caps) {
+  Entry key;
+  if (!makeKey(sw, key)) return;
+
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  if (!loaded_) load();
+
+  // Same chip and firmware, else a free slot, else the oldest entry
+  Entry* slot = find(key);
+  if (!slot) {
+    slot = &entries_[0];
+    for (auto& e : entries_) {
+      if (!e.uuid_len) {
+        slot = &e;
+        break;
+      }
+      if (e.stamp < slot->stamp) slot = &e;
+    }
+  }
+  key.supported = caps.supported;
+  key.probed = caps.probed;
+  key.stamp = next_stamp_++;
+  *slot = key;
+  stats_.stores++;
+  save();
+  xSemaphoreGive(mutex_);
+}
+
+size_t FingerprintCache::invalidate() {
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  if (!loaded_) load();
+  size_t removed = 0;
+  for (auto& e : entries_) {
+    if (e.uuid_len) removed++;
+    memset(&e, 0, sizeof(e));
+  }
+  if (LittleFS.exists(FINGERPRINT_CACHE_PATH)) LittleFS.remove(FINGERPRINT_CACHE_PATH);
+  stats_.invalidations++;
+  xSemaphoreGive(mutex_);
+  return removed;
+}
+
+FingerprintCacheStats FingerprintCache::getStats() {
+  xSemaphoreTake(mutex_, portMAX_DELAY);
+  if (!loaded_) load();
+  FingerprintCacheStats out = stats_;
+  out.entries = 0;
+  for (const auto& e : entries_) {
+    if (e.uuid_len) out.entries++;
+  }
+  xSemaphoreGive(mutex_);
+  return out;
+}
@@ -0,0 +1,84 @@
+/*
+ * Fingerprint Cache - Header
+ *
+ * Persistent cache of SerialWombat pin-mode capability probes. The answers
+ * only change when the chip is reflashed, so they are stored on LittleFS
+ * keyed by the chip's unique identifier and firmware version, together with
+ * which modes were probed: a variant classification leaves a partial entry
+ * that a later full enumeration completes. A later scan of the same chip
+ * needs only queryVersion() to find its entry. Chips without a unique
+ * identifier are never cached.
+ *
+ * Entries are replaced oldest first once the cache is full. invalidate()
+ * drops everything, e.g. after a chip was reflashed with the same version
+ * string. Thread-safe (web handlers and scan jobs).
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <SerialWombat.h>
+
+#include "variant_signatures.h"
+
+// Storage file and capacity
+#define FINGERPRINT_CACHE_PATH "/fingerprints.bin"
+#define FINGERPRINT_CACHE_ENTRIES 16
+
+// Key field sizes
+#define FINGERPRINT_UUID_MAX 16
+#define FINGERPRINT_FW_MAX 8
+
+struct FingerprintCacheStats {
+  uint32_t entries;
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t stores;
+  uint32_t invalidations;
+};
+
+class FingerprintCache {
+ public:
+  static FingerprintCache& getInstance();
+
+  // Capabilities cached for the chip sw last ran queryVersion() on (possibly
+  // only partly probed); false when unknown
+  bool lookup(const SerialWombat& sw, PinModeCaps& caps);
+
+  // Remember the probed capabilities of that chip and write the cache file
+  void store(const SerialWombat& sw, const PinModeCaps& caps);
+
+  // Drop every entry (and the file); returns entries removed
+  size_t invalidate();
+
+  FingerprintCacheStats getStats();
+
+ private:
+  FingerprintCache();
+  FingerprintCache(const FingerprintCache&) = delete;
+  FingerprintCache& operator=(const FingerprintCache&) = delete;
+
+  struct Entry {
+    uint8_t uuid[FINGERPRINT_UUID_MAX];
+    uint8_t uuid_len;  // 0 = free slot
+    char fw[FINGERPRINT_FW_MAX];
+    uint64_t supported;
+    uint64_t probed;
+    uint32_t stamp;  // Store order, for replacement
+  };
+
+  // Fill a key from the chip; false when it has no unique identifier
+  static bool makeKey(const SerialWombat& sw, Entry& key);
+  Entry* find(const Entry& key);
+
+  // Caller holds mutex_
+  void load();
+  void save();
+
+  SemaphoreHandle_t mutex_;
+  bool loaded_;
+  uint32_t next_stamp_;
+  Entry entries_[FINGERPRINT_CACHE_ENTRIES];
+  FingerprintCacheStats stats_;
+};
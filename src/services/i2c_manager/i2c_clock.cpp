@@ -0,0 +1,386 @@
+/*
+ * I2C Clock Controller - Implementation
+ */
+
+#include "i2c_clock.h"
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "i2c_engine.h"
+
+// Clock ladder, slowest first
+static const uint32_t clockRungs[] = {100000, 200000, 400000, 600000, 800000, 1000000};
+static const int CLOCK_RUNG_COUNT = sizeof(clockRungs) / sizeof(clockRungs[0]);
+
+// SerialWombat version query; the reply is fixed for a given firmware
+static const uint8_t versionQuery[8] = {'V', 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55};
+
+// First and last 7-bit addresses probed at boot
+#define I2C_CLOCK_SCAN_FIRST 0x08
+#define I2C_CLOCK_SCAN_LAST 0x77
+
+// A step down this soon after a step up counts as a failed step up
+#define I2C_CLOCK_REVERT_MS (2 * I2C_CLOCK_WINDOW_MS)
+
+// ===================================================================================
+// Singleton Implementation
+// ===================================================================================
+I2cClockController& I2cClockController::getInstance() {
+  static I2cClockController instance;
+  return instance;
+}
+
+I2cClockController::I2cClockController()
+    : slot_count_(0),
+      requested_hz_(I2C_CLOCK_FLOOR_HZ),
+      applied_hz_(I2C_CLOCK_FLOOR_HZ),
+      adaptive_(false),
+      probed_(false),
+      max_hz_(I2C_CLOCK_FLOOR_HZ),
+      wombat_addr_(0),
+      top_(0),
+      level_(0),
+      ceiling_(0),
+      windows_(),
+      window_start_ms_(0),
+      clean_windows_(0),
+      backoff_(1),
+      last_up_ms_(0),
+      step_downs_(0),
+      step_ups_(0),
+      last_change_ms_(0) {
+  for (auto& s : slots_) {
+    s.addr.store(0, std::memory_order_relaxed);
+    s.transfers.store(0, std::memory_order_relaxed);
+    s.nacks.store(0, std::memory_order_relaxed);
+    s.timeouts.store(0, std::memory_order_relaxed);
+    s.bus_errors.store(0, std::memory_order_relaxed);
+    s.short_reads.store(0, std::memory_order_relaxed);
+  }
+}
+
+// ===================================================================================
+// Boot Probe
+// ===================================================================================
+void I2cClockController::setClockNow(uint32_t hz) {
+  I2cBusGuard guard(I2C_BUS_PRIMARY_PORT);  // Not on the engine task
+  Wire.setClock(hz);
+  requested_hz_.store(hz, std::memory_order_relaxed);
+  applied_hz_.store(hz, std::memory_order_relaxed);
+}
+
+// Boot probes drive the HAL directly. Late ones queue to the engine, which
+// owns the bus by then and applies the requested rung before running them.
+static I2cStatus probeAddr(uint8_t addr, bool late) {
+  if (!late) return i2cBusProbe(I2C_BUS_PRIMARY_PORT, addr, I2C_CLOCK_PROBE_TIMEOUT_MS);
+
+  I2cTransaction txn;
+  txn.addr = addr;
+  txn.retries = 0;
+  return I2cEngine::getInstance().transact(txn);
+}
+
+static bool readVersion(uint8_t addr, uint8_t* rx, bool late) {
+  if (!late) {
+    size_t got = 0;
+    return i2cBusTransfer(I2C_BUS_PRIMARY_PORT, addr, versionQuery, sizeof(versionQuery), rx,
+                          sizeof(versionQuery), got, I2C_CLOCK_PROBE_TIMEOUT_MS) == I2cStatus::OK &&
+           got == sizeof(versionQuery);
+  }
+
+  I2cTransaction txn;
+  txn.addr = addr;
+  txn.retries = 0;
+  txn.tx_len = sizeof(versionQuery);
+  txn.rx_len = sizeof(versionQuery);
+  memcpy(txn.tx, versionQuery, sizeof(versionQuery));
+  // A short response fails as SHORT_READ
+  if (I2cEngine::getInstance().transact(txn) != I2cStatus::OK) return false;
+  memcpy(rx, txn.rx, sizeof(versionQuery));
+  return true;
+}
+
+bool I2cClockController::probeRung(const uint8_t* addrs, size_t count, const uint8_t* ref,
+                                   bool late) {
+  for (int round = 0; round < I2C_CLOCK_PROBE_ROUNDS; round++) {
+    for (size_t i = 0; i < count; i++) {
+      if (probeAddr(addrs[i], late) != I2cStatus::OK) return false;
+    }
+    if (!ref) continue;
+
+    uint8_t rx[sizeof(versionQuery)];
+    if (!readVersion(wombat_addr_, rx, late) || memcmp(rx, ref, sizeof(rx)) != 0) return false;
+  }
+  return true;
+}
+
+// Walk down from rung top to the first one every device passes (the floor
+// at worst) and leave the bus there
+int I2cClockController::probeDown(int top, const uint8_t* addrs, size_t count, bool late) {
+  auto setRung = [this, late](int level) {
+    if (late) {
+      requested_hz_.store(clockRungs[level], std::memory_order_release);
+    } else {
+      setClockNow(clockRungs[level]);
+    }
+  };
+
+  // Reference version packet at the floor (only the SerialWombat is sent data)
+  setRung(0);
+  uint8_t ref[sizeof(versionQuery)];
+  const uint8_t* refPtr = nullptr;
+  for (size_t i = 0; i < count; i++) {
+    if (addrs[i] == wombat_addr_ && readVersion(wombat_addr_, ref, late)) refPtr = ref;
+  }
+
+  int level = top;
+  for (; level > 0; level--) {
+    setRung(level);
+    if (probeRung(addrs, count, refPtr, late)) break;
+  }
+  setRung(level);
+  return level;
+}
+
+uint32_t I2cClockController::begin(uint32_t maxHz, bool adaptive, uint8_t wombatAddr) {
+  adaptive_ = adaptive;
+  max_hz_ = maxHz < I2C_CLOCK_FLOOR_HZ ? I2C_CLOCK_FLOOR_HZ : maxHz;
+  wombat_addr_ = wombatAddr;
+
+  top_ = 0;
+  while (top_ + 1 < CLOCK_RUNG_COUNT && clockRungs[top_ + 1] <= max_hz_) top_++;
+  ceiling_ = top_;
+  level_ = top_;
+
+  if (!adaptive_) {
+    probed_ = true;
+    setClockNow(max_hz_);
+    return max_hz_;
+  }
+
+  // Devices present at the floor rate
+  setClockNow(I2C_CLOCK_FLOOR_HZ);
+  uint8_t present[I2C_CLOCK_MAX_TRACKED];
+  size_t count = 0;
+  for (uint8_t a = I2C_CLOCK_SCAN_FIRST; a <= I2C_CLOCK_SCAN_LAST; a++) {
+    if (i2cBusProbe(I2C_BUS_PRIMARY_PORT, a, I2C_CLOCK_PROBE_TIMEOUT_MS) != I2cStatus::OK) {
+      continue;
+    }
+    // Keep the SerialWombat even past the limit: it gets the data check
+    if (count < I2C_CLOCK_MAX_TRACKED) {
+      present[count++] = a;
+    } else if (a == wombatAddr) {
+      present[count - 1] = a;
+    }
+  }
+
+  // Nothing to verify against: stay at the floor until probeLate() has a
+  // device to prove faster rungs with
+  if (count == 0) {
+    level_ = 0;
+    ceiling_ = 0;
+    window_start_ms_ = millis();
+    return I2C_CLOCK_FLOOR_HZ;
+  }
+
+  int level = probeDown(top_, present, count, false);
+  probed_ = true;
+  level_ = level;
+  ceiling_ = level;
+  window_start_ms_ = millis();
+  return clockRungs[level];
+}
+
+uint32_t I2cClockController::probeLate(const uint8_t* addrs, size_t count) {
+  if (!needsLateProbe() || count == 0) return clockRungs[level_];
+
+  int level = probeDown(top_, addrs, count, true);
+  probed_ = true;
+  level_ = level;
+  ceiling_ = level;
+  // Failures at the rejected rungs say nothing about the one chosen
+  restartWindow(millis());
+  return clockRungs[level];
+}
+
+// ===================================================================================
+// Engine Task Hooks
+// ===================================================================================
+void I2cClockController::applyPending() {
+  uint32_t want = requested_hz_.load(std::memory_order_acquire);
+  if (want == applied_hz_.load(std::memory_order_relaxed)) return;
+
+  Wire.setClock(want);
+  applied_hz_.store(want, std::memory_order_relaxed);
+}
+
+void I2cClockController::onTransfer(uint8_t addr, I2cStatus status) {
+  uint8_t n = slot_count_.load(std::memory_order_relaxed);
+  AddrSlot* slot = nullptr;
+  for (uint8_t i = 0; i < n; i++) {
+    if (slots_[i].addr.load(std::memory_order_relaxed) == addr) {
+      slot = &slots_[i];
+      break;
+    }
+  }
+  if (!slot) {
+    if (n >= I2C_CLOCK_MAX_TRACKED) return;
+    slot = &slots_[n];
+    slot->addr.store(addr, std::memory_order_relaxed);
+    slot_count_.store(n + 1, std::memory_order_release);
+  }
+
+  slot->transfers.fetch_add(1, std::memory_order_relaxed);
+  switch (status) {
+    case I2cStatus::OK:
+      break;
+    case I2cStatus::SHORT_READ:
+      slot->short_reads.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case I2cStatus::NACK:
+      slot->nacks.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case I2cStatus::TIMEOUT:
+      slot->timeouts.fetch_add(1, std::memory_order_relaxed);
+      break;
+    default:  // Bus error, lost arbitration, stuck bus
+      slot->bus_errors.fetch_add(1, std::memory_order_relaxed);
+      break;
+  }
+}
+
+// ===================================================================================
+// Adaptation (loop task)
+// ===================================================================================
+void I2cClockController::requestLevel(int level) {
+  level_ = level;
+  last_change_ms_ = millis();
+  requested_hz_.store(clockRungs[level], std::memory_order_release);
+}
+
+uint32_t I2cClockController::otherErrors(const AddrSlot& s) {
+  return s.timeouts.load(std::memory_order_relaxed) + s.bus_errors.load(std::memory_order_relaxed) +
+         s.short_reads.load(std::memory_order_relaxed);
+}
+
+void I2cClockController::restartWindow(uint32_t now) {
+  window_start_ms_ = now;
+  uint8_t n = slot_count_.load(std::memory_order_acquire);
+  for (uint8_t i = 0; i < n; i++) {
+    const AddrSlot& s = slots_[i];
+    AddrWindow& w = windows_[i];
+    w.transfers = s.transfers.load(std::memory_order_relaxed);
+    w.nacks = s.nacks.load(std::memory_order_relaxed);
+    w.errors = otherErrors(s);
+  }
+}
+
+bool I2cClockController::poll(I2cClockChange& change) {
+  uint32_t now = millis();
+  if (now - window_start_ms_ < I2C_CLOCK_WINDOW_MS) return false;
+  window_start_ms_ = now;
+
+  // Close the window for every tracked address
+  bool judged = false;
+  bool dirty = false;
+  uint16_t worst = 0;
+  uint8_t worstAddr = 0;
+  uint8_t n = slot_count_.load(std::memory_order_acquire);
+  for (uint8_t i = 0; i < n; i++) {
+    const AddrSlot& s = slots_[i];
+    uint32_t transfers = s.transfers.load(std::memory_order_relaxed);
+    uint32_t nacks = s.nacks.load(std::memory_order_relaxed);
+    uint32_t errors = otherErrors(s);
+
+    AddrWindow& w = windows_[i];
+    uint32_t dt = transfers - w.transfers;
+    uint32_t dn = nacks - w.nacks;
+    uint32_t de = errors - w.errors;
+    w.transfers = transfers;
+    w.nacks = nacks;
+    w.errors = errors;
+
+    // NACKs from an address that has not answered lately are a client
+    // talking to nothing, not a clock the device cannot follow
+    bool acked = dt > dn + de;
+    if (acked || w.acked) {
+      de += dn;
+    } else {
+      dt -= dn;
+    }
+    w.acked = acked;
+    w.permille = dt ? (uint16_t)((uint64_t)de * 1000 / dt) : 0;
+
+    if (dt < I2C_CLOCK_MIN_SAMPLES) continue;
+    judged = true;
+    if (de > 0) dirty = true;
+    if (w.permille > worst) {
+      worst = w.permille;
+      worstAddr = s.addr.load(std::memory_order_relaxed);
+    }
+  }
+
+  if (!adaptive_ || !judged) return false;
+
+  uint32_t fromHz = clockRungs[level_];
+  if (worst > I2C_CLOCK_DOWN_PERMILLE) {
+    clean_windows_ = 0;
+    if (level_ == 0) return false;
+
+    if (last_up_ms_ && now - last_up_ms_ < I2C_CLOCK_REVERT_MS &&
+        backoff_ < I2C_CLOCK_MAX_BACKOFF) {
+      backoff_ *= 2;
+    }
+    requestLevel(level_ - 1);
+    step_downs_++;
+    change = {fromHz, clockRungs[level_], true, worstAddr, worst};
+    return true;
+  }
+
+  if (dirty) {
+    clean_windows_ = 0;
+    return false;
+  }
+
+  if (++clean_windows_ < I2C_CLOCK_UP_WINDOWS * backoff_) return false;
+
+  // The current rung has held long enough
+  clean_windows_ = 0;
+  if (level_ >= ceiling_) {
+    backoff_ = 1;
+    return false;
+  }
+  requestLevel(level_ + 1);
+  last_up_ms_ = now;
+  step_ups_++;
+  change = {fromHz, clockRungs[level_], false, 0, 0};
+  return true;
+}
+
+// ===================================================================================
+// Diagnostics
+// ===================================================================================
+void I2cClockController::getStatus(I2cClockStatus& out) const {
+  out.adaptive = adaptive_;
+  out.hz = applied_hz_.load(std::memory_order_relaxed);
+  out.probed_hz = adaptive_ ? clockRungs[ceiling_] : max_hz_;
+  out.max_hz = max_hz_;
+  out.step_downs = step_downs_;
+  out.step_ups = step_ups_;
+  out.last_change_ms = last_change_ms_;
+
+  uint8_t n = slot_count_.load(std::memory_order_acquire);
+  out.addr_count = n;
+  for (uint8_t i = 0; i < n; i++) {
+    const AddrSlot& s = slots_[i];
+    I2cAddrErrorStats& a = out.addrs[i];
+    a.addr = s.addr.load(std::memory_order_relaxed);
+    a.transfers = s.transfers.load(std::memory_order_relaxed);
+    a.nacks = s.nacks.load(std::memory_order_relaxed);
+    a.timeouts = s.timeouts.load(std::memory_order_relaxed);
+    a.bus_errors = s.bus_errors.load(std::memory_order_relaxed);
+    a.short_reads = s.short_reads.load(std::memory_order_relaxed);
+    a.window_permille = windows_[i].permille;
+  }
+}
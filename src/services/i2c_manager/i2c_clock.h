@@ -0,0 +1,174 @@
+/*
+ * I2C Clock Controller - Header
+ *
+ * Chooses and maintains the clock of the primary I2C bus.
+ *
+ * At boot, begin() finds every device that ACKs at 100 kHz, then walks a
+ * ladder of clock rates from the configured maximum downwards and keeps the
+ * fastest rung at which, over several rounds, every device still ACKs and the
+ * SerialWombat returns the same version packet it returned at 100 kHz.
+ *
+ * When no device answers at boot there is nothing to verify a rung against:
+ * the bus stays at the floor until a device appears and passes the same
+ * probe (probeLate(), through the engine).
+ *
+ * At run time the I2C engine reports the outcome of every transaction per
+ * target address, once, after its retries (onTransfer(), engine task).
+ * poll() (loop task) closes one error window per second: when any address
+ * with enough traffic exceeds the step-down error rate (any failure class of
+ * i2c_bus.h), the clock drops one rung; after enough consecutive error-free
+ * windows it climbs back one rung, never above the probed rung. A step up
+ * that fails straight away doubles the clean time needed before the next
+ * attempt. NACKs only count for an address that completed a transfer in the
+ * current or the previous window: a client polling an absent address must
+ * not drag the whole bus down.
+ *
+ * Clock changes are applied by the engine task between transfers
+ * (applyPending()), so no transfer straddles a change.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "../../hal/i2c/i2c_bus.h"
+
+// Lowest rung; also the rate used to discover devices
+#define I2C_CLOCK_FLOOR_HZ 100000
+
+// Addresses with individual error statistics
+#define I2C_CLOCK_MAX_TRACKED 8
+
+// Boot probe: rounds per rung and per-transfer timeout
+#define I2C_CLOCK_PROBE_ROUNDS 16
+#define I2C_CLOCK_PROBE_TIMEOUT_MS 20
+
+// Adaptation: window length, minimum transfers for an address to count,
+// step-down threshold, clean windows before stepping up, backoff limit
+#define I2C_CLOCK_WINDOW_MS 1000
+#define I2C_CLOCK_MIN_SAMPLES 32
+#define I2C_CLOCK_DOWN_PERMILLE 20
+#define I2C_CLOCK_UP_WINDOWS 30
+#define I2C_CLOCK_MAX_BACKOFF 8
+
+// Lifetime error counters of one target address
+struct I2cAddrErrorStats {
+  uint8_t addr;
+  uint32_t transfers;
+  uint32_t nacks;
+  uint32_t timeouts;
+  uint32_t bus_errors;
+  uint32_t short_reads;
+  uint16_t window_permille;  // Error rate judged in the last closed window
+};
+
+struct I2cClockStatus {
+  bool adaptive;
+  uint32_t hz;         // Clock in use
+  uint32_t probed_hz;  // Fastest stable rung found by the probe
+  uint32_t max_hz;     // Configured maximum
+  uint32_t step_downs;
+  uint32_t step_ups;
+  uint32_t last_change_ms;  // millis() of the last step, 0 = none
+  uint8_t addr_count;
+  I2cAddrErrorStats addrs[I2C_CLOCK_MAX_TRACKED];
+};
+
+// One clock step taken by poll(), for logging
+struct I2cClockChange {
+  uint32_t from_hz;
+  uint32_t to_hz;
+  bool down;
+  uint8_t addr;       // Worst address (step down)
+  uint16_t permille;  // Its error rate
+};
+
+class I2cClockController {
+ public:
+  static I2cClockController& getInstance();
+
+  // Boot, after Wire.begin() and before the I2C engine starts: probe and set
+  // the fastest stable rung up to maxHz (rounded down to a rung). wombatAddr
+  // gets a data check on top of the ACK probe. With adaptive false the bus
+  // simply runs at maxHz. Returns the clock set.
+  uint32_t begin(uint32_t maxHz, bool adaptive, uint8_t wombatAddr);
+
+  // Engine task: apply a clock change requested by poll(); call before each
+  // transfer
+  void applyPending();
+
+  // Engine task: account one finished transaction (final status)
+  void onTransfer(uint8_t addr, I2cStatus status);
+
+  // Loop task, engine running: true while the ceiling is still unproven
+  // because begin() found no device
+  bool needsLateProbe() const { return adaptive_ && !probed_; }
+
+  // Loop task, engine running: probe the rungs as begin() does, against the
+  // given 7-bit addresses on the primary bus, with every transfer queued to
+  // the engine, and make the fastest stable rung the new ceiling. Returns the
+  // clock set.
+  uint32_t probeLate(const uint8_t* addrs, size_t count);
+
+  // Loop task: close the error window when due and step the clock. Returns
+  // true when a step was taken (details in change).
+  bool poll(I2cClockChange& change);
+
+  uint32_t currentHz() const { return applied_hz_.load(std::memory_order_relaxed); }
+  void getStatus(I2cClockStatus& out) const;
+
+ private:
+  I2cClockController();
+  I2cClockController(const I2cClockController&) = delete;
+  I2cClockController& operator=(const I2cClockController&) = delete;
+
+  // Counters written by the engine task only
+  struct AddrSlot {
+    std::atomic<uint8_t> addr;
+    std::atomic<uint32_t> transfers;
+    std::atomic<uint32_t> nacks;
+    std::atomic<uint32_t> timeouts;
+    std::atomic<uint32_t> bus_errors;
+    std::atomic<uint32_t> short_reads;
+  };
+
+  // Window state owned by the loop task: counters at the last window close
+  struct AddrWindow {
+    uint32_t transfers;
+    uint32_t nacks;
+    uint32_t errors;  // Failures other than NACK
+    bool acked;       // Completed a transfer in the last closed window
+    uint16_t permille;
+  };
+
+  void setClockNow(uint32_t hz);
+  int probeDown(int top, const uint8_t* addrs, size_t count, bool late);
+  bool probeRung(const uint8_t* addrs, size_t count, const uint8_t* ref, bool late);
+  void requestLevel(int level);
+  void restartWindow(uint32_t now);
+  static uint32_t otherErrors(const AddrSlot& s);  // Failures other than NACK
+
+  AddrSlot slots_[I2C_CLOCK_MAX_TRACKED];
+  std::atomic<uint8_t> slot_count_;
+  std::atomic<uint32_t> requested_hz_;
+  std::atomic<uint32_t> applied_hz_;
+
+  bool adaptive_;
+  bool probed_;  // Ceiling verified against at least one device
+  uint32_t max_hz_;
+  uint8_t wombat_addr_;
+  int top_;      // Fastest rung allowed by max_hz_
+  int level_;    // Current rung
+  int ceiling_;  // Fastest rung the probe verified
+  AddrWindow windows_[I2C_CLOCK_MAX_TRACKED];
+  uint32_t window_start_ms_;
+  uint32_t clean_windows_;
+  uint32_t backoff_;
+  uint32_t last_up_ms_;
+  uint32_t step_downs_;
+  uint32_t step_ups_;
+  uint32_t last_change_ms_;
+};
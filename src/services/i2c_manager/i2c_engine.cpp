@@ -0,0 +1,320 @@
+/*
+ * I2C Transaction Engine - Implementation
+ */
+
+#include "i2c_engine.h"
+
+#include <new>
+
+#include "../../core/i2c_monitor.h"
+#include "i2c_clock.h"
+#include "i2c_trace.h"
+
+// ===================================================================================
+// Singleton Implementation
+// ===================================================================================
+I2cEngine& I2cEngine::getInstance(uint8_t bus) {
+  static I2cEngine primary(I2C_BUS_PRIMARY_PORT);
+  static I2cEngine secondary(I2C_BUS_SECONDARY_PORT);
+  return bus == I2C_BUS_SECONDARY_PORT ? secondary : primary;
+}
+
+I2cEngine::I2cEngine(uint8_t port)
+    : port_(port),
+      task_(nullptr),
+      queue_(nullptr),
+      lanes_(nullptr),
+      next_source_(0),
+      completed_(0),
+      errors_(0),
+      attempts_(0),
+      retries_(0),
+      recovered_(0),
+      bus_clears_(0),
+      bus_clear_failures_(0),
+      last_clear_ms_(0),
+      cleared_once_(false) {
+  for (auto& c : class_counts_) c.store(0, std::memory_order_relaxed);
+  lane_mutex_ = xSemaphoreCreateMutex();
+}
+
+// ===================================================================================
+// Lifecycle
+// ===================================================================================
+bool I2cEngine::begin(int core, int priority) {
+  if (task_) return true;
+
+  if (!lanes_) lanes_ = new (std::nothrow) I2cLane[I2C_ENGINE_MAX_LANES];
+  if (!lanes_) return false;
+  if (!queue_) queue_ = xQueueCreate(I2C_ENGINE_QUEUE_DEPTH, sizeof(Request));
+  if (!queue_) return false;
+
+  BaseType_t affinity = (core >= 0 && core < portNUM_PROCESSORS) ? core : tskNO_AFFINITY;
+  if (priority < 1) priority = 1;
+  if (priority > configMAX_PRIORITIES - 1) priority = configMAX_PRIORITIES - 1;
+
+  const char* name = port_ == I2C_BUS_PRIMARY_PORT ? "i2c_engine" : "i2c_engine1";
+  if (xTaskCreatePinnedToCore(taskEntry, name, I2C_ENGINE_TASK_STACK, this, priority, &task_,
+                              affinity) != pdPASS) {
+    task_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+I2cLane* I2cEngine::openLane(TaskHandle_t owner, bool priority) {
+  if (!lanes_) return nullptr;
+
+  I2cLane* lane = nullptr;
+  xSemaphoreTake(lane_mutex_, portMAX_DELAY);
+  for (uint8_t i = 0; i < I2C_ENGINE_MAX_LANES; i++) {
+    I2cLane& l = lanes_[i];
+    if (!l.in_use) {
+      l.in_use = true;
+      l.owner = owner;
+      l.priority = priority;
+      lane = &l;
+      break;
+    }
+  }
+  xSemaphoreGive(lane_mutex_);
+  return lane;
+}
+
+// ===================================================================================
+// Submission
+// ===================================================================================
+bool I2cEngine::submit(I2cLane* lane, const I2cTransaction& txn) {
+  if (!lane || !lane->requests.push(txn)) return false;
+  if (task_) xTaskNotifyGive(task_);
+  return true;
+}
+
+bool I2cEngine::submit(const I2cTransaction& txn, I2cCompletionFn done, void* ctx,
+                       uint32_t timeoutMs) {
+  if (!task_) return false;
+
+  Request req;
+  req.txn = txn;
+  req.done = done;
+  req.ctx = ctx;
+  if (xQueueSend(queue_, &req, pdMS_TO_TICKS(timeoutMs)) != pdTRUE) return false;
+
+  xTaskNotifyGive(task_);
+  return true;
+}
+
+namespace {
+// Hand-off for transact(): the waiter's copy is filled in before it is woken
+struct TransactWait {
+  I2cTransaction* txn;
+  TaskHandle_t waiter;
+};
+
+void transactDone(const I2cTransaction& txn, void* ctx) {
+  TransactWait* wait = static_cast<TransactWait*>(ctx);
+  *wait->txn = txn;
+  xTaskNotifyGive(wait->waiter);
+}
+}  // namespace
+
+I2cStatus I2cEngine::transact(I2cTransaction& txn) {
+  if (!task_ || xTaskGetCurrentTaskHandle() == task_) {
+    execute(txn);
+    return txn.status;
+  }
+
+  // The engine always completes queued work, so waiting without a timeout
+  // is bounded by the per-transaction bus timeout.
+  TransactWait wait = {&txn, xTaskGetCurrentTaskHandle()};
+  if (!submit(txn, transactDone, &wait, portMAX_DELAY)) {
+    execute(txn);
+    return txn.status;
+  }
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  return txn.status;
+}
+
+// ===================================================================================
+// Engine Task
+// ===================================================================================
+void I2cEngine::taskEntry(void* arg) {
+  static_cast<I2cEngine*>(arg)->taskLoop();
+}
+
+void I2cEngine::taskLoop() {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    while (serveNext()) {
+    }
+  }
+}
+
+// Execute one request; false when every source is empty
+bool I2cEngine::serveNext() {
+  // Priority lanes pre-empt at every transaction boundary
+  for (uint8_t i = 0; i < I2C_ENGINE_MAX_LANES; i++) {
+    I2cLane& lane = lanes_[i];
+    if (lane.in_use && lane.priority && serveLane(lane)) return true;
+  }
+
+  // Otherwise one request per source in turn
+  const uint8_t sources = I2C_ENGINE_MAX_LANES + 1;
+  for (uint8_t k = 0; k < sources; k++) {
+    uint8_t src = (next_source_ + k) % sources;
+    bool served = src == I2C_ENGINE_MAX_LANES
+                      ? serveShared()
+                      : lanes_[src].in_use && !lanes_[src].priority && serveLane(lanes_[src]);
+    if (served) {
+      next_source_ = (src + 1) % sources;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool I2cEngine::serveShared() {
+  Request req;
+  if (xQueueReceive(queue_, &req, 0) != pdTRUE) return false;
+  execute(req.txn);
+  if (req.done) req.done(req.txn, req.ctx);
+  return true;
+}
+
+bool I2cEngine::serveLane(I2cLane& lane) {
+  I2cTransaction txn;
+  if (!lane.requests.pop(txn)) return false;
+  execute(txn);
+
+  // Same depth as the request queue; only full if the owner has stalled
+  while (!lane.completions.push(txn)) {
+    vTaskDelay(1);
+  }
+
+  // Wake the owner once its batch is finished rather than per frame
+  if (lane.requests.empty() && lane.owner) xTaskNotifyGive(lane.owner);
+  return true;
+}
+
+void I2cEngine::attempt(I2cTransaction& txn) {
+  size_t got = 0;
+  if (txn.tx_len == 0 && txn.rx_len == 0) {
+    txn.status = i2cBusProbe(port_, i2cAddr7(txn.addr), I2C_ENGINE_TIMEOUT_MS);
+  } else {
+    txn.status = i2cBusTransfer(port_, i2cAddr7(txn.addr), txn.tx, txn.tx_len, txn.rx,
+                                txn.rx_len, got, I2C_ENGINE_TIMEOUT_MS);
+  }
+  txn.rx_got = (uint8_t)got;
+  if (txn.status == I2cStatus::OK && txn.rx_got < txn.rx_len) txn.status = I2cStatus::SHORT_READ;
+  txn.attempts++;
+}
+
+void I2cEngine::execute(I2cTransaction& txn) {
+  if (txn.tx_len > I2C_TXN_MAX_LEN) txn.tx_len = I2C_TXN_MAX_LEN;
+  if (txn.rx_len > I2C_TXN_MAX_LEN) txn.rx_len = I2C_TXN_MAX_LEN;
+
+  // The clock controller owns the primary bus only
+  const bool managed = port_ == I2C_BUS_PRIMARY_PORT;
+  I2cClockController& clock = I2cClockController::getInstance();
+  if (managed) clock.applyPending();
+
+  const bool probe = txn.tx_len == 0 && txn.rx_len == 0;
+  uint32_t backoff = I2C_ENGINE_RETRY_BASE_US;
+  txn.attempts = 0;
+  txn.start_us = micros();
+  for (;;) {
+    attempt(txn);
+    attempts_.fetch_add(1, std::memory_order_relaxed);
+
+    // An absent device is a probe's answer, not a bus fault
+    if (probe && txn.status == I2cStatus::NACK) break;
+    if (txn.status == I2cStatus::OK) break;
+
+    countFailure(txn.status);
+    if (txn.status == I2cStatus::BUS_ERROR || txn.attempts > txn.retries) break;
+    if (txn.status == I2cStatus::BUS_STUCK && !recoverBus()) break;
+
+    delayMicroseconds(backoff);
+    backoff = backoff * 2 > I2C_ENGINE_RETRY_MAX_US ? I2C_ENGINE_RETRY_MAX_US : backoff * 2;
+    retries_.fetch_add(1, std::memory_order_relaxed);
+  }
+  txn.end_us = micros();
+  // Once per transaction: retries of one failure are not separate errors
+  if (!probe && managed) clock.onTransfer(txn.addr, txn.status);
+
+  // A probe of an absent device has no device to account it to, and would
+  // flood the trace ring with presence sweeps
+  const bool miss = probe && txn.status == I2cStatus::NACK;
+  if (!miss) I2cTrace::getInstance().append(txn);
+  const bool failed = txn.status != I2cStatus::OK && !miss;
+  i2cMonitorRecord(txn.addr, !miss, txn.tx_len + txn.rx_got, failed, txn.end_us - txn.start_us);
+
+  completed_++;
+  if (txn.status == I2cStatus::OK) {
+    if (txn.attempts > 1) recovered_.fetch_add(1, std::memory_order_relaxed);
+  } else if (failed) {
+    errors_++;
+  }
+}
+
+void I2cEngine::countFailure(I2cStatus status) {
+  uint8_t i = (uint8_t)status;
+  if (i < sizeof(class_counts_) / sizeof(class_counts_[0])) {
+    class_counts_[i].fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+bool I2cEngine::recoverBus() {
+  uint32_t now = millis();
+  if (cleared_once_ && now - last_clear_ms_ < I2C_ENGINE_CLEAR_HOLDOFF_MS) return false;
+  cleared_once_ = true;
+  last_clear_ms_ = now;
+
+  if (!i2cBusClear(port_)) {
+    bus_clear_failures_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  bus_clears_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void I2cEngine::getErrorCounters(I2cErrorCounters& out) const {
+  auto count = [this](I2cStatus s) {
+    return class_counts_[(uint8_t)s].load(std::memory_order_relaxed);
+  };
+  out.attempts = attempts_.load(std::memory_order_relaxed);
+  out.nacks = count(I2cStatus::NACK);
+  out.timeouts = count(I2cStatus::TIMEOUT);
+  out.arb_lost = count(I2cStatus::ARB_LOST);
+  out.short_reads = count(I2cStatus::SHORT_READ);
+  out.bus_stuck = count(I2cStatus::BUS_STUCK);
+  out.bus_errors = count(I2cStatus::BUS_ERROR);
+  out.retries = retries_.load(std::memory_order_relaxed);
+  out.recovered = recovered_.load(std::memory_order_relaxed);
+  out.failed = errors_;
+  out.bus_clears = bus_clears_.load(std::memory_order_relaxed);
+  out.bus_clear_failures = bus_clear_failures_.load(std::memory_order_relaxed);
+}
+
+// ===================================================================================
+// Convenience Helpers
+// ===================================================================================
+I2cStatus i2cEngineWriteRead(uint8_t addr, const uint8_t* tx, size_t txLen, uint8_t* rx,
+                             size_t rxLen) {
+  I2cTransaction txn;
+  txn.addr = addr;
+  txn.tx_len = (uint8_t)(txLen < I2C_TXN_MAX_LEN ? txLen : I2C_TXN_MAX_LEN);
+  txn.rx_len = (uint8_t)(rxLen < I2C_TXN_MAX_LEN ? rxLen : I2C_TXN_MAX_LEN);
+  if (txn.tx_len) memcpy(txn.tx, tx, txn.tx_len);
+
+  I2cStatus status = I2cEngine::forAddress(addr).transact(txn);
+  if (rx && txn.rx_got) memcpy(rx, txn.rx, txn.rx_got);
+  return status;
+}
+
+I2cStatus i2cEngineProbe(uint8_t addr) {
+  I2cTransaction txn;
+  txn.addr = addr;
+  return I2cEngine::forAddress(addr).transact(txn);
+}
@@ -0,0 +1,218 @@
+/*
+ * I2C Transaction Engine - Header
+ *
+ * Owns execution of I2C transactions on a dedicated FreeRTOS task so callers
+ * can overlap their own work (network I/O, UI) with bus time. Every
+ * transaction with both a write and a read phase is issued as a single
+ * repeated-start transfer through the I2C bus HAL.
+ *
+ * Submission paths:
+ * - Lanes: lock-free SPSC request/completion queues for one high-rate producer
+ *   task (the bridge). The owner task is notified when the lane drains.
+ * - submit(): asynchronous from any task; the completion callback runs on the
+ *   engine task.
+ * - transact(): blocking convenience wrapper around submit().
+ *
+ * The engine task alternates between the shared queue and each lane so neither
+ * path can starve the other. A priority lane is served ahead of all of them at
+ * every transaction boundary, so its requests wait for at most the transfer
+ * already on the bus. Every transfer is reported to the clock
+ * controller (i2c_clock.h), whose clock changes are applied between transfers.
+ *
+ * Failed attempts are classified by the bus HAL and counted per class. All
+ * classes except BUS_ERROR are retried up to the transaction's retry budget
+ * with doubling backoff. BUS_STUCK first clears the bus (SCL pulses + STOP);
+ * while a clear is held off or fails, the transaction fails without retries.
+ * SerialWombat packets are executed only once complete, so repeating one whose
+ * write phase failed is safe; callers whose commands must not run twice after
+ * a failed read phase set retries = 0.
+ *
+ * A transaction with neither a write nor a read phase is an address probe.
+ * A NACK is its answer (nothing there), so it is neither retried nor counted.
+ *
+ * There is one engine per I2C bus (getInstance(bus)), each with its own task,
+ * shared queue and lanes, so the primary (Wire) and secondary (Wire1) buses
+ * execute concurrently. Transactions carry bus-qualified addresses
+ * (i2c_bus.h); forAddress() picks the engine for one, and the convenience
+ * helpers below route by it. Only the primary bus is clock-managed; the
+ * secondary bus keeps the clock it was started with. An engine's lanes
+ * (~12 KB) are allocated by begin(), so an unused secondary bus costs no
+ * internal RAM for them.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <atomic>
+
+#include "../../core/spsc_queue.h"
+#include "../../hal/i2c/i2c_bus.h"
+
+// Longest write or read phase of a single transaction
+#define I2C_TXN_MAX_LEN 32
+
+// Depth of each lane's request and completion queues (power of two)
+#define I2C_LANE_DEPTH 32
+
+// Number of lanes available to producer tasks
+#define I2C_ENGINE_MAX_LANES 2
+
+// Depth of the shared (multi-producer) submission queue
+#define I2C_ENGINE_QUEUE_DEPTH 8
+
+// Per-transaction bus timeout
+#define I2C_ENGINE_TIMEOUT_MS 50
+
+// Retries after a failed attempt, first backoff and backoff cap
+#define I2C_ENGINE_DEFAULT_RETRIES 2
+#define I2C_ENGINE_RETRY_BASE_US 200
+#define I2C_ENGINE_RETRY_MAX_US 2000
+
+// Minimum time between two bus clears; a bus that stays stuck fails fast
+#define I2C_ENGINE_CLEAR_HOLDOFF_MS 250
+
+// Engine task stack size (bytes)
+#define I2C_ENGINE_TASK_STACK 3072
+
+// One I2C transaction: write tx_len bytes, then read rx_len bytes
+struct I2cTransaction {
+  uint8_t addr = 0;
+  uint8_t tx_len = 0;
+  uint8_t rx_len = 0;
+  uint8_t rx_got = 0;  // Response bytes actually read
+  I2cStatus status = I2cStatus::OK;
+
+  uint8_t retries = I2C_ENGINE_DEFAULT_RETRIES;  // Extra attempts allowed
+  uint8_t attempts = 0;                          // Attempts made (set by the engine)
+
+  // Opaque routing data for the submitter (e.g. session slot and id)
+  uint8_t channel = 0;
+  uint32_t tag = 0;
+  uint32_t seq = 0;  // Submitter's sequence number (passed through unchanged)
+
+  // micros() when the submitter received the request (passed through unchanged)
+  uint32_t queued_us = 0;
+
+  // micros() when the transfer started and finished on the bus
+  uint32_t start_us = 0;
+  uint32_t end_us = 0;
+
+  uint8_t tx[I2C_TXN_MAX_LEN];
+  uint8_t rx[I2C_TXN_MAX_LEN];
+};
+
+// Lifetime counters. Failure classes count attempts; the rest count
+// transactions.
+struct I2cErrorCounters {
+  uint32_t attempts;
+  uint32_t nacks;
+  uint32_t timeouts;
+  uint32_t arb_lost;
+  uint32_t short_reads;
+  uint32_t bus_stuck;
+  uint32_t bus_errors;
+  uint32_t retries;    // Attempts after the first
+  uint32_t recovered;  // Succeeded after a retry
+  uint32_t failed;     // Failed after every allowed attempt
+  uint32_t bus_clears;
+  uint32_t bus_clear_failures;  // SDA still low after the clear
+};
+
+// Completion callback for submit(); runs on the engine task
+typedef void (*I2cCompletionFn)(const I2cTransaction& txn, void* ctx);
+
+// Lock-free submission lane for a single producer task
+struct I2cLane {
+  SpscQueue<I2cTransaction, I2C_LANE_DEPTH> requests;     // owner -> engine
+  SpscQueue<I2cTransaction, I2C_LANE_DEPTH> completions;  // engine -> owner
+  TaskHandle_t owner = nullptr;  // Notified when the lane's requests are done
+  bool in_use = false;
+  bool priority = false;  // Served before the shared queue and other lanes
+};
+
+class I2cEngine {
+ public:
+  static I2cEngine& getInstance(uint8_t bus = I2C_BUS_PRIMARY_PORT);
+
+  // Engine of the bus a bus-qualified address is on
+  static I2cEngine& forAddress(uint8_t addr) { return getInstance(i2cAddrBus(addr)); }
+
+  // Start the engine task (call after Wire.begin() / Wire1.begin()). Returns
+  // false on failure.
+  bool begin(int core, int priority);
+  bool isRunning() const { return task_ != nullptr; }
+  uint8_t bus() const { return port_; }
+
+  // Reserve a lane for the calling producer task; nullptr if none left or
+  // the engine was never started
+  I2cLane* openLane(TaskHandle_t owner, bool priority = false);
+
+  // Lane producer side: queue a transaction and wake the engine.
+  // Returns false when the lane is full.
+  bool submit(I2cLane* lane, const I2cTransaction& txn);
+
+  // Queue a transaction from any task. done (optional) runs on the engine task.
+  // Returns false if the shared queue stayed full for timeoutMs.
+  bool submit(const I2cTransaction& txn, I2cCompletionFn done, void* ctx,
+              uint32_t timeoutMs = I2C_ENGINE_TIMEOUT_MS);
+
+  // Execute a transaction and wait for it. Runs inline when the engine task is
+  // not running or when called from the engine task itself.
+  I2cStatus transact(I2cTransaction& txn);
+
+  // Counters
+  uint32_t getCompletedCount() const { return completed_; }
+  uint32_t getErrorCount() const { return errors_; }
+  void getErrorCounters(I2cErrorCounters& out) const;
+
+ private:
+  explicit I2cEngine(uint8_t port);
+  I2cEngine(const I2cEngine&) = delete;
+  I2cEngine& operator=(const I2cEngine&) = delete;
+
+  struct Request {
+    I2cTransaction txn;
+    I2cCompletionFn done;
+    void* ctx;
+  };
+
+  static void taskEntry(void* arg);
+  void taskLoop();
+  bool serveNext();
+  bool serveShared();
+  bool serveLane(I2cLane& lane);
+  void execute(I2cTransaction& txn);
+  void attempt(I2cTransaction& txn);
+  void countFailure(I2cStatus status);
+  bool recoverBus();
+
+  const uint8_t port_;
+  TaskHandle_t task_;
+  QueueHandle_t queue_;
+  I2cLane* lanes_;  // I2C_ENGINE_MAX_LANES, allocated by begin()
+  SemaphoreHandle_t lane_mutex_;
+  uint8_t next_source_;  // Round robin over lanes_ and the shared queue (index MAX_LANES)
+
+  volatile uint32_t completed_;
+  volatile uint32_t errors_;
+
+  // Written by whichever task executes (normally only the engine task)
+  std::atomic<uint32_t> attempts_;
+  std::atomic<uint32_t> class_counts_[(int)I2cStatus::BUS_STUCK + 1];  // By I2cStatus
+  std::atomic<uint32_t> retries_;
+  std::atomic<uint32_t> recovered_;
+  std::atomic<uint32_t> bus_clears_;
+  std::atomic<uint32_t> bus_clear_failures_;
+  uint32_t last_clear_ms_;
+  bool cleared_once_;
+};
+
+// Convenience helpers for single-shot callers; addr is bus-qualified
+// Write-then-read with repeated start; returns the bus status. Only the bytes
+// actually read are copied to rx: on failure the rest of rx is left untouched.
+I2cStatus i2cEngineWriteRead(uint8_t addr, const uint8_t* tx, size_t txLen, uint8_t* rx,
+                             size_t rxLen);
+
+// Address probe; OK when a device ACKs, NACK when nothing is there
+I2cStatus i2cEngineProbe(uint8_t addr);
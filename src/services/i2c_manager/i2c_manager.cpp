@@ -1,5 +1,9 @@
 #include "i2c_manager.h"
 
+#include "fingerprint_cache.h"
+#include "i2c_engine.h"
+#include "presence_scanner.h"
+
 // ===================================================================================
 // Pin Mode Strings (PROGMEM lookup table)
 // ===================================================================================
@@ -48,162 +52,132 @@ const char* const pinModeStrings[] PROGMEM = {"DIGITAL_IO",
 // ===================================================================================
 // I2C Deep Scan - Variant Detection
 // ===================================================================================
-VariantInfo getDeepScanInfoSingle(uint8_t addr) {
+// Ask whether pin mode pm is supported, using the known-good "wrong order"
+// fingerprint
+static void probePinMode(SerialWombat& sw_scan, int pm, PinModeCaps& caps) {
+  yield();
+  uint8_t tx[8] = {201, 1, (uint8_t)pm, 0x55, 0x55, 0x55, 0x55, 0x55};
+  int16_t ret = sw_scan.sendPacket(tx);
+  if ((ret * -1) == SW_ERROR_PIN_CONFIG_WRONG_ORDER) caps.supported |= pinModeBit(pm);
+  caps.probed |= pinModeBit(pm);
+}
+
+bool scanCapabilities(SerialWombat& sw_scan, PinModeCaps& caps, bool full) {
+  FingerprintCache& cache = FingerprintCache::getInstance();
+  caps = PinModeCaps();
+  cache.lookup(sw_scan, caps);
+
+  int probes = 0;
+  if (full) {
+    for (int pm = 0; pm < SW_PIN_MODE_COUNT; ++pm) {
+      if (caps.probed & pinModeBit(pm)) continue;
+      probePinMode(sw_scan, pm, caps);
+      probes++;
+    }
+  } else {
+    for (int pm = variantNextProbe(caps); pm >= 0; pm = variantNextProbe(caps)) {
+      probePinMode(sw_scan, pm, caps);
+      probes++;
+    }
+  }
+  if (probes) cache.store(sw_scan, caps);
+  return probes == 0;
+}
+
+VariantInfo getDeepScanInfoSingle(uint8_t addr, bool full) {
   VariantInfo info;
   info.variant = "Unknown";
-  for (int i = 0; i < 41; i++)
-    info.caps[i] = false;
+  info.cached = false;
 
+  I2cBusGuard guard(i2cAddrBus(addr));
   SerialWombat sw_scan;
-  sw_scan.begin(Wire, addr, false);
+  sw_scan.begin(i2cWireFor(addr), i2cAddr7(addr), false);
   if (!sw_scan.queryVersion()) return info;
 
-  // Scan supported pin modes using the known-good "wrong order" fingerprint
-  for (int pm = 0; pm < 41; ++pm) {
-    yield();
-    uint8_t tx[8] = {201, 1, (uint8_t)pm, 0x55, 0x55, 0x55, 0x55, 0x55};
-    int16_t ret = sw_scan.sendPacket(tx);
-    if ((ret * -1) == SW_ERROR_PIN_CONFIG_WRONG_ORDER) info.caps[pm] = true;
-  }
-
-  // Variant mapping matches the v06 Deep Scan decisions
-  if (info.caps[15]) {
-    info.variant = "Keypad Firmware";
-  } else if (info.caps[27]) {
-    info.variant = "Ultrasonic Firmware";
-  } else if (info.caps[17]) {
-    info.variant = "Communications Firmware";
-  } else if (info.caps[11]) {
-    info.variant = "TM1637 Display Firmware";
-  } else if (info.caps[25] && info.caps[36] && !info.caps[6]) {
-    info.variant = "Front Panel Firmware";
-  } else if (info.caps[6] && info.caps[3]) {
-    info.variant = "Motor Control / Default";
-  } else if (info.caps[6] && !info.caps[3]) {
-    info.variant = "Brushed Motor Firmware";
-  } else {
-    info.variant = "Custom_FW";
-  }
-
+  info.cached = scanCapabilities(sw_scan, info.caps, full);
+  info.variant = variantFromCaps(info.caps.supported);
   return info;
 }
 
 // ===================================================================================
 // I2C Handler Functions
 // ===================================================================================
-void handleScanData(WebServer& server) {
+// "0x2a", or "0x2a (bus 1)" for a bus-qualified address on the secondary bus
+static String busAddrLabel(uint8_t addr) {
+  String label = "0x" + String(i2cAddr7(addr), HEX);
+  if (i2cAddrBus(addr)) label += " (bus " + String(i2cAddrBus(addr)) + ")";
+  return label;
+}
+
+// Buses with an address space worth walking: the primary always, the rest once running
+static uint8_t scannableBuses() {
+  return I2cEngine::getInstance(I2C_BUS_SECONDARY_PORT).isRunning() ? I2C_BUS_COUNT : 1;
+}
+
+// Live blocking scan, used when the background presence scan is off
+static void sendLiveScan(WebServer& server) {
   String found;
   int count = 0;
-  for (uint8_t i = 8; i < 127; i++) {
-    Wire.beginTransmission(i);
-    if ((i2cMarkTx(), Wire.endTransmission()) == 0) {
-      found += "Device Found: 0x" + String(i, HEX) + "<br>";
-      count++;
+  I2cStatus fault = I2cStatus::OK;
+  uint8_t faultAddr = 0;
+  for (uint8_t bus = 0; bus < scannableBuses() && fault == I2cStatus::OK; bus++) {
+    for (uint8_t i = 8; i < 127; i++) {
+      uint8_t addr = i2cAddrOnBus(bus, i);
+      I2cStatus st = i2cEngineProbe(addr);
+      if (st == I2cStatus::OK) {
+        found += "Device Found: " + busAddrLabel(addr) + "<br>";
+        count++;
+      } else if (st != I2cStatus::NACK) {
+        // A faulty bus would otherwise read as "no devices"
+        fault = st;
+        faultAddr = addr;
+        break;
+      }
     }
   }
-  if (count == 0)
+  if (fault != I2cStatus::OK) {
+    found += "Bus fault at " + busAddrLabel(faultAddr) + ": " + i2cStatusToStr(fault) +
+             " (scan aborted)";
+  } else if (count == 0) {
     found = "No devices found.";
-  else
+  } else {
     found += "<br>Total: " + String(count);
+  }
   server.send(200, "text/plain", found);
 }
 
-// --- FINGERPRINT MATCHING DEEP SCAN (v06 preserved logic) ---
-void handleDeepScan(WebServer& server) {
-  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
-  server.send(200, "text/html", "");
-  server.sendContent(F(
-      "<!DOCTYPE HTML><html><head><meta name='viewport' content='width=device-width, "
-      "initial-scale=1'><style>body{font-family:monospace;background:#222;color:#eee;padding:10px;}"
-      ".chip{border:1px solid "
-      "#0f0;padding:10px;margin-bottom:10px;background:#333;}h3{color:#00d2ff;margin:0;}b{color:#"
-      "0f0;}.btn{display:block;padding:10px;background:#007acc;color:white;text-align:center;text-"
-      "decoration:none;margin-top:20px;}</style></head><body><h2>Serial Wombat Deep Scan</h2>"));
-
-  SerialWombat sw_scan;
-  for (int i2cAddress = 0x0E; i2cAddress <= 0x77; ++i2cAddress) {
-    yield();
-    Wire.beginTransmission((uint8_t)i2cAddress);
-    if ((i2cMarkTx(), Wire.endTransmission()) == 0) {
-      String out = "<div class='chip'><h3>Device @ 0x" + String(i2cAddress, HEX) + "</h3>";
-
-      sw_scan.begin(Wire, (uint8_t)i2cAddress, false);
-
-      if (sw_scan.queryVersion()) {
-        bool supported[41] = {0};
-        if (sw_scan.isSW18() || sw_scan.isSW08()) {
-          for (int pm = 0; pm < 41; ++pm) {
-            yield();
-            uint8_t tx[8] = {201, 1, (uint8_t)pm, 0x55, 0x55, 0x55, 0x55, 0x55};
-            int16_t ret = sw_scan.sendPacket(tx);
-            if ((ret * -1) == SW_ERROR_PIN_CONFIG_WRONG_ORDER) supported[pm] = true;
-          }
-        }
-
-        String variant = "Custom_FW";
-        if (supported[15]) {
-          variant = "Keypad Firmware";
-        } else if (supported[27]) {
-          variant = "Ultrasonic Firmware";
-        } else if (supported[17]) {
-          variant = "Communications Firmware";
-        } else if (supported[11]) {
-          variant = "TM1637 Display Firmware";
-        } else if (supported[25] && supported[36] && !supported[6]) {
-          variant = "Front Panel Firmware";
-        } else if (supported[6] && supported[3]) {
-          variant = "Motor Control / Default";
-        } else if (supported[6] && !supported[3]) {
-          variant = "Brushed Motor Firmware";
-        }
-
-        out += "<b>Serial Wombat Found!</b><br>";
-        if (sw_scan.inBoot)
-          out += "STATUS: <b style='color:orange'>BOOT MODE</b><br>";
-        else
-          out += "STATUS: <b>APP MODE</b><br>";
-
-        out += "Model: " + String((char*)sw_scan.model) + "<br>";
-        out += "FW Version: " + String((char*)sw_scan.fwVersion) + "<br>";
-        out += "<b>Variant: <span style='color:#0ff'>" + variant + "</span></b><br><br>";
-
-        out += "Uptime: " + String(sw_scan.readFramesExecuted()) + " frames<br>";
-        out += "Overflows: " + String(sw_scan.readOverflowFrames()) + "<br>";
-        out += "Errors: " + String(sw_scan.errorCount) + "<br>";
-        out += "Birthday: " + String(sw_scan.readBirthday()) + "<br>";
-
-        char brand[32];
-        sw_scan.readBrand(brand);
-        out += "Brand: " + String(brand) + "<br>";
-        out += "UUID: ";
-        for (int i = 0; i < sw_scan.uniqueIdentifierLength; ++i) {
-          if (sw_scan.uniqueIdentifier[i] < 16) out += "0";
-          out += String(sw_scan.uniqueIdentifier[i], HEX) + " ";
-        }
-        out += "<br>Voltage: " + String(sw_scan.readSupplyVoltage_mV()) + " mV<br>";
-        if (sw_scan.isSW18()) {
-          uint16_t t = sw_scan.readTemperature_100thsDegC();
-          out += "Temp: " + String(t / 100) + "." + String(t % 100) + " C<br>";
-        }
+void handleScanData(WebServer& server) {
+  PresenceScanner& presence = PresenceScanner::getInstance();
+  if (!presence.isEnabled()) {
+    sendLiveScan(server);
+    return;
+  }
 
-        if (sw_scan.isSW18() || sw_scan.isSW08()) {
-          out += "<br><b>Supported Pin Modes:</b><br><span style='font-size:0.8em;color:#aaa;'>";
-          for (int pm = 0; pm < 41; ++pm) {
-            if (supported[pm]) {
-              out += String(FPSTR(pinModeStrings[pm])) + ", ";
-            }
-          }
-          out += "</span>";
-        }
-      } else {
-        out += "Unknown I2C Device";
+  // Served from the presence map; no bus traffic on behalf of the page
+  PresenceSnapshot snap;
+  presence.getSnapshot(snap);
+  String found;
+  for (uint8_t bus = 0; bus < I2C_BUS_COUNT; bus++) {
+    for (int i = PRESENCE_FIRST_ADDR; i <= PRESENCE_LAST_ADDR; i++) {
+      uint8_t addr = i2cAddrOnBus(bus, (uint8_t)i);
+      if (snap.bitmap[addr >> 3] & (1 << (addr & 7))) {
+        found += "Device Found: " + busAddrLabel(addr) + "<br>";
       }
-
-      out += "</div>";
-      server.sendContent(out);
     }
   }
-
-  server.sendContent(F("<a href='/' class='btn'>Return to Dashboard</a></body></html>"));
-  server.sendContent("");
+  if (snap.fault != I2cStatus::OK) {
+    found += "Bus fault at " + busAddrLabel(snap.fault_addr) + ": " + i2cStatusToStr(snap.fault) +
+             "<br>";
+  }
+  if (!snap.complete) {
+    found += "First sweep in progress (" + busAddrLabel(snap.addr) + ")";
+  } else if (snap.count == 0) {
+    found += "No devices found.";
+  } else {
+    found += "<br>Total: " + String(snap.count);
+  }
+  if (snap.complete) {
+    found += "<br>Last sweep " + String((millis() - snap.last_sweep_ms) / 1000) + " s ago";
+  }
+  server.send(200, "text/plain", found);
 }
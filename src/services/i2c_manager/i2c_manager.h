@@ -7,30 +7,25 @@
 #include <WebServer.h>
 #include <Wire.h>
 
+#include "../../hal/i2c/i2c_bus.h"
+#include "variant_signatures.h"
+
 // ===================================================================================
 // I2C Manager Service
 // ===================================================================================
 // Provides I2C scanning and device detection functionality
-// - Fast I2C scan (handleScanData)
-// - Deep scan with Serial Wombat variant detection (handleDeepScan)
-// - Device capability analysis (getDeepScanInfoSingle)
+// - I2C scan results from the background presence map (handleScanData)
+// - Device capability analysis (getDeepScanInfoSingle); the full deep scan
+//   runs as a background job (scan_job.h)
+// Capability scans are kept in the fingerprint cache (fingerprint_cache.h)
 // ===================================================================================
 
 /**
- * I2C traffic tracking helpers
+ * Arduino Wire object of the bus a bus-qualified address is on, for the
+ * SerialWombat library: sw.begin(i2cWireFor(addr), i2cAddr7(addr))
  */
-extern volatile uint32_t g_i2c_tx_count;
-extern volatile uint32_t g_i2c_rx_count;
-extern volatile bool g_i2c_tx_blink;
-extern volatile bool g_i2c_rx_blink;
-
-inline void i2cMarkTx() {
-  g_i2c_tx_count++;
-  g_i2c_tx_blink = true;
-}
-inline void i2cMarkRx() {
-  g_i2c_rx_count++;
-  g_i2c_rx_blink = true;
+inline TwoWire& i2cWireFor(uint8_t addr) {
+  return i2cAddrBus(addr) == I2C_BUS_SECONDARY_PORT ? Wire1 : Wire;
 }
 
 /**
@@ -38,7 +33,8 @@ inline void i2cMarkRx() {
  */
 struct VariantInfo {
   String variant;
-  bool caps[41];
+  PinModeCaps caps;
+  bool cached;  // Capabilities came from the fingerprint cache
 };
 
 /**
@@ -53,14 +49,21 @@ extern const char* const pinModeStrings[] PROGMEM;
 void handleScanData(WebServer& server);
 
 /**
- * Perform deep I2C scan with Serial Wombat variant detection
- * @param server WebServer instance for sending response
+ * Pin-mode capabilities of a chip that answered queryVersion(). Starts from
+ * the fingerprint cache; modes it lacks are probed (one packet each) and
+ * cached. Name the variant with variantFromCaps(caps.supported).
+ * @param sw Chip handle after queryVersion()
+ * @param caps Receives the supported and probed modes
+ * @param full Probe all 41 modes; otherwise only those the variant
+ *        decision tree needs (variant_signatures.h)
+ * @return true when the cache answered without probing
  */
-void handleDeepScan(WebServer& server);
+bool scanCapabilities(SerialWombat& sw, PinModeCaps& caps, bool full);
 
 /**
  * Get detailed Serial Wombat variant info for a single address
  * @param addr I2C address to scan
+ * @param full Enumerate every pin mode rather than just classify
  * @return VariantInfo structure with detected variant and capabilities
  */
-VariantInfo getDeepScanInfoSingle(uint8_t addr);
+VariantInfo getDeepScanInfoSingle(uint8_t addr, bool full);
@@ -0,0 +1,72 @@
+/*
+ * I2C Transaction Tracer - Implementation
+ */
+
+#include "i2c_trace.h"
+
+#include <string.h>
+
+// ===================================================================================
+// Singleton Implementation
+// ===================================================================================
+I2cTrace& I2cTrace::getInstance() {
+  static I2cTrace instance;
+  return instance;
+}
+
+// ===================================================================================
+// Recording
+// ===================================================================================
+void I2cTrace::append(const I2cTransaction& txn) {
+  if (!enabled_.load(std::memory_order_relaxed)) return;
+
+  uint32_t seq = head_.fetch_add(1, std::memory_order_relaxed);
+  Slot& slot = slots_[seq & (I2C_TRACE_DEPTH - 1)];
+
+  // Invalidate before touching the record (seqlock write side)
+  slot.stamp.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  I2cTraceRecord& r = slot.rec;
+  uint32_t dur = txn.end_us - txn.start_us;
+  r.seq = seq;
+  r.t_us = txn.start_us;
+  r.dur_us = dur > 0xFFFF ? 0xFFFF : (uint16_t)dur;
+  r.addr = txn.addr;
+  r.status = (uint8_t)txn.status;
+  r.tx_len = txn.tx_len;
+  r.rx_len = txn.rx_len;
+  r.rx_got = txn.rx_got;
+  r.attempts = txn.attempts;
+  memcpy(r.tx, txn.tx, I2C_TRACE_DATA_BYTES);
+  memcpy(r.rx, txn.rx, I2C_TRACE_DATA_BYTES);
+
+  slot.stamp.store(seq + 1, std::memory_order_release);
+}
+
+void I2cTrace::clear() {
+  for (auto& slot : slots_) slot.stamp.store(0, std::memory_order_relaxed);
+  head_.store(0, std::memory_order_release);
+}
+
+// ===================================================================================
+// Export
+// ===================================================================================
+size_t I2cTrace::read(uint32_t& cursor, uint32_t end, I2cTraceRecord* out, size_t max) const {
+  // Older records are gone; wrap-safe distance from the newest
+  if (end - cursor > I2C_TRACE_DEPTH) cursor = end - I2C_TRACE_DEPTH;
+
+  size_t n = 0;
+  while (cursor != end && n < max) {
+    const Slot& slot = slots_[cursor & (I2C_TRACE_DEPTH - 1)];
+    uint32_t stamp = slot.stamp.load(std::memory_order_acquire);
+    if (stamp == cursor + 1) {
+      I2cTraceRecord rec;
+      memcpy(&rec, &slot.rec, sizeof(rec));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.stamp.load(std::memory_order_relaxed) == stamp) out[n++] = rec;
+    }
+    cursor++;
+  }
+  return n;
+}
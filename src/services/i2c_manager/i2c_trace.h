@@ -0,0 +1,82 @@
+/*
+ * I2C Transaction Tracer - Header
+ *
+ * Always-on record of the last I2C_TRACE_DEPTH engine transactions on every
+ * bus, for offline latency and error analysis (/api/i2c/trace, format in
+ * i2c_trace_format.h). The I2C engine appends one record per transaction
+ * from whichever task executed it: both engine tasks and inline callers.
+ * Address probes that find nothing (presence sweeps) are not recorded; at
+ * the default sweep rate they would turn the ring over every ~13 s.
+ *
+ * append() is lock-free for any number of writers: a fetch_add claims the
+ * next slot, and each slot carries a sequence stamp that is cleared while
+ * the record is written and set once it is complete. Readers copy a slot and
+ * keep it only if the stamp was the expected one before and after the copy,
+ * so a record overwritten mid-read is dropped instead of returned torn.
+ *
+ * Overhead, measured on the host with tools/i2c_trace_bench (x86-64, -O2,
+ * 20M appends): 17 ns per transaction enabled, 37 ns with two writers
+ * appending back to back; disabled it is one relaxed load. The same tool
+ * stress-tests read() against torn records. On the device the boot
+ * self-test times append() with the CPU cycle counter (appendCycles(), logged
+ * at boot and shown in /api/system); a few hundred cycles (1-2 us at
+ * 240 MHz) would still be under 0.5% of a SerialWombat packet exchange at
+ * 400 kHz (~400 us).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "i2c_engine.h"
+#include "i2c_trace_format.h"
+
+// Records kept (power of two); 28 bytes each in internal RAM
+#define I2C_TRACE_DEPTH 512
+
+class I2cTrace {
+  static_assert((I2C_TRACE_DEPTH & (I2C_TRACE_DEPTH - 1)) == 0,
+                "I2C_TRACE_DEPTH must be a power of two");
+
+ public:
+  static I2cTrace& getInstance();
+
+  void setEnabled(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+  bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Any task: record one finished transaction
+  void append(const I2cTransaction& txn);
+
+  // Sequence number the next record will get
+  uint32_t recorded() const { return head_.load(std::memory_order_acquire); }
+
+  // Any task: copy records from cursor up to (not including) end into out,
+  // oldest first, at most max. Records already overwritten or being
+  // rewritten are skipped. Advances cursor; returns the number copied.
+  size_t read(uint32_t& cursor, uint32_t end, I2cTraceRecord* out, size_t max) const;
+
+  // Boot, before any writer: drop every record (after the append self-test)
+  void clear();
+
+  // Cost of one append() measured at boot (CPU cycles), 0 = not measured
+  void setAppendCycles(uint32_t cycles) { append_cycles_ = cycles; }
+  uint32_t appendCycles() const { return append_cycles_; }
+
+ private:
+  I2cTrace() : slots_(), head_(0), enabled_(false), append_cycles_(0) {}
+  I2cTrace(const I2cTrace&) = delete;
+  I2cTrace& operator=(const I2cTrace&) = delete;
+
+  struct Slot {
+    std::atomic<uint32_t> stamp;  // seq + 1 when complete, 0 while written
+    I2cTraceRecord rec;
+  };
+
+  Slot slots_[I2C_TRACE_DEPTH];
+  std::atomic<uint32_t> head_;
+  std::atomic<bool> enabled_;
+  uint32_t append_cycles_;
+};
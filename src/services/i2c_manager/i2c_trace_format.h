@@ -0,0 +1,52 @@
+/*
+ * I2C Trace Format
+ *
+ * Layout of the binary I2C transaction trace served by /api/i2c/trace. Kept
+ * free of Arduino dependencies so host-side analysis code can include it.
+ * All fields are little-endian.
+ *
+ * File:   I2cTraceFileHeader, then I2cTraceRecord back to back, oldest first
+ *
+ * One record per engine transaction (all retries included). Timestamps are
+ * the device's micros() when the transaction started and wrap after ~71
+ * minutes. Records are numbered from boot; a record overwritten while the
+ * trace was being read is left out, so seq can skip.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define I2C_TRACE_MAGIC "WBIT"
+#define I2C_TRACE_VERSION 1
+
+// Leading bytes of each direction kept per record
+#define I2C_TRACE_DATA_BYTES 4
+
+#pragma pack(push, 1)
+struct I2cTraceFileHeader {
+  char magic[4];        // I2C_TRACE_MAGIC
+  uint8_t version;      // I2C_TRACE_VERSION
+  uint8_t record_size;  // sizeof(I2cTraceRecord)
+  uint16_t depth;       // Ring capacity in records
+  uint32_t i2c_clock;   // Primary bus clock when read (Hz)
+  uint32_t recorded;    // Records appended since boot (seq of the next one)
+};
+
+struct I2cTraceRecord {
+  uint32_t seq;                      // Number since boot
+  uint32_t t_us;                     // Start of the first attempt
+  uint16_t dur_us;                   // First attempt to last, saturated at 65535
+  uint8_t addr;                      // Bus-qualified target (bit 7 = secondary bus)
+  uint8_t status;                    // I2cStatus of the last attempt
+  uint8_t tx_len;                    // Bytes written (0 and rx_len 0: probe)
+  uint8_t rx_len;                    // Bytes requested
+  uint8_t rx_got;                    // Bytes read
+  uint8_t attempts;                  // 1 + retries
+  uint8_t tx[I2C_TRACE_DATA_BYTES];  // First bytes written
+  uint8_t rx[I2C_TRACE_DATA_BYTES];  // First bytes read
+};
+#pragma pack(pop)
+
+static_assert(sizeof(I2cTraceFileHeader) == 16, "trace file header layout");
+static_assert(sizeof(I2cTraceRecord) == 24, "trace record layout");
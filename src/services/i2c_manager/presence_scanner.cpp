@@ -0,0 +1,172 @@
+/*
+ * Bus Presence Scanner - Implementation
+ */
+
+#include "presence_scanner.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+// ===================================================================================
+// Singleton Implementation
+// ===================================================================================
+PresenceScanner& PresenceScanner::getInstance() {
+  static PresenceScanner instance;
+  return instance;
+}
+
+PresenceScanner::PresenceScanner()
+    : done_status_(0),
+      done_(false),
+      in_flight_(false),
+      interval_ms_(0),
+      last_probe_ms_(0),
+      next_addr_(PRESENCE_FIRST_ADDR),
+      probe_addr_(0),
+      present_(),
+      misses_(),
+      sweeps_(0),
+      sweep_start_ms_(0),
+      sweep_ms_(0),
+      last_sweep_ms_(0),
+      fault_(I2cStatus::OK),
+      fault_addr_(0),
+      sweep_fault_(I2cStatus::OK),
+      sweep_fault_addr_(0),
+      events_(),
+      event_head_(0),
+      event_count_(0),
+      events_dropped_(0) {}
+
+void PresenceScanner::begin(uint32_t intervalMs) {
+  interval_ms_ = intervalMs;
+  sweep_start_ms_ = millis();
+}
+
+// ===================================================================================
+// Probing
+// ===================================================================================
+void PresenceScanner::onProbeDone(const I2cTransaction& txn, void* ctx) {
+  PresenceScanner* self = static_cast<PresenceScanner*>(ctx);
+  self->done_status_.store((uint8_t)txn.status, std::memory_order_relaxed);
+  self->done_.store(true, std::memory_order_release);
+}
+
+void PresenceScanner::service() {
+  if (in_flight_) {
+    if (!done_.load(std::memory_order_acquire)) return;
+    done_.store(false, std::memory_order_relaxed);
+    in_flight_ = false;
+    record(probe_addr_, (I2cStatus)done_status_.load(std::memory_order_relaxed));
+  }
+
+  uint32_t now = millis();
+  if (!interval_ms_ || now - last_probe_ms_ < interval_ms_) return;
+  last_probe_ms_ = now;
+
+  I2cTransaction txn;
+  txn.addr = next_addr_;
+  txn.retries = 0;  // A lost probe is simply retried next sweep
+  probe_addr_ = next_addr_;
+
+  I2cEngine& engine = I2cEngine::forAddress(probe_addr_);
+  if (engine.isRunning()) {
+    // Never wait for queue space; a busy bus just pushes the probe back
+    in_flight_ = engine.submit(txn, onProbeDone, this, 0);
+  } else {
+    record(probe_addr_, engine.transact(txn));
+  }
+}
+
+void PresenceScanner::record(uint8_t addr, I2cStatus status) {
+  uint8_t& byte = present_[addr >> 3];
+  const uint8_t bit = 1 << (addr & 7);
+
+  if (status == I2cStatus::OK) {
+    misses_[addr] = 0;
+    if (!(byte & bit)) {
+      byte |= bit;
+      if (sweeps_) pushEvent(addr, true);
+    }
+  } else if (status == I2cStatus::NACK) {
+    if ((byte & bit) && ++misses_[addr] >= PRESENCE_MISS_LIMIT) {
+      misses_[addr] = 0;
+      byte &= ~bit;
+      pushEvent(addr, false);
+    }
+  } else {
+    // Says nothing about the device; keep the last known state
+    sweep_fault_ = status;
+    sweep_fault_addr_ = addr;
+  }
+
+  if (addr == PRESENCE_LAST_ADDR && secondaryRunning()) {
+    next_addr_ = i2cAddrOnBus(I2C_BUS_SECONDARY_PORT, PRESENCE_FIRST_ADDR);
+  } else if (i2cAddr7(addr) >= PRESENCE_LAST_ADDR) {
+    endSweep();
+  } else {
+    next_addr_ = addr + 1;
+  }
+}
+
+bool PresenceScanner::secondaryRunning() {
+  return I2cEngine::getInstance(I2C_BUS_SECONDARY_PORT).isRunning();
+}
+
+void PresenceScanner::endSweep() {
+  uint32_t now = millis();
+  sweeps_++;
+  sweep_ms_ = now - sweep_start_ms_;
+  last_sweep_ms_ = now;
+  sweep_start_ms_ = now;
+  fault_ = sweep_fault_;
+  fault_addr_ = sweep_fault_addr_;
+  sweep_fault_ = I2cStatus::OK;
+  next_addr_ = PRESENCE_FIRST_ADDR;
+}
+
+// ===================================================================================
+// Events
+// ===================================================================================
+void PresenceScanner::pushEvent(uint8_t addr, bool present) {
+  if (event_count_ == PRESENCE_EVENT_DEPTH) {
+    event_head_ = (event_head_ + 1) % PRESENCE_EVENT_DEPTH;
+    event_count_--;
+    events_dropped_++;
+  }
+  PresenceEvent& ev = events_[(event_head_ + event_count_) % PRESENCE_EVENT_DEPTH];
+  ev.addr = addr;
+  ev.present = present;
+  event_count_++;
+}
+
+bool PresenceScanner::poll(PresenceEvent& event) {
+  if (!event_count_) return false;
+  event = events_[event_head_];
+  event_head_ = (event_head_ + 1) % PRESENCE_EVENT_DEPTH;
+  event_count_--;
+  return true;
+}
+
+// ===================================================================================
+// Status
+// ===================================================================================
+void PresenceScanner::getSnapshot(PresenceSnapshot& out) const {
+  memset(&out, 0, sizeof(out));
+  out.enabled = interval_ms_ != 0;
+  out.complete = sweeps_ != 0;
+  memcpy(out.bitmap, present_, sizeof(out.bitmap));
+  for (uint8_t bus = 0; bus < I2C_BUS_COUNT; bus++) {
+    for (int addr = PRESENCE_FIRST_ADDR; addr <= PRESENCE_LAST_ADDR; addr++) {
+      if (testBit(present_, i2cAddrOnBus(bus, (uint8_t)addr))) out.count++;
+    }
+  }
+  out.addr = next_addr_;
+  out.sweeps = sweeps_;
+  out.sweep_ms = sweep_ms_;
+  out.last_sweep_ms = last_sweep_ms_;
+  out.events_dropped = events_dropped_;
+  bool current = sweep_fault_ != I2cStatus::OK;
+  out.fault = current ? sweep_fault_ : fault_;
+  out.fault_addr = current ? sweep_fault_addr_ : fault_addr_;
+}
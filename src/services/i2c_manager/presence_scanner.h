@@ -0,0 +1,119 @@
+/*
+ * Bus Presence Scanner - Header
+ *
+ * Keeps a bitmap of the addresses that ACK on the I2C buses without
+ * blocking anyone. service() (loop task) submits at most one address probe
+ * at a time to the I2C engine's shared queue, and only every intervalMs,
+ * so a probe waits behind the priority lane and is round-robined with the
+ * bridge lanes: it never delays a bridge transaction by more than one
+ * probe. A sweep walks 0x08..0x7E; at the default interval it takes ~3 s.
+ * When the secondary bus engine runs, the sweep continues over the same
+ * range on that bus (bus-qualified addresses, i2c_bus.h), through its own
+ * engine, and takes twice as long.
+ *
+ * After the first full sweep every change is queued as a hot-plug event for
+ * poll(). A device appears on its first ACK and disappears only after
+ * PRESENCE_MISS_LIMIT sweeps in a row without one, so a single lost probe on
+ * a busy bus is not reported as an unplug. Probes that fail with anything
+ * other than NACK are bus faults: they leave the bitmap untouched and are
+ * reported in the snapshot instead.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "../../hal/i2c/i2c_bus.h"
+#include "i2c_engine.h"
+
+// Address range swept (same as the interactive scanner)
+#define PRESENCE_FIRST_ADDR 0x08
+#define PRESENCE_LAST_ADDR 0x7E
+
+// Consecutive sweeps without an ACK before a device counts as removed
+#define PRESENCE_MISS_LIMIT 2
+
+// Hot-plug events held until poll(); older ones are dropped on overflow
+#define PRESENCE_EVENT_DEPTH 16
+
+struct PresenceEvent {
+  uint8_t addr;   // Bus-qualified
+  bool present;  // true = appeared, false = removed
+};
+
+struct PresenceSnapshot {
+  bool enabled;
+  bool complete;            // At least one full sweep done
+  uint8_t bitmap[32];       // Bit (addr & 7) of byte (addr >> 3), bus-qualified addr
+  uint8_t count;            // Devices present on all buses
+  uint8_t addr;             // Next address to probe (bus-qualified)
+  uint32_t sweeps;          // Completed sweeps
+  uint32_t sweep_ms;        // Duration of the last completed sweep
+  uint32_t last_sweep_ms;   // millis() the last sweep completed
+  uint32_t events_dropped;  // Hot-plug events lost to overflow
+  I2cStatus fault;          // Latest bus fault (OK = none in this or the last sweep)
+  uint8_t fault_addr;
+};
+
+class PresenceScanner {
+ public:
+  static PresenceScanner& getInstance();
+
+  // Probe one address every intervalMs; 0 stops background scanning
+  void begin(uint32_t intervalMs);
+  bool isEnabled() const { return interval_ms_ != 0; }
+
+  // Loop task: fold in a finished probe and issue the next one when due
+  void service();
+
+  // Loop task: oldest pending hot-plug event; false when none
+  bool poll(PresenceEvent& event);
+
+  // Loop task (web handlers included)
+  void getSnapshot(PresenceSnapshot& out) const;
+
+ private:
+  PresenceScanner();
+  PresenceScanner(const PresenceScanner&) = delete;
+  PresenceScanner& operator=(const PresenceScanner&) = delete;
+
+  // Engine task: hand the probe result to service()
+  static void onProbeDone(const I2cTransaction& txn, void* ctx);
+
+  void record(uint8_t addr, I2cStatus status);
+  void endSweep();
+  void pushEvent(uint8_t addr, bool present);
+  static bool secondaryRunning();
+
+  static bool testBit(const uint8_t* map, uint8_t addr) {
+    return map[addr >> 3] & (1 << (addr & 7));
+  }
+
+  // Result of the probe in flight, published by onProbeDone()
+  std::atomic<uint8_t> done_status_;
+  std::atomic<bool> done_;
+
+  bool in_flight_;
+  uint32_t interval_ms_;
+  uint32_t last_probe_ms_;
+  uint8_t next_addr_;
+  uint8_t probe_addr_;
+  uint8_t present_[32];
+  uint8_t misses_[256];
+  uint32_t sweeps_;
+  uint32_t sweep_start_ms_;
+  uint32_t sweep_ms_;
+  uint32_t last_sweep_ms_;
+  I2cStatus fault_;
+  uint8_t fault_addr_;
+  I2cStatus sweep_fault_;
+  uint8_t sweep_fault_addr_;
+
+  PresenceEvent events_[PRESENCE_EVENT_DEPTH];
+  uint8_t event_head_;
+  uint8_t event_count_;
+  uint32_t events_dropped_;
+};
@@ -0,0 +1,192 @@
+/*
+ * Deep Scan Job - Implementation
+ */
+
+#include "scan_job.h"
+
+#include <SerialWombat.h>
+
+#include "i2c_engine.h"
+#include "i2c_manager.h"
+
+static TaskHandle_t s_task = nullptr;
+static SemaphoreHandle_t s_mutex = nullptr;
+static ScanJobStatus s_status = {};
+static uint32_t s_startMs = 0;
+static ScanDevice s_devices[SCAN_JOB_MAX_DEVICES];
+
+// ===================================================================================
+// Device Query
+// ===================================================================================
+static void copyText(char* dst, size_t size, const char* src, size_t srcLen) {
+  size_t n = srcLen < size - 1 ? srcLen : size - 1;
+  strncpy(dst, src, n);
+  dst[n] = '\0';
+}
+
+// Fill everything the deep scan reports about one responding address
+static void queryDevice(SerialWombat& chip, uint8_t addr, bool full, ScanDevice& dev) {
+  dev = ScanDevice();
+  dev.addr = addr;
+  dev.variant = "";
+
+  I2cBusGuard guard(i2cAddrBus(addr));
+  chip.begin(i2cWireFor(addr), i2cAddr7(addr), false);
+  if (!chip.queryVersion()) return;
+
+  dev.wombat = true;
+  dev.in_boot = chip.inBoot;
+  copyText(dev.model, sizeof(dev.model), (const char*)chip.model, sizeof(chip.model));
+  copyText(dev.fw, sizeof(dev.fw), (const char*)chip.fwVersion, sizeof(chip.fwVersion));
+  dev.uuid_len = chip.uniqueIdentifierLength < sizeof(dev.uuid) ? chip.uniqueIdentifierLength
+                                                                 : sizeof(dev.uuid);
+  memcpy(dev.uuid, chip.uniqueIdentifier, dev.uuid_len);
+
+  if (chip.isSW18() || chip.isSW08()) {
+    dev.caps_cached = scanCapabilities(chip, dev.caps, full);
+    dev.caps_valid = true;
+  }
+  dev.variant = variantFromCaps(dev.caps.supported);
+
+  taskYIELD();
+  dev.frames = chip.readFramesExecuted();
+  dev.overflows = chip.readOverflowFrames();
+  dev.birthday = chip.readBirthday();
+  chip.readBrand(dev.brand);
+  dev.brand[sizeof(dev.brand) - 1] = '\0';
+  dev.voltage_mv = chip.readSupplyVoltage_mV();
+  if (chip.isSW18()) {
+    dev.has_temp = true;
+    dev.temp_c100 = (int16_t)chip.readTemperature_100thsDegC();
+  }
+  dev.errors = chip.errorCount;
+}
+
+// ===================================================================================
+// Scan Task
+// ===================================================================================
+static void runScan() {
+  static SerialWombat chip;  // Too large for the task stack
+  const int span = SCAN_JOB_LAST_ADDR - SCAN_JOB_FIRST_ADDR + 1;
+  // The secondary bus is walked after the primary one when its engine runs
+  const int buses = I2cEngine::getInstance(I2C_BUS_SECONDARY_PORT).isRunning() ? I2C_BUS_COUNT : 1;
+  ScanJobState result = ScanJobState::DONE;
+
+  for (int step = 0; step < span * buses; step++) {
+    uint8_t addr = i2cAddrOnBus(step / span, SCAN_JOB_FIRST_ADDR + step % span);
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_status.addr = addr;
+    s_status.progress = (uint8_t)(step * 100 / (span * buses));
+    bool tableFull = s_status.devices >= SCAN_JOB_MAX_DEVICES;
+    bool enumerate = s_status.full;
+    xSemaphoreGive(s_mutex);
+    if (tableFull) break;
+
+    I2cStatus st = i2cEngineProbe(addr);
+    if (st != I2cStatus::OK && st != I2cStatus::NACK) {
+      // A faulty bus would otherwise read as "no devices"
+      xSemaphoreTake(s_mutex, portMAX_DELAY);
+      s_status.fault = st;
+      s_status.fault_addr = addr;
+      xSemaphoreGive(s_mutex);
+      result = ScanJobState::ABORTED;
+      break;
+    }
+
+    if (st == I2cStatus::OK) {
+      ScanDevice dev;
+      queryDevice(chip, addr, enumerate, dev);
+      xSemaphoreTake(s_mutex, portMAX_DELAY);
+      s_devices[s_status.devices++] = dev;
+      xSemaphoreGive(s_mutex);
+    }
+
+    // Let the bridge and web server have the bus between chips
+    vTaskDelay(1);
+  }
+
+  xSemaphoreTake(s_mutex, portMAX_DELAY);
+  if (result == ScanJobState::DONE) s_status.progress = 100;
+  s_status.elapsed_ms = millis() - s_startMs;
+  s_status.state = result;
+  xSemaphoreGive(s_mutex);
+}
+
+static void scanTask(void* arg) {
+  (void)arg;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    runScan();
+  }
+}
+
+// ===================================================================================
+// Public API
+// ===================================================================================
+bool scanJobStart(bool full) {
+  if (!s_mutex) {
+    s_mutex = xSemaphoreCreateMutex();
+    if (!s_mutex) return false;
+  }
+
+  xSemaphoreTake(s_mutex, portMAX_DELAY);
+  if (s_status.state == ScanJobState::RUNNING) {
+    xSemaphoreGive(s_mutex);
+    return false;
+  }
+  uint32_t job = s_status.job + 1;
+  s_status = {};
+  s_status.state = ScanJobState::RUNNING;
+  s_status.job = job;
+  s_status.full = full;
+  s_status.addr = SCAN_JOB_FIRST_ADDR;
+  s_startMs = millis();
+  xSemaphoreGive(s_mutex);
+
+  if (!s_task && xTaskCreatePinnedToCore(scanTask, "scan_job", SCAN_JOB_TASK_STACK, nullptr,
+                                         SCAN_JOB_TASK_PRIORITY, &s_task,
+                                         tskNO_AFFINITY) != pdPASS) {
+    s_task = nullptr;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_status.state = ScanJobState::IDLE;
+    xSemaphoreGive(s_mutex);
+    return false;
+  }
+  xTaskNotifyGive(s_task);
+  return true;
+}
+
+ScanJobStatus scanJobGetStatus() {
+  if (!s_mutex) return ScanJobStatus{};
+
+  xSemaphoreTake(s_mutex, portMAX_DELAY);
+  ScanJobStatus out = s_status;
+  if (out.state == ScanJobState::RUNNING) out.elapsed_ms = millis() - s_startMs;
+  xSemaphoreGive(s_mutex);
+  return out;
+}
+
+size_t scanJobGetDevices(ScanDevice* out, size_t max) {
+  if (!s_mutex) return 0;
+
+  xSemaphoreTake(s_mutex, portMAX_DELAY);
+  size_t n = s_status.devices < max ? s_status.devices : max;
+  memcpy(out, s_devices, n * sizeof(ScanDevice));
+  xSemaphoreGive(s_mutex);
+  return n;
+}
+
+const char* scanJobStateToStr(ScanJobState s) {
+  switch (s) {
+    case ScanJobState::IDLE:
+      return "idle";
+    case ScanJobState::RUNNING:
+      return "running";
+    case ScanJobState::DONE:
+      return "done";
+    case ScanJobState::ABORTED:
+      return "aborted";
+    default:
+      return "unknown";
+  }
+}
@@ -0,0 +1,86 @@
+/*
+ * Deep Scan Job - Header
+ *
+ * Runs the SerialWombat deep scan (address walk, version query, variant
+ * classification or full pin-mode enumeration, chip diagnostics) as a
+ * background job on its own low-priority
+ * task, yielding after every bus transaction, so the web server, bridge and
+ * UI keep running while it works. Results are collected into a fixed device
+ * table that the web API reads as it fills.
+ *
+ * Only one job runs at a time; starting a new one discards the previous
+ * results. Status and results may be read from any task.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "../../hal/i2c/i2c_bus.h"
+#include "variant_signatures.h"
+
+// Address range walked by a deep scan, on each running bus
+#define SCAN_JOB_FIRST_ADDR 0x0E
+#define SCAN_JOB_LAST_ADDR 0x77
+
+// Devices recorded per job
+#define SCAN_JOB_MAX_DEVICES 16
+
+// Scan task stack size (bytes) and priority (below loop and bridge)
+#define SCAN_JOB_TASK_STACK 6144
+#define SCAN_JOB_TASK_PRIORITY 1
+
+enum class ScanJobState : uint8_t {
+  IDLE = 0,  // No job since boot
+  RUNNING,
+  DONE,
+  ABORTED  // Stopped at a bus fault; results up to the fault are kept
+};
+
+// One device found by the scan
+struct ScanDevice {
+  uint8_t addr;  // Bus-qualified (i2c_bus.h)
+  bool wombat;   // Answered queryVersion(); the fields below are valid
+  bool in_boot;  // In the bootloader
+  char model[8];
+  char fw[8];
+  char brand[32];
+  uint8_t uuid[16];
+  uint8_t uuid_len;
+  const char* variant;  // Static string
+  bool caps_valid;      // SW18/SW08 only
+  bool caps_cached;     // From the fingerprint cache
+  PinModeCaps caps;
+  uint16_t voltage_mv;
+  bool has_temp;  // SW18 only
+  int16_t temp_c100;
+  uint32_t frames;
+  uint32_t overflows;
+  uint32_t errors;
+  uint32_t birthday;
+};
+
+struct ScanJobStatus {
+  ScanJobState state;
+  uint32_t job;         // Increments with every start
+  bool full;            // Enumerating every pin mode, not just classifying
+  uint8_t addr;         // Bus-qualified address being scanned (RUNNING) or last scanned
+  uint8_t progress;     // Percent of the address range done
+  uint8_t devices;      // Devices recorded so far
+  uint32_t elapsed_ms;  // Since start (until finished)
+  I2cStatus fault;      // Bus fault that aborted the job
+  uint8_t fault_addr;
+};
+
+// Start a deep scan in the background; full enumerates every pin mode of
+// each chip. Returns false when one is already running or the scan task
+// could not be created.
+bool scanJobStart(bool full);
+
+// Snapshot of the current or last job
+ScanJobStatus scanJobGetStatus();
+
+// Copy the recorded devices (at most max); returns the number copied
+size_t scanJobGetDevices(ScanDevice* out, size_t max);
+
+const char* scanJobStateToStr(ScanJobState s);
@@ -0,0 +1,106 @@
+/*
+ * SerialWombat Variant Signatures - Header
+ *
+ * Firmware variants are told apart by which pin modes they support. Each
+ * variant is a signature: pin modes that must be supported and pin modes
+ * that must not be. Signatures are tried in order and the first match wins
+ * (the v06 Deep Scan decisions), so a variant is only known once every
+ * earlier signature has been ruled out.
+ *
+ * Probing a pin mode costs one packet. Instead of probing all 41 modes,
+ * variantNextProbe() walks the table as a decision tree and names the one
+ * mode whose answer is needed next; classification ends after 1 to 8 probes
+ * (the eight modes the table names). Full enumeration (all 41 modes) is still
+ * done when the caller needs the complete capability set, e.g. the
+ * configurator.
+ *
+ * Everything here is constexpr and free of Arduino dependencies.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Pin modes a SerialWombat 18/08 can be asked about (pinModeStrings)
+#define SW_PIN_MODE_COUNT 41
+#define SW_PIN_MODE_ALL ((1ULL << SW_PIN_MODE_COUNT) - 1)
+
+constexpr uint64_t pinModeBit(int pm) {
+  return 1ULL << pm;
+}
+
+// Capability bitsets of one chip; bit n stands for pin mode n
+struct PinModeCaps {
+  uint64_t supported = 0;  // Modes that answered as supported
+  uint64_t probed = 0;     // Modes asked so far (supported or not)
+
+  constexpr bool has(int pm) const { return supported & pinModeBit(pm); }
+  constexpr bool complete() const { return (probed & SW_PIN_MODE_ALL) == SW_PIN_MODE_ALL; }
+};
+
+struct VariantSignature {
+  const char* name;
+  uint64_t required;  // Every one of these is supported
+  uint64_t excluded;  // None of these is supported
+};
+
+// Tried in order; the first match names the variant
+constexpr VariantSignature kVariantSignatures[] = {
+    {"Keypad Firmware", pinModeBit(15), 0},
+    {"Ultrasonic Firmware", pinModeBit(27), 0},
+    {"Communications Firmware", pinModeBit(17), 0},
+    {"TM1637 Display Firmware", pinModeBit(11), 0},
+    {"Front Panel Firmware", pinModeBit(25) | pinModeBit(36), pinModeBit(6)},
+    {"Motor Control / Default", pinModeBit(6) | pinModeBit(3), 0},
+    {"Brushed Motor Firmware", pinModeBit(6), pinModeBit(3)},
+};
+constexpr size_t kVariantSignatureCount =
+    sizeof(kVariantSignatures) / sizeof(kVariantSignatures[0]);
+
+// Name when no signature matches
+#define SW_VARIANT_CUSTOM "Custom_FW"
+
+// Pin modes any signature looks at: the most a classification probes
+constexpr uint64_t variantProbeMask() {
+  uint64_t mask = 0;
+  for (size_t i = 0; i < kVariantSignatureCount; i++)
+    mask |= kVariantSignatures[i].required | kVariantSignatures[i].excluded;
+  return mask;
+}
+static_assert((variantProbeMask() & ~SW_PIN_MODE_ALL) == 0, "signature names an unknown pin mode");
+
+constexpr bool variantMatches(const VariantSignature& sig, uint64_t supported) {
+  return (supported & sig.required) == sig.required && (supported & sig.excluded) == 0;
+}
+
+// Variant named by a capability set. Also valid for a set filled in by
+// variantNextProbe() until it returned -1: modes left unprobed read as
+// unsupported, which cannot change the first match.
+constexpr const char* variantFromCaps(uint64_t supported) {
+  for (size_t i = 0; i < kVariantSignatureCount; i++) {
+    if (variantMatches(kVariantSignatures[i], supported)) return kVariantSignatures[i].name;
+  }
+  return SW_VARIANT_CUSTOM;
+}
+
+// Next pin mode to probe to classify caps, or -1 once the variant is known.
+// A signature is decided when a probed mode contradicts it (ruled out, move
+// on) or all of its modes are probed (it matches); otherwise its lowest
+// unprobed required mode, then excluded mode, is asked for.
+constexpr int variantNextProbe(const PinModeCaps& caps) {
+  for (size_t i = 0; i < kVariantSignatureCount; i++) {
+    const VariantSignature& sig = kVariantSignatures[i];
+    uint64_t missing = sig.required & caps.probed & ~caps.supported;
+    uint64_t present = sig.excluded & caps.probed & caps.supported;
+    if (missing || present) continue;
+
+    uint64_t open = sig.required & ~caps.probed;
+    if (!open) open = sig.excluded & ~caps.probed;
+    if (!open) return -1;
+    for (int pm = 0; pm < SW_PIN_MODE_COUNT; pm++) {
+      if (open & pinModeBit(pm)) return pm;
+    }
+  }
+  return -1;
+}
@@ -1,8 +1,10 @@
 #include "serialwombat_manager.h"
 
+#include "../i2c_manager/i2c_engine.h"
 #include "../i2c_manager/i2c_manager.h"
 #include "../security/auth_service.h"
 #include "../security/validators.h"
+#include "../tcp_bridge/bridge_cache.h"
 
 // ===================================================================================
 // Global SerialWombat State
@@ -10,15 +12,42 @@
 SerialWombat sw;
 uint8_t currentWombatAddress = 0x6C;  // Default I2C address
 
+void swAttachCurrent(bool reset) {
+  I2cBusGuard guard(i2cAddrBus(currentWombatAddress));
+  sw.begin(i2cWireFor(currentWombatAddress), i2cAddr7(currentWombatAddress), reset);
+}
+
+// ===================================================================================
+// RAW PACKET ACCESS (via I2C engine)
+// ===================================================================================
+// Raw packets can change pin state behind the bridge's read cache
+I2cStatus swExchangePacket(uint8_t addr, const uint8_t* tx, uint8_t* rx) {
+  BridgeReadCache::getInstance().requestFlush();
+  return i2cEngineWriteRead(addr, tx, 8, rx, 8);
+}
+
+I2cStatus swWritePacket(uint8_t addr, const uint8_t* tx) {
+  BridgeReadCache::getInstance().requestFlush();
+  return i2cEngineWriteRead(addr, tx, 8, nullptr, 0);
+}
+
 // ===================================================================================
 // CONFIGURATOR APPLY LOGIC (JSON -> Wombat)
 // ===================================================================================
 void applyConfiguration(DynamicJsonDocument& doc) {
   // Safety: reset and re-begin before applying.
-  sw.begin(Wire, currentWombatAddress, false);
-  sw.hardwareReset();
+  BridgeReadCache::getInstance().requestFlush();
+  const uint8_t bus = i2cAddrBus(currentWombatAddress);
+  {
+    I2cBusGuard guard(bus);
+    swAttachCurrent(false);
+    sw.hardwareReset();
+  }
   delay(600);
-  sw.begin(Wire, currentWombatAddress, false);
+
+  // Everything below talks to the chip through the library
+  I2cBusGuard guard(bus);
+  swAttachCurrent(false);
 
   JsonArray devices = doc["device_mode"].as<JsonArray>();
   for (JsonObject dev : devices) {
@@ -98,8 +127,15 @@ void handleConnect(WebServer& server) {
       return;
     }
 
-    currentWombatAddress = addr;
-    sw.begin(Wire, currentWombatAddress);
+    // Optional bus=1 selects the secondary bus, when it is configured
+    uint8_t bus = server.arg("bus") == "1" ? I2C_BUS_SECONDARY_PORT : I2C_BUS_PRIMARY_PORT;
+    if (bus == I2C_BUS_SECONDARY_PORT && !I2cEngine::getInstance(bus).isRunning()) {
+      server.send(400, "text/plain", "Secondary I2C bus is not configured");
+      return;
+    }
+
+    currentWombatAddress = i2cAddrOnBus(bus, addr);
+    swAttachCurrent();
   }
   server.sendHeader("Location", "/");
   server.send(303);
@@ -127,7 +163,12 @@ void handleSetPin(WebServer& server) {
     }
 
     uint8_t tx[8] = {200, (uint8_t)pin, (uint8_t)mode, 0, 0, 0, 0, 0};
-    sw.sendPacket(tx);
+    uint8_t rx[8];
+    I2cStatus st = swExchangePacket(currentWombatAddress, tx, rx);
+    if (st != I2cStatus::OK) {
+      server.send(500, "text/plain", String("I2C error: ") + i2cStatusToStr(st));
+      return;
+    }
   }
   server.sendHeader("Location", "/");
   server.send(303);
@@ -148,32 +189,29 @@ void handleChangeAddr(WebServer& server) {
     }
 
     // 1) Library method (known good on SW8B)
-    sw.setThroughputPin((uint32_t)newAddr);
+    {
+      I2cBusGuard guard(i2cAddrBus(currentWombatAddress));
+      sw.setThroughputPin((uint32_t)newAddr);
+    }
     delay(200);
 
     // 2) Fallback raw packet
-    Wire.beginTransmission(currentWombatAddress);
-    Wire.write(0xAF);
-    Wire.write(0x5F);
-    Wire.write(0x42);
-    Wire.write(0xAF);
-    Wire.write(newAddr);
-    Wire.write(0x55);
-    Wire.write(0x55);
-    Wire.write(0x55);
-    Wire.endTransmission();
-    i2cMarkTx();
+    uint8_t tx[8] = {0xAF, 0x5F, 0x42, 0xAF, newAddr, 0x55, 0x55, 0x55};
+    swWritePacket(currentWombatAddress, tx);
 
     delay(200);
 
     // 3) Reset to latch
-    sw.begin(Wire, currentWombatAddress);
-    sw.hardwareReset();
+    {
+      I2cBusGuard guard(i2cAddrBus(currentWombatAddress));
+      swAttachCurrent();
+      sw.hardwareReset();
+    }
     delay(1500);
 
-    // 4) Switch to new address
-    currentWombatAddress = newAddr;
-    sw.begin(Wire, currentWombatAddress);
+    // 4) Switch to new address (same bus)
+    currentWombatAddress = i2cAddrOnBus(i2cAddrBus(currentWombatAddress), newAddr);
+    swAttachCurrent();
   }
   server.sendHeader("Location", "/");
   server.send(303);
@@ -184,7 +222,11 @@ void handleResetTarget(WebServer& server) {
   if (!checkAuth(server)) return;
   addSecurityHeaders(server);
 
-  sw.hardwareReset();
+  {
+    I2cBusGuard guard(i2cAddrBus(currentWombatAddress));
+    sw.hardwareReset();
+  }
+  BridgeReadCache::getInstance().requestFlush();
   server.sendHeader("Location", "/");
   server.send(303);
 }
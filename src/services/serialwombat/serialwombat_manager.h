@@ -8,9 +8,31 @@
 #include <WebServer.h>
 #include <Wire.h>
 
+#include "../../hal/i2c/i2c_bus.h"
+
 // Forward declarations
 extern SerialWombat sw;
-extern uint8_t currentWombatAddress;
+extern uint8_t currentWombatAddress;  // Bus-qualified (i2c_bus.h)
+
+/**
+ * Bind the global sw handle to currentWombatAddress on its bus (Wire or
+ * Wire1); reset as in SerialWombat::begin().
+ */
+void swAttachCurrent(bool reset = true);
+
+/**
+ * Exchange one raw 8-byte SerialWombat packet through the I2C engine
+ * (write, repeated START, read). rx is only valid when the status is OK; a
+ * truncated response is reported as SHORT_READ, and bytes that were not read
+ * are left untouched.
+ */
+I2cStatus swExchangePacket(uint8_t addr, const uint8_t* tx, uint8_t* rx);
+
+/**
+ * Write one raw 8-byte SerialWombat packet through the I2C engine without
+ * reading a response.
+ */
+I2cStatus swWritePacket(uint8_t addr, const uint8_t* tx);
 
 /**
  * Apply a JSON configuration to the SerialWombat device.
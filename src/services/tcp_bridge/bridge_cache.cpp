@@ -0,0 +1,153 @@
+/*
+ * Bridge Read Cache - Implementation
+ */
+
+#include "bridge_cache.h"
+
+#include <Arduino.h>
+
+// SerialWombat commands referenced by the cache rules
+#define SW_CMD_READ_PUBLIC_DATA 0x81   // [0x81, pin, ...] -> pin's 16-bit public data
+#define SW_CMD_WRITE_PUBLIC_DATA 0x82  // [0x82, pin, lo, hi, ...]
+#define SW_CMD_VERSION 'V'             // Firmware version string
+#define SW_CMD_PIN_CONFIG_FIRST 200    // [200+n, pin, ...] pin mode configuration
+
+// Version never changes while the chip is up; a long window is safe
+#define BRIDGE_CACHE_VERSION_TTL_MS 1000
+
+// ===================================================================================
+// Singleton Implementation
+// ===================================================================================
+BridgeReadCache& BridgeReadCache::getInstance() {
+  static BridgeReadCache instance;
+  return instance;
+}
+
+BridgeReadCache::BridgeReadCache()
+    : window_us_(0),
+      invalidated_seq_(0),
+      last_dispatch_seq_(0),
+      any_invalidated_(false),
+      stats_{},
+      flush_requests_(0),
+      flushes_applied_(0) {
+  memset(entries_, 0, sizeof(entries_));
+}
+
+void BridgeReadCache::configure(uint32_t windowMs) {
+  window_us_ = windowMs * 1000UL;
+  memset(entries_, 0, sizeof(entries_));
+}
+
+// ===================================================================================
+// Whitelist
+// ===================================================================================
+// Staleness window for a command, 0 when the command must not be cached
+uint32_t BridgeReadCache::ttlFor(uint8_t cmd) const {
+  switch (cmd) {
+    case SW_CMD_READ_PUBLIC_DATA:
+      return window_us_;
+    case SW_CMD_VERSION:
+      return BRIDGE_CACHE_VERSION_TTL_MS * 1000UL;
+    default:
+      return 0;
+  }
+}
+
+// ===================================================================================
+// Lookup and Store
+// ===================================================================================
+bool BridgeReadCache::lookup(uint8_t addr, const uint8_t* tx, uint8_t* rx) {
+  if (!enabled() || ttlFor(tx[0]) == 0) return false;
+  applyPendingFlush();
+
+  uint32_t now = micros();
+  for (auto& e : entries_) {
+    if (!e.valid || e.addr != addr || memcmp(e.tx, tx, 8) != 0) continue;
+    if (now - e.stored_us > e.ttl_us) {
+      e.valid = false;
+      break;
+    }
+    memcpy(rx, e.rx, 8);
+    stats_.hits++;
+    return true;
+  }
+  stats_.misses++;
+  return false;
+}
+
+void BridgeReadCache::store(uint8_t addr, const uint8_t* tx, const uint8_t* rx, uint32_t seq,
+                            uint32_t doneUs) {
+  if (!enabled()) return;
+  uint32_t ttl = ttlFor(tx[0]);
+  if (ttl == 0) return;
+  applyPendingFlush();
+
+  // Read raced with a write dispatched after it; its value may be pre-write
+  if (any_invalidated_ && (int32_t)(seq - invalidated_seq_) <= 0) return;
+
+  // Error responses are not data
+  if (rx[0] == 'E') return;
+
+  // Reuse the matching slot, else a free one, else the oldest
+  Entry* slot = nullptr;
+  for (auto& e : entries_) {
+    if (e.valid && e.addr == addr && memcmp(e.tx, tx, 8) == 0) {
+      slot = &e;
+      break;
+    }
+    if (!slot || (slot->valid && (!e.valid || (int32_t)(e.stored_us - slot->stored_us) < 0))) {
+      slot = &e;
+    }
+  }
+
+  slot->valid = true;
+  slot->addr = addr;
+  memcpy(slot->tx, tx, 8);
+  memcpy(slot->rx, rx, 8);
+  slot->stored_us = doneUs;
+  slot->ttl_us = ttl;
+  stats_.stores++;
+}
+
+// ===================================================================================
+// Invalidation
+// ===================================================================================
+void BridgeReadCache::onDispatch(uint8_t addr, const uint8_t* tx, size_t txLen, uint32_t seq) {
+  last_dispatch_seq_ = seq;
+  if (!enabled()) return;
+  if (txLen != 8) {
+    invalidate(addr, -1, seq);
+    return;
+  }
+  if (ttlFor(tx[0]) != 0) return;
+
+  uint8_t cmd = tx[0];
+  if (cmd == SW_CMD_WRITE_PUBLIC_DATA || cmd >= SW_CMD_PIN_CONFIG_FIRST) {
+    invalidate(addr, tx[1], seq);
+  } else {
+    invalidate(addr, -1, seq);
+  }
+}
+
+// pin < 0 drops every entry for the address
+void BridgeReadCache::invalidate(uint8_t addr, int pin, uint32_t seq) {
+  for (auto& e : entries_) {
+    if (!e.valid || e.addr != addr) continue;
+    if (pin < 0 || (e.tx[0] != SW_CMD_VERSION && e.tx[1] == pin)) e.valid = false;
+  }
+  invalidated_seq_ = seq;
+  any_invalidated_ = true;
+  stats_.invalidations++;
+}
+
+void BridgeReadCache::applyPendingFlush() {
+  uint32_t requested = flush_requests_.load(std::memory_order_acquire);
+  if (requested == flushes_applied_) return;
+  flushes_applied_ = requested;
+  for (auto& e : entries_) e.valid = false;
+  // The outside write may land behind reads already on the bus
+  invalidated_seq_ = last_dispatch_seq_;
+  any_invalidated_ = true;
+  stats_.flushes++;
+}
@@ -0,0 +1,94 @@
+/*
+ * Bridge Read Cache - Header
+ *
+ * Short-lived response cache for idempotent SerialWombat reads issued through
+ * the bridge. Entries are keyed by target address plus the full 8-byte
+ * request, so only byte-identical polls share a response. Only commands in a
+ * fixed whitelist are cached, each with its own staleness window.
+ *
+ * Invalidation:
+ * - Pin-scoped writes (public data writes, pin mode configuration) drop the
+ *   entries for that pin on that address.
+ * - Any other non-cacheable command drops every entry for that address.
+ * - Writes made outside the bridge (web UI) call requestFlush().
+ *
+ * Reads already on the bus when an invalidation happens do not repopulate the
+ * cache: the engine passes the completion's dispatch sequence number to
+ * store(), which is ignored when older than the last invalidation.
+ *
+ * Owned by the bridge I/O task; only requestFlush() and getStats() may be
+ * called from other tasks.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+// Number of cached responses (linear lookup, keep small)
+#define BRIDGE_CACHE_ENTRIES 16
+
+struct BridgeCacheStats {
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t stores;
+  uint32_t invalidations;
+  uint32_t flushes;
+};
+
+class BridgeReadCache {
+ public:
+  static BridgeReadCache& getInstance();
+
+  // Set the public-data read window; 0 disables the cache
+  void configure(uint32_t windowMs);
+  bool enabled() const { return window_us_ > 0; }
+
+  // Copy a fresh cached response for this request into rx. Counts a hit or,
+  // for whitelisted commands, a miss.
+  bool lookup(uint8_t addr, const uint8_t* tx, uint8_t* rx);
+
+  // Called for every frame sent to the bus, before it executes: applies the
+  // invalidation rules above. seq is the frame's dispatch sequence number.
+  // Transfers that are not 8-byte packets drop every entry for the address.
+  void onDispatch(uint8_t addr, const uint8_t* tx, size_t txLen, uint32_t seq);
+
+  // Remember a completed response. seq is the dispatch sequence number of the
+  // completion; doneUs is micros() when the bus transfer finished.
+  void store(uint8_t addr, const uint8_t* tx, const uint8_t* rx, uint32_t seq, uint32_t doneUs);
+
+  // Drop everything (safe from any task; applied on the next lookup/store)
+  void requestFlush() { flush_requests_.fetch_add(1, std::memory_order_release); }
+
+  BridgeCacheStats getStats() const { return stats_; }
+
+ private:
+  BridgeReadCache();
+  BridgeReadCache(const BridgeReadCache&) = delete;
+  BridgeReadCache& operator=(const BridgeReadCache&) = delete;
+
+  struct Entry {
+    bool valid;
+    uint8_t addr;
+    uint8_t tx[8];
+    uint8_t rx[8];
+    uint32_t stored_us;
+    uint32_t ttl_us;
+  };
+
+  uint32_t ttlFor(uint8_t cmd) const;
+  void invalidate(uint8_t addr, int pin, uint32_t seq);
+  void applyPendingFlush();
+
+  Entry entries_[BRIDGE_CACHE_ENTRIES];
+  uint32_t window_us_;
+  uint32_t invalidated_seq_;  // Completions dispatched at or before this are stale
+  uint32_t last_dispatch_seq_;
+  bool any_invalidated_;
+  BridgeCacheStats stats_;
+
+  std::atomic<uint32_t> flush_requests_;
+  uint32_t flushes_applied_;
+};
@@ -0,0 +1,58 @@
+/*
+ * Bridge Capture - Implementation
+ */
+
+#include "bridge_capture.h"
+
+#include <Arduino.h>
+
+BridgeCapture& BridgeCapture::getInstance() {
+  static BridgeCapture instance;
+  return instance;
+}
+
+void BridgeCapture::enable() {
+  start_us_ = micros();
+  dropped_ = 0;
+  active_.store(true, std::memory_order_release);
+}
+
+void BridgeCapture::push(const BridgeCaptureRecord& rec) {
+  if (!queue_.push(rec)) dropped_++;
+}
+
+void BridgeCapture::logRequest(uint32_t session, uint8_t addr, uint8_t flags, const uint8_t* tx,
+                               uint8_t txLen, uint8_t rxLen, uint32_t rxUs) {
+  if (!active()) return;
+
+  BridgeCaptureRecord rec;
+  rec.hdr.t_us = rxUs - start_us_;
+  rec.hdr.type = BRIDGE_CAPTURE_REQUEST;
+  rec.hdr.session = (uint8_t)session;
+  rec.hdr.addr = addr;
+  rec.hdr.status = 0;
+  rec.hdr.flags = flags;
+  rec.hdr.aux = rxLen;
+  rec.hdr.len = txLen;
+  memcpy(rec.payload, tx, txLen);
+  push(rec);
+}
+
+void BridgeCapture::logResponse(uint32_t session, uint8_t addr, uint8_t flags, uint8_t status,
+                                const uint8_t* rx, uint8_t rxLen, uint32_t startUs,
+                                uint32_t doneUs) {
+  if (!active()) return;
+
+  uint32_t bus_us = doneUs - startUs;
+  BridgeCaptureRecord rec;
+  rec.hdr.t_us = doneUs - start_us_;
+  rec.hdr.type = BRIDGE_CAPTURE_RESPONSE;
+  rec.hdr.session = (uint8_t)session;
+  rec.hdr.addr = addr;
+  rec.hdr.status = status;
+  rec.hdr.flags = flags;
+  rec.hdr.aux = bus_us > 0xFFFF ? 0xFFFF : (uint16_t)bus_us;
+  rec.hdr.len = rxLen;
+  memcpy(rec.payload, rx, rxLen);
+  push(rec);
+}
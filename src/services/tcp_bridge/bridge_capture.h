@@ -0,0 +1,61 @@
+/*
+ * Bridge Capture - Header
+ *
+ * Lock-free hand-off of bridge traffic records from the bridge I/O task to
+ * the capture writer (bridge_capture_writer.h). The engine calls
+ * logRequest()/logResponse() for every client frame; both return immediately
+ * when capture is off. When the writer falls behind, records are dropped and
+ * counted rather than stalling the bridge.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "../../core/spsc_queue.h"
+#include "bridge_capture_format.h"
+
+// Records buffered between the I/O task and the writer (power of two)
+#define BRIDGE_CAPTURE_QUEUE_DEPTH 128
+
+// One queued record (payload trimmed to len when written)
+struct BridgeCaptureRecord {
+  BridgeCaptureRecordHeader hdr;
+  uint8_t payload[BRIDGE_CAPTURE_MAX_PAYLOAD];
+};
+
+class BridgeCapture {
+ public:
+  static BridgeCapture& getInstance();
+
+  // Writer side: enable/disable recording (timestamps restart at 0)
+  void enable();
+  void disable() { active_.store(false, std::memory_order_release); }
+  bool active() const { return active_.load(std::memory_order_relaxed); }
+
+  // I/O task: record a client frame and its response
+  void logRequest(uint32_t session, uint8_t addr, uint8_t flags, const uint8_t* tx,
+                  uint8_t txLen, uint8_t rxLen, uint32_t rxUs);
+  void logResponse(uint32_t session, uint8_t addr, uint8_t flags, uint8_t status,
+                   const uint8_t* rx, uint8_t rxLen, uint32_t startUs, uint32_t doneUs);
+
+  // Writer side: take the next record
+  bool pop(BridgeCaptureRecord& out) { return queue_.pop(out); }
+
+  uint32_t getDropped() const { return dropped_; }
+
+ private:
+  BridgeCapture() : active_(false), start_us_(0), dropped_(0) {}
+  BridgeCapture(const BridgeCapture&) = delete;
+  BridgeCapture& operator=(const BridgeCapture&) = delete;
+
+  void push(const BridgeCaptureRecord& rec);
+
+  SpscQueue<BridgeCaptureRecord, BRIDGE_CAPTURE_QUEUE_DEPTH> queue_;
+  std::atomic<bool> active_;
+  volatile uint32_t start_us_;
+  volatile uint32_t dropped_;
+};
@@ -0,0 +1,58 @@
+/*
+ * Bridge Capture Format
+ *
+ * On-disk layout of bridge traffic captures. Shared by the firmware writer
+ * and the host-side replay tool (tools/bridge_replay), so it has no Arduino
+ * dependencies. All fields are little-endian.
+ *
+ * File:   BridgeCaptureFileHeader, then records back to back
+ * Record: BridgeCaptureRecordHeader, then len payload bytes
+ *
+ * Request records (client -> bridge) carry the frame as sent to the bus and
+ * the expected response length in aux. Response records (bridge -> client)
+ * carry the bytes read, the I2C status and the bus time in microseconds in
+ * aux (saturated at 65535). Timestamps are micros() relative to capture start
+ * and wrap after ~71 minutes.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define BRIDGE_CAPTURE_MAGIC "WBCP"
+#define BRIDGE_CAPTURE_VERSION 1
+#define BRIDGE_CAPTURE_MAX_PAYLOAD 32
+
+// Record types
+#define BRIDGE_CAPTURE_REQUEST 0
+#define BRIDGE_CAPTURE_RESPONSE 1
+
+// Record flags
+#define BRIDGE_CAPTURE_FLAG_V2 0x01       // Protocol v2 frame
+#define BRIDGE_CAPTURE_FLAG_CONTROL 0x02  // Answered by the bridge, not the bus
+#define BRIDGE_CAPTURE_FLAG_CACHED 0x04   // Answered from the read cache
+#define BRIDGE_CAPTURE_FLAG_MACRO 0x08    // Macro step; the client sent only MACRO_RUN
+
+#pragma pack(push, 1)
+struct BridgeCaptureFileHeader {
+  char magic[4];        // BRIDGE_CAPTURE_MAGIC
+  uint8_t version;      // BRIDGE_CAPTURE_VERSION
+  uint8_t header_size;  // sizeof(BridgeCaptureRecordHeader)
+  uint16_t reserved;
+  uint32_t i2c_clock;  // Bus clock at capture time (Hz)
+};
+
+struct BridgeCaptureRecordHeader {
+  uint32_t t_us;     // Request: received from transport; response: bus done
+  uint8_t type;      // BRIDGE_CAPTURE_REQUEST / BRIDGE_CAPTURE_RESPONSE
+  uint8_t session;   // Low byte of the bridge session id
+  uint8_t addr;      // I2C target
+  uint8_t status;    // Response: I2cStatus; request: 0
+  uint8_t flags;     // BRIDGE_CAPTURE_FLAG_*
+  uint16_t aux;      // Request: rx_len; response: bus time (us)
+  uint8_t len;       // Payload bytes that follow
+};
+#pragma pack(pop)
+
+static_assert(sizeof(BridgeCaptureFileHeader) == 12, "capture file header layout");
+static_assert(sizeof(BridgeCaptureRecordHeader) == 12, "capture record header layout");
@@ -0,0 +1,156 @@
+/*
+ * Bridge Capture Writer - Implementation
+ */
+
+#include "bridge_capture_writer.h"
+
+#include <LittleFS.h>
+#include <Wire.h>
+
+#include "../../config/defaults.h"
+#include "../../hal/storage/sd_storage.h"
+#include "bridge_capture.h"
+
+static bool s_open = false;
+static BridgeCaptureTarget s_target = BridgeCaptureTarget::LITTLEFS;
+static File s_lfsFile;
+#if SD_SUPPORT_ENABLED
+static SDFile s_sdFile;
+#endif
+static String s_path;
+static uint32_t s_records = 0;
+static uint32_t s_bytes = 0;
+static uint32_t s_maxBytes = 0;
+
+// ===================================================================================
+// File Access
+// ===================================================================================
+static size_t writeBytes(const void* data, size_t len) {
+#if SD_SUPPORT_ENABLED
+  if (s_target == BridgeCaptureTarget::SD) return s_sdFile.write((const uint8_t*)data, len);
+#endif
+  return s_lfsFile.write((const uint8_t*)data, len);
+}
+
+static void closeFile() {
+#if SD_SUPPORT_ENABLED
+  if (s_target == BridgeCaptureTarget::SD) {
+    s_sdFile.close();
+    s_open = false;
+    return;
+  }
+#endif
+  s_lfsFile.close();
+  s_open = false;
+}
+
+static bool openFile(BridgeCaptureTarget target, const String& path, String& err) {
+  if (target == BridgeCaptureTarget::SD) {
+#if SD_SUPPORT_ENABLED
+    if (!sdEnsureMounted()) {
+      err = "SD card not mounted";
+      return false;
+    }
+    if (!sdExists(BRIDGE_CAPTURE_DIR)) sdMkdir(BRIDGE_CAPTURE_DIR);
+    s_sdFile = sdOpen(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC);
+    if (!s_sdFile) {
+      err = "Cannot create " + path;
+      return false;
+    }
+    return true;
+#else
+    err = "SD support disabled";
+    return false;
+#endif
+  }
+
+  if (!LittleFS.exists(BRIDGE_CAPTURE_DIR)) LittleFS.mkdir(BRIDGE_CAPTURE_DIR);
+  s_lfsFile = LittleFS.open(path, "w");
+  if (!s_lfsFile) {
+    err = "Cannot create " + path;
+    return false;
+  }
+  return true;
+}
+
+// ===================================================================================
+// Public API
+// ===================================================================================
+bool bridgeCaptureStart(BridgeCaptureTarget target, uint32_t maxBytes, String& err) {
+  if (s_open) bridgeCaptureStop();
+
+  // Discard records left over from an earlier capture
+  BridgeCaptureRecord rec;
+  while (BridgeCapture::getInstance().pop(rec)) {
+  }
+
+  String path = String(BRIDGE_CAPTURE_DIR) + "/bridge-" + String(millis()) + ".wbc";
+  if (!openFile(target, path, err)) return false;
+
+  s_open = true;
+  s_target = target;
+  s_path = path;
+  s_records = 0;
+  s_maxBytes = maxBytes;
+
+  BridgeCaptureFileHeader hdr;
+  memcpy(hdr.magic, BRIDGE_CAPTURE_MAGIC, sizeof(hdr.magic));
+  hdr.version = BRIDGE_CAPTURE_VERSION;
+  hdr.header_size = sizeof(BridgeCaptureRecordHeader);
+  hdr.reserved = 0;
+  hdr.i2c_clock = Wire.getClock();
+  s_bytes = writeBytes(&hdr, sizeof(hdr));
+
+  BridgeCapture::getInstance().enable();
+  return true;
+}
+
+void bridgeCaptureStop() {
+  if (!s_open) return;
+  BridgeCapture::getInstance().disable();
+
+  // The I/O task may still be finishing a push; whatever is queued now is kept
+  BridgeCaptureRecord rec;
+  while (BridgeCapture::getInstance().pop(rec)) {
+    size_t len = sizeof(rec.hdr) + rec.hdr.len;
+    if (s_bytes + len > s_maxBytes) break;
+    s_bytes += writeBytes(&rec, len);
+    s_records++;
+  }
+  closeFile();
+}
+
+void bridgeCaptureService() {
+  if (!s_open) return;
+
+  BridgeCapture& capture = BridgeCapture::getInstance();
+  for (int i = 0; i < BRIDGE_CAPTURE_SERVICE_BATCH; i++) {
+    BridgeCaptureRecord rec;
+    if (!capture.pop(rec)) return;
+
+    size_t len = sizeof(rec.hdr) + rec.hdr.len;
+    if (s_bytes + len > s_maxBytes) {
+      bridgeCaptureStop();
+      return;
+    }
+    // Header and payload are contiguous in the record
+    s_bytes += writeBytes(&rec, len);
+    s_records++;
+  }
+}
+
+BridgeCaptureStatus bridgeCaptureGetStatus() {
+  BridgeCaptureStatus st;
+  st.active = s_open;
+  st.target = s_target;
+  st.path = s_path;
+  st.records = s_records;
+  st.bytes = s_bytes;
+  st.max_bytes = s_maxBytes;
+  st.dropped = BridgeCapture::getInstance().getDropped();
+  return st;
+}
+
+const char* bridgeCaptureTargetToStr(BridgeCaptureTarget t) {
+  return t == BridgeCaptureTarget::SD ? "sd" : "littlefs";
+}
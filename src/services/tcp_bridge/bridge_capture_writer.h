@@ -0,0 +1,47 @@
+/*
+ * Bridge Capture Writer - Header
+ *
+ * Drains BridgeCapture records into a binary capture file
+ * (bridge_capture_format.h) on LittleFS or the SD card. File I/O happens only
+ * in bridgeCaptureService(), called from the main loop, so flash and SD
+ * latency never reach the bridge task.
+ *
+ * Files are written to /captures/bridge-<millis>.wbc. Capture stops by itself
+ * once maxBytes have been written.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+// Capture storage
+enum class BridgeCaptureTarget : uint8_t { LITTLEFS = 0, SD };
+
+// Directory for capture files on either filesystem
+#define BRIDGE_CAPTURE_DIR "/captures"
+
+// Records written per service call (bounds time spent in the loop)
+#define BRIDGE_CAPTURE_SERVICE_BATCH 32
+
+struct BridgeCaptureStatus {
+  bool active;
+  BridgeCaptureTarget target;
+  String path;  // Current or last capture file
+  uint32_t records;
+  uint32_t bytes;
+  uint32_t max_bytes;
+  uint32_t dropped;  // Records lost because the writer fell behind
+};
+
+// Open a new capture file and start recording. err is set on failure.
+bool bridgeCaptureStart(BridgeCaptureTarget target, uint32_t maxBytes, String& err);
+
+// Stop recording, write out buffered records and close the file
+void bridgeCaptureStop();
+
+// Move buffered records to the file (call from the main loop)
+void bridgeCaptureService();
+
+BridgeCaptureStatus bridgeCaptureGetStatus();
+
+const char* bridgeCaptureTargetToStr(BridgeCaptureTarget t);
@@ -0,0 +1,819 @@
+/*
+ * Bridge Engine - Implementation
+ *
+ * Frame ring, session table and priority/round-robin arbiter shared by the
+ * bridge transports. Frames are executed by the I2C engine.
+ */
+
+#include "bridge_engine.h"
+
+#include <Arduino.h>
+
+#include "bridge_cache.h"
+#include "bridge_capture.h"
+#include "bridge_stats.h"
+
+// ===================================================================================
+// Frame Ring
+// ===================================================================================
+bool BridgeFrameRing::push(const BridgeFrame& frame) {
+  if (full()) return false;
+  uint16_t tail = (head_ + count_) % BRIDGE_RING_CAPACITY;
+  frames_[tail] = frame;
+  count_++;
+  return true;
+}
+
+bool BridgeFrameRing::pop(BridgeFrame& out) {
+  if (empty()) return false;
+  out = frames_[head_];
+  head_ = (head_ + 1) % BRIDGE_RING_CAPACITY;
+  count_--;
+  return true;
+}
+
+// ===================================================================================
+// Singleton Implementation
+// ===================================================================================
+BridgeEngine& BridgeEngine::getInstance() {
+  static BridgeEngine instance;
+  return instance;
+}
+
+bool BridgeEngine::begin(TaskHandle_t owner) {
+  for (uint8_t bus = 0; bus < I2C_BUS_COUNT; bus++) {
+    I2cEngine& i2c = I2cEngine::getInstance(bus);
+    if (bus != I2C_BUS_PRIMARY_PORT && !i2c.isRunning()) continue;
+
+    I2cLane** lanes = lanes_[bus];
+    if (!lanes[BRIDGE_PRIO_NORMAL]) lanes[BRIDGE_PRIO_NORMAL] = i2c.openLane(owner);
+    if (!lanes[BRIDGE_PRIO_HIGH]) lanes[BRIDGE_PRIO_HIGH] = i2c.openLane(owner, true);
+  }
+  I2cLane** primary = lanes_[I2C_BUS_PRIMARY_PORT];
+  return primary[BRIDGE_PRIO_NORMAL] && primary[BRIDGE_PRIO_HIGH];
+}
+
+// ===================================================================================
+// Session Management
+// ===================================================================================
+int BridgeEngine::openSession(BridgeTransport transport, const char* peer) {
+  bool udp = transport == BridgeTransport::UDP;
+  int first = udp ? BRIDGE_MAX_SESSIONS : 0;
+  int last = udp ? BRIDGE_SESSION_SLOTS : BRIDGE_MAX_SESSIONS;
+  for (int slot = first; slot < last; slot++) {
+    BridgeSession& s = sessions_[slot];
+    if (s.active) continue;
+
+    s = BridgeSession();
+    s.active = true;
+    s.id = next_id_++;
+    s.transport = transport;
+    s.cmd_classes = default_cmd_classes_;
+    s.connected_ms = millis();
+    if (peer) strlcpy(s.peer, peer, sizeof(s.peer));
+    return slot;
+  }
+  return -1;
+}
+
+void BridgeEngine::closeSession(int slot) {
+  BridgeSession* s = session(slot);
+  if (!s) return;
+  // Frames still with the I2C engine are discarded by collect() via the session id
+  s->rx.clear();
+  s->tx_len = 0;
+  s->tx_reserved = 0;
+  s->tx_count = 0;
+  s->tx_partial = 0;
+  s->inflight = 0;
+  s->sub_inflight = 0;
+  s->macro.abort();
+  s->macro_run = false;
+  s->active = false;
+}
+
+BridgeSession* BridgeEngine::session(int slot) {
+  if (slot < 0 || slot >= BRIDGE_SESSION_SLOTS) return nullptr;
+  return sessions_[slot].active ? &sessions_[slot] : nullptr;
+}
+
+// ===================================================================================
+// Request Intake
+// ===================================================================================
+bool BridgeEngine::enqueueFrame(BridgeSession& s, BridgeFrame& frame) {
+  frame.prio = s.prio;
+  if (frame.tx_len > 0 && s.cmd_classes.isHigh(frame.data[0])) frame.prio = BRIDGE_PRIO_HIGH;
+  if (!s.rx.push(frame)) return false;
+
+  s.frames_in++;
+  if (frame.prio == BRIDGE_PRIO_HIGH) s.frames_high++;
+  s.bytes_in += frame.v2 ? BRIDGE_V2_HDR_SIZE + frame.tx_len : BRIDGE_FRAME_SIZE;
+  if (s.rx.size() > s.rx_peak) s.rx_peak = s.rx.size();
+  size_t backlog = s.rx.size() + s.inflight;
+  if (backlog > s.backlog_peak) s.backlog_peak = backlog;
+  return true;
+}
+
+void BridgeEngine::setPriorityCommands(const uint8_t* cmds, size_t count) {
+  default_cmd_classes_ = BridgeCommandClasses();
+  for (size_t i = 0; i < count; i++) default_cmd_classes_.set(cmds[i], true);
+}
+
+// ===================================================================================
+// Flow Control
+// ===================================================================================
+void BridgeEngine::setWatermarks(int high, int low) {
+  if (high < 1) high = 1;
+  if (high > BRIDGE_RING_CAPACITY) high = BRIDGE_RING_CAPACITY;
+  if (low < 0) low = 0;
+  if (low >= high) low = high - 1;
+  wm_high_ = (size_t)high;
+  wm_low_ = (size_t)low;
+}
+
+bool BridgeEngine::updateThrottle(BridgeSession& s) {
+  size_t backlog = s.rx.size() + s.inflight;
+  if (!s.throttled && backlog >= wm_high_) {
+    s.throttled = true;
+    s.throttle_events++;
+    s.throttle_start_ms = millis();
+  } else if (s.throttled && backlog <= wm_low_) {
+    s.throttled = false;
+    s.throttled_ms += millis() - s.throttle_start_ms;
+  }
+  return s.throttled;
+}
+
+bool BridgeEngine::acceptsFrames(int slot) {
+  BridgeSession* s = session(slot);
+  return s && !updateThrottle(*s);
+}
+
+bool BridgeEngine::enqueue(int slot, const uint8_t* data) {
+  BridgeSession* s = session(slot);
+  if (!s) return false;
+
+  BridgeFrame frame;
+  memcpy(frame.data, data, BRIDGE_FRAME_SIZE);
+  frame.tx_len = BRIDGE_FRAME_SIZE;
+  frame.rx_len = BRIDGE_FRAME_SIZE;
+  frame.addr = BRIDGE_ADDR_CURRENT;
+  frame.v2 = false;
+  frame.tag = 0;
+  frame.rx_us = micros();
+  return enqueueFrame(*s, frame);
+}
+
+int BridgeEngine::parse(int slot, const uint8_t* data, size_t len, size_t& frames) {
+  frames = 0;
+  BridgeSession* s = session(slot);
+  if (!s) return 0;
+
+  uint32_t now = micros();
+  size_t pos = 0;
+  while (!s->rx.full() && !updateThrottle(*s)) {
+    const uint8_t* p = data + pos;
+    size_t avail = len - pos;
+    BridgeFrame frame;
+    frame.rx_us = now;
+    size_t used;
+
+    if (s->rx_proto == BRIDGE_PROTO_V2) {
+      if (avail < BRIDGE_V2_HDR_SIZE) break;
+      uint8_t txLen = p[3];
+      uint8_t rxLen = p[4];
+      if (txLen > BRIDGE_V2_MAX_PAYLOAD || rxLen > BRIDGE_V2_MAX_PAYLOAD ||
+          (txLen == 0 && rxLen == 0)) {
+        return -1;
+      }
+      used = BRIDGE_V2_HDR_SIZE + txLen;
+      if (avail < used) break;
+
+      frame.addr = p[0];
+      frame.tag = p[1] | (p[2] << 8);
+      frame.tx_len = txLen;
+      frame.rx_len = rxLen;
+      frame.v2 = true;
+      memcpy(frame.data, p + BRIDGE_V2_HDR_SIZE, txLen);
+
+      // Control frames travel as 8-byte payloads to address 0
+      if (frame.addr == BRIDGE_V2_CTRL_ADDR &&
+          (txLen != BRIDGE_FRAME_SIZE || !bridgeIsControlFrame(frame.data))) {
+        return -1;
+      }
+    } else {
+      if (avail < BRIDGE_FRAME_SIZE) break;
+      used = BRIDGE_FRAME_SIZE;
+      memcpy(frame.data, p, BRIDGE_FRAME_SIZE);
+      frame.tx_len = BRIDGE_FRAME_SIZE;
+      frame.rx_len = BRIDGE_FRAME_SIZE;
+      frame.addr = BRIDGE_ADDR_CURRENT;
+      frame.v2 = false;
+      frame.tag = 0;
+    }
+
+    enqueueFrame(*s, frame);
+    pos += used;
+    frames++;
+
+    // Bytes after a mode switch are already in the new format
+    bool control = !frame.v2 || frame.addr == BRIDGE_V2_CTRL_ADDR;
+    uint8_t target = control ? bridgeModeSwitchTarget(frame.data) : 0;
+    if (target && bridgeTransportIsStream(s->transport)) s->rx_proto = target;
+  }
+  return (int)pos;
+}
+
+// ===================================================================================
+// Response Output
+// ===================================================================================
+void BridgeEngine::appendResponse(BridgeSession& s, const BridgePendingResponse& r,
+                                  uint8_t status, const uint8_t* rx, size_t rxGot,
+                                  const BridgeFrameTiming& timing) {
+  uint8_t* out = &s.tx[s.tx_len];
+  size_t len;
+
+  if (r.v2) {
+    out[0] = r.addr;
+    out[1] = r.tag & 0xFF;
+    out[2] = r.tag >> 8;
+    out[3] = status;
+    out[4] = (uint8_t)rxGot;
+    memcpy(out + BRIDGE_V2_HDR_SIZE, rx, rxGot);
+    len = BRIDGE_V2_HDR_SIZE + rxGot;
+  } else if (status != (uint8_t)I2cStatus::OK) {
+    // Never forward a partial or missing reply as data
+    char code[6];
+    snprintf(code, sizeof(code), "%05u", (unsigned)(BRIDGE_ERR_CODE_BASE + status));
+    out[0] = BRIDGE_ERR_MARKER;
+    memcpy(out + 1, code, 5);
+    out[6] = BRIDGE_ERR_PAD;
+    out[7] = BRIDGE_ERR_PAD;
+    len = BRIDGE_FRAME_SIZE;
+  } else {
+    memcpy(out, rx, rxGot);
+    len = rxGot > BRIDGE_FRAME_SIZE ? rxGot : BRIDGE_FRAME_SIZE;
+  }
+
+  BridgeFrameTiming& t = s.tx_timing[s.tx_count++];
+  t = timing;
+  t.len = (uint8_t)len;
+  s.tx_len += len;
+  s.frames_out++;
+}
+
+void BridgeEngine::markFlushed(int slot, size_t written) {
+  BridgeSession* s = session(slot);
+  if (!s) return;
+  if (written > s->tx_len) written = s->tx_len;
+  s->bytes_out += written;
+  s->tx_len -= written;
+  if (s->tx_len > 0) memmove(s->tx, s->tx + written, s->tx_len);
+
+  // Account every response whose last byte just went out
+  BridgeStats& stats = BridgeStats::getInstance();
+  uint32_t now = micros();
+  size_t sent = s->tx_partial + written;
+  size_t frames = 0;
+  while (frames < s->tx_count && sent >= s->tx_timing[frames].len) {
+    const BridgeFrameTiming& t = s->tx_timing[frames];
+    stats.recordFrame(t.rx_us, t.start_us, t.done_us, now, t.prio);
+    sent -= t.len;
+    frames++;
+  }
+  s->tx_partial = (uint8_t)sent;
+  if (frames == 0) return;
+
+  s->tx_count -= frames;
+  memmove(s->tx_timing, s->tx_timing + frames, s->tx_count * sizeof(BridgeFrameTiming));
+}
+
+// ===================================================================================
+// Arbiter and Job Hand-off
+// ===================================================================================
+// Mark a lane transaction as a subscription sample or macro step rather than
+// a client frame; the low bits are the session slot
+#define BRIDGE_CHANNEL_SAMPLE 0x80
+#define BRIDGE_CHANNEL_MACRO 0x40
+#define BRIDGE_CHANNEL_FLAGS (BRIDGE_CHANNEL_SAMPLE | BRIDGE_CHANNEL_MACRO)
+
+bool BridgeEngine::hasTxRoom(const BridgeSession& s, size_t bytes) const {
+  // Never have more responses outstanding than the tx buffer can hold
+  return s.tx_len + s.tx_reserved + bytes <= sizeof(s.tx) &&
+         s.tx_count + s.inflight + s.sub_inflight < BRIDGE_RING_CAPACITY;
+}
+
+bool BridgeEngine::lanesHaveRoom(uint8_t prio) const {
+  for (uint8_t bus = 0; bus < I2C_BUS_COUNT; bus++) {
+    if (lanes_[bus][prio] && lanes_[bus][prio]->requests.freeSlots() == 0) return false;
+  }
+  return true;
+}
+
+void BridgeEngine::submitFrame(int slot, uint8_t addr, const uint8_t* tx, uint8_t txLen,
+                               uint8_t rxLen, uint32_t rxUs, uint8_t channelFlags,
+                               uint8_t prio) {
+  BridgeReadCache::getInstance().onDispatch(addr, tx, txLen, ++dispatch_seq_);
+
+  // Write, repeated START, read
+  I2cTransaction txn;
+  txn.addr = addr;
+  txn.tx_len = txLen;
+  txn.rx_len = rxLen;
+  txn.channel = (uint8_t)slot | channelFlags;
+  txn.tag = sessions_[slot].id;
+  txn.seq = dispatch_seq_;
+  txn.queued_us = rxUs;
+  memcpy(txn.tx, tx, txLen);
+  I2cEngine::forAddress(addr).submit(laneFor(addr, prio), txn);
+  outstanding_++;
+}
+
+size_t BridgeEngine::dispatch(uint8_t addr, size_t maxFrames) {
+  I2cLane** primary = lanes_[I2C_BUS_PRIMARY_PORT];
+  if (!primary[BRIDGE_PRIO_NORMAL] || !primary[BRIDGE_PRIO_HIGH]) return 0;
+
+  // Subscriptions have deadlines; sample them before client frames
+  size_t done = sampleSubscriptions(addr, maxFrames);
+  done += runMacros(maxFrames - done);
+
+  // HIGH frames of every session jump ahead of the NORMAL round robin
+  done = arbitrate(addr, maxFrames, done, true);
+  done = arbitrate(addr, maxFrames, done, false);
+  if (done < maxFrames) rr_cursor_ = (rr_cursor_ + 1) % BRIDGE_SESSION_SLOTS;
+
+  return done;
+}
+
+size_t BridgeEngine::arbitrate(uint8_t addr, size_t maxFrames, size_t done, bool highOnly) {
+  BridgeReadCache& cache = BridgeReadCache::getInstance();
+  BridgeCapture& capture = BridgeCapture::getInstance();
+  bool progress = true;
+
+  // Each pass gives every session with queued work one frame, starting with the
+  // session after the last one served so budget exhaustion rotates fairly.
+  while (done < maxFrames && progress) {
+    progress = false;
+    for (int k = 0; k < BRIDGE_SESSION_SLOTS && done < maxFrames; k++) {
+      int slot = (rr_cursor_ + k) % BRIDGE_SESSION_SLOTS;
+      BridgeSession& s = sessions_[slot];
+      if (!s.active || s.rx.empty() || s.macro_run) continue;
+
+      const BridgeFrame& head = s.rx.front();
+      if (highOnly && head.prio != BRIDGE_PRIO_HIGH) continue;
+
+      // Lane full; only this task pushes, so it cannot fill further this call
+      uint8_t target = head.addr == BRIDGE_ADDR_CURRENT ? addr : head.addr;
+      I2cLane* lane = laneFor(target, head.prio);
+      if (lane && lane->requests.freeSlots() == 0) continue;
+
+      // One lane per session: the lanes complete independently
+      bool sameLane = s.inflight_prio == head.prio && s.inflight_bus == i2cAddrBus(target);
+      if (s.inflight > 0 && !sameLane) continue;
+
+      bool control = head.v2 ? head.addr == BRIDGE_V2_CTRL_ADDR : bridgeIsControlFrame(head.data);
+      bool macroRun = control && head.data[3] == BRIDGE_CTRL_MACRO_RUN &&
+                      bridgeTransportIsStream(s.transport);
+      uint8_t rxLen = macroRun  ? BRIDGE_MACRO_RESPONSE_MAX
+                      : control ? BRIDGE_FRAME_SIZE
+                                : head.rx_len;
+      if (!hasTxRoom(s, bridgeResponseSize(head.v2, rxLen))) continue;
+
+      // Control frames, cache hits and frames for a bus that is not running are
+      // answered here, so they may only go out once nothing of this session is
+      // on the bus (responses stay in order)
+      if ((control || !lane) && s.inflight > 0) continue;
+
+      BridgeFrame frame;
+      s.rx.pop(frame);
+
+      BridgePendingResponse r = {target, rxLen, frame.v2, frame.tag};
+      bool cacheable = frame.tx_len == BRIDGE_FRAME_SIZE && frame.rx_len == BRIDGE_FRAME_SIZE;
+
+      uint8_t flags = (frame.v2 ? BRIDGE_CAPTURE_FLAG_V2 : 0) |
+                      (control ? BRIDGE_CAPTURE_FLAG_CONTROL : 0);
+      capture.logRequest(s.id, target, flags, frame.data, frame.tx_len, rxLen, frame.rx_us);
+
+      if (macroRun) {
+        // Answered by finishMacro() once the program ends
+        s.pending[(s.pending_head + s.inflight) % BRIDGE_RING_CAPACITY] = r;
+        s.inflight++;
+        s.inflight_prio = frame.prio;
+        s.inflight_bus = i2cAddrBus(target);
+        s.tx_reserved += bridgeResponseSize(frame.v2, rxLen);
+        s.macro_run = true;
+        memcpy(s.macro_req, frame.data, BRIDGE_FRAME_SIZE);
+        s.macro_rx_us = frame.rx_us;
+        s.macro_start_us = micros();
+        s.macro.start(addr, frame.data[4] | (frame.data[5] << 8), millis());
+        progress = true;
+        continue;
+      }
+
+      uint8_t local[BRIDGE_FRAME_SIZE];
+      if (control) {
+        handleControl(s, frame.data, local);
+      } else if (!lane) {
+        uint32_t now = micros();
+        uint8_t err = (uint8_t)I2cStatus::BUS_ERROR;
+        capture.logResponse(s.id, target, flags, err, local, 0, now, now);
+        appendResponse(s, r, err, local, 0, {frame.rx_us, now, now, 0, frame.prio});
+        progress = true;
+        continue;
+      } else if (s.inflight > 0 || !cacheable || !cache.lookup(target, frame.data, local)) {
+        submitFrame(slot, target, frame.data, frame.tx_len, frame.rx_len, frame.rx_us, 0,
+                    frame.prio);
+        s.pending[(s.pending_head + s.inflight) % BRIDGE_RING_CAPACITY] = r;
+        s.inflight++;
+        s.inflight_prio = frame.prio;
+        s.inflight_bus = i2cAddrBus(target);
+        s.tx_reserved += bridgeResponseSize(frame.v2, frame.rx_len);
+        done++;
+        progress = true;
+        if (done == maxFrames) rr_cursor_ = (slot + 1) % BRIDGE_SESSION_SLOTS;
+        continue;
+      }
+
+      uint32_t now = micros();
+      uint8_t ok = (uint8_t)I2cStatus::OK;
+      if (!control) flags |= BRIDGE_CAPTURE_FLAG_CACHED;
+      capture.logResponse(s.id, target, flags, ok, local, BRIDGE_FRAME_SIZE, now, now);
+      appendResponse(s, r, ok, local, BRIDGE_FRAME_SIZE, {frame.rx_us, now, now, 0, frame.prio});
+      progress = true;
+    }
+  }
+  return done;
+}
+
+size_t BridgeEngine::collect() {
+  size_t n = 0;
+  // HIGH first, so its responses reach the transports in this cycle's flush
+  for (int prio = BRIDGE_PRIO_COUNT - 1; prio >= 0; prio--) {
+    for (uint8_t bus = 0; bus < I2C_BUS_COUNT; bus++) {
+      if (lanes_[bus][prio]) n += collectLane(*lanes_[bus][prio]);
+    }
+  }
+  return n;
+}
+
+size_t BridgeEngine::collectLane(I2cLane& lane) {
+  BridgeReadCache& cache = BridgeReadCache::getInstance();
+  BridgeCapture& capture = BridgeCapture::getInstance();
+  size_t n = 0;
+  I2cTransaction txn;
+  while (lane.completions.pop(txn)) {
+    n++;
+    outstanding_--;
+
+    if (txn.status == I2cStatus::OK && txn.tx_len == BRIDGE_FRAME_SIZE &&
+        txn.rx_got == BRIDGE_FRAME_SIZE) {
+      cache.store(txn.addr, txn.tx, txn.rx, txn.seq, txn.end_us);
+    }
+
+    uint8_t kind = txn.channel & BRIDGE_CHANNEL_FLAGS;
+    BridgeSession& s = sessions_[txn.channel & ~BRIDGE_CHANNEL_FLAGS];
+    if (!s.active || s.id != txn.tag) continue;  // Session went away
+
+    if (kind == BRIDGE_CHANNEL_SAMPLE) {
+      completeSample(s, txn);
+      continue;
+    }
+    if (kind == BRIDGE_CHANNEL_MACRO) {
+      capture.logResponse(s.id, txn.addr, BRIDGE_CAPTURE_FLAG_MACRO, (uint8_t)txn.status, txn.rx,
+                          txn.rx_got, txn.start_us, txn.end_us);
+      s.macro.onBusResult((uint8_t)txn.status, txn.rx, txn.rx_got);
+      continue;
+    }
+
+    const BridgePendingResponse r = s.pending[s.pending_head];
+    s.pending_head = (s.pending_head + 1) % BRIDGE_RING_CAPACITY;
+    s.inflight--;
+    s.tx_reserved -= bridgeResponseSize(r.v2, r.rx_len);
+    capture.logResponse(s.id, r.addr, r.v2 ? BRIDGE_CAPTURE_FLAG_V2 : 0, (uint8_t)txn.status,
+                        txn.rx, txn.rx_got, txn.start_us, txn.end_us);
+    appendResponse(s, r, (uint8_t)txn.status, txn.rx, txn.rx_got,
+                   {txn.queued_us, txn.start_us, txn.end_us, 0, s.inflight_prio});
+  }
+  return n;
+}
+
+// ===================================================================================
+// Control Frames
+// ===================================================================================
+static BridgeSubscription* findSubscription(BridgeSession& s, uint8_t pin) {
+  for (auto& sub : s.subs) {
+    if (sub.active && sub.pin == pin) return &sub;
+  }
+  return nullptr;
+}
+
+void BridgeEngine::handleControl(BridgeSession& s, const uint8_t* req, uint8_t* resp) {
+  memcpy(resp, req, 4);
+  memset(resp + 4, 0, BRIDGE_FRAME_SIZE - 4);
+  uint8_t& status = resp[4];
+  status = BRIDGE_CTRL_OK;
+
+  switch (req[3]) {
+    case BRIDGE_CTRL_NOP:
+      break;
+
+    case BRIDGE_CTRL_SUB_ADD: {
+      // Stream records would break UDP's request/reply pairing
+      if (!bridgeTransportIsStream(s.transport)) {
+        status = BRIDGE_CTRL_ERR_UNSUPPORTED;
+        break;
+      }
+      uint8_t pin = req[4];
+      uint16_t interval = req[5] | (req[6] << 8);
+      if (pin > BRIDGE_SUB_MAX_PIN || interval < BRIDGE_SUB_MIN_INTERVAL_MS) {
+        status = BRIDGE_CTRL_ERR_ARG;
+        break;
+      }
+
+      BridgeSubscription* sub = findSubscription(s, pin);
+      if (!sub) {
+        for (auto& candidate : s.subs) {
+          if (!candidate.active && !candidate.pending) {
+            sub = &candidate;
+            break;
+          }
+        }
+        if (!sub) {
+          status = BRIDGE_CTRL_ERR_FULL;
+          break;
+        }
+        *sub = BridgeSubscription();
+        sub->active = true;
+        sub->pin = pin;
+        s.sub_count++;
+      }
+      sub->interval_ms = interval;
+      sub->next_ms = millis();  // First sample right away
+      resp[5] = s.sub_count;
+      break;
+    }
+
+    case BRIDGE_CTRL_SUB_REMOVE: {
+      uint8_t pin = req[4];
+      for (auto& sub : s.subs) {
+        if (sub.active && (pin == 0xFF || sub.pin == pin)) {
+          // An in-flight sample still completes and is then discarded
+          sub.active = false;
+          s.sub_count--;
+        }
+      }
+      resp[5] = s.sub_count;
+      break;
+    }
+
+    case BRIDGE_CTRL_SET_MODE: {
+      // parse() already switched the incoming side; this switches responses
+      uint8_t target = bridgeModeSwitchTarget(req);
+      if (!bridgeTransportIsStream(s.transport)) {
+        status = BRIDGE_CTRL_ERR_UNSUPPORTED;
+      } else if (!target) {
+        status = BRIDGE_CTRL_ERR_ARG;
+      } else {
+        s.tx_proto = target;
+      }
+      resp[5] = s.tx_proto;
+      break;
+    }
+
+    case BRIDGE_CTRL_SET_PRIORITY:
+      if (req[4] >= BRIDGE_PRIO_COUNT) {
+        status = BRIDGE_CTRL_ERR_ARG;
+      } else {
+        s.prio = req[4];
+      }
+      resp[5] = s.prio;
+      break;
+
+    case BRIDGE_CTRL_CMD_PRIORITY:
+      if (req[5] >= BRIDGE_PRIO_COUNT) {
+        status = BRIDGE_CTRL_ERR_ARG;
+      } else {
+        s.cmd_classes.set(req[4], req[5] == BRIDGE_PRIO_HIGH);
+      }
+      resp[5] = s.cmd_classes.isHigh(req[4]) ? BRIDGE_PRIO_HIGH : BRIDGE_PRIO_NORMAL;
+      break;
+
+    // MACRO_RUN reaches this only on UDP; arbitrate() runs it on stream sessions
+    case BRIDGE_CTRL_MACRO_CLEAR:
+    case BRIDGE_CTRL_MACRO_APPEND:
+    case BRIDGE_CTRL_MACRO_RUN:
+      // A multi-frame result would break UDP's one-reply-per-frame framing
+      if (!bridgeTransportIsStream(s.transport)) {
+        status = BRIDGE_CTRL_ERR_UNSUPPORTED;
+        break;
+      }
+      if (req[3] == BRIDGE_CTRL_MACRO_CLEAR) {
+        s.macro.clear();
+      } else if (!s.macro.append(req + 4, 4)) {
+        status = BRIDGE_CTRL_ERR_FULL;
+      }
+      resp[5] = (uint8_t)s.macro.length();
+      break;
+
+    default:
+      status = BRIDGE_CTRL_ERR_UNSUPPORTED;
+      break;
+  }
+}
+
+// ===================================================================================
+// Subscriptions
+// ===================================================================================
+// Largest stream record in either protocol
+#define BRIDGE_STREAM_RECORD_MAX (BRIDGE_V2_HDR_SIZE + BRIDGE_V2_STREAM_PAYLOAD)
+
+size_t BridgeEngine::sampleSubscriptions(uint8_t addr, size_t budget) {
+  size_t done = 0;
+  uint32_t now = millis();
+  I2cLane* lane = laneFor(addr, BRIDGE_PRIO_NORMAL);
+  if (!lane) return 0;
+
+  for (int slot = 0; slot < BRIDGE_SESSION_SLOTS; slot++) {
+    BridgeSession& s = sessions_[slot];
+    if (!s.active || s.sub_count == 0) continue;
+
+    for (auto& sub : s.subs) {
+      if (done >= budget || lane->requests.freeSlots() == 0) return done;
+      if (!sub.active || sub.pending || (int32_t)(now - sub.next_ms) < 0) continue;
+      if (!hasTxRoom(s, BRIDGE_STREAM_RECORD_MAX)) break;
+
+      // Read public data: [0x81, pin, 0x55 x6]
+      uint8_t req[BRIDGE_FRAME_SIZE] = {0x81, sub.pin, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55};
+      submitFrame(slot, addr, req, BRIDGE_FRAME_SIZE, BRIDGE_FRAME_SIZE, micros(),
+                  BRIDGE_CHANNEL_SAMPLE, BRIDGE_PRIO_NORMAL);
+      sub.pending = true;
+      s.sub_inflight++;
+      s.tx_reserved += BRIDGE_STREAM_RECORD_MAX;
+      done++;
+
+      // Fixed cadence; if the bus fell behind, skip missed periods
+      sub.next_ms += sub.interval_ms;
+      if ((int32_t)(now - sub.next_ms) >= 0) sub.next_ms = now + sub.interval_ms;
+    }
+  }
+  return done;
+}
+
+void BridgeEngine::completeSample(BridgeSession& s, const I2cTransaction& txn) {
+  s.sub_inflight--;
+  s.tx_reserved -= BRIDGE_STREAM_RECORD_MAX;
+
+  BridgeSubscription* sub = nullptr;
+  for (auto& candidate : s.subs) {
+    if (candidate.pending && candidate.pin == txn.tx[1]) {
+      sub = &candidate;
+      break;
+    }
+  }
+  if (!sub) return;
+  sub->pending = false;
+  if (!sub->active) return;  // Unsubscribed while on the bus
+
+  // Bus errors and SerialWombat error replies carry no sample
+  if (txn.status != I2cStatus::OK || txn.rx_got != BRIDGE_FRAME_SIZE || txn.rx[0] == 'E') return;
+
+  uint16_t value = txn.rx[2] | (txn.rx[3] << 8);
+  if (sub->has_value && value == sub->last_value) return;  // Deltas only
+  sub->has_value = true;
+  sub->last_value = value;
+
+  uint32_t t = millis();
+  BridgeFrameTiming timing = {txn.queued_us, txn.start_us, txn.end_us, 0, BRIDGE_PRIO_NORMAL};
+  if (s.tx_proto == BRIDGE_PROTO_V2) {
+    uint8_t payload[BRIDGE_V2_STREAM_PAYLOAD] = {
+        sub->pin,           (uint8_t)(value & 0xFF), (uint8_t)(value >> 8), (uint8_t)(t & 0xFF),
+        (uint8_t)(t >> 8), (uint8_t)(t >> 16),      (uint8_t)(t >> 24)};
+    BridgePendingResponse r = {txn.addr, BRIDGE_V2_STREAM_PAYLOAD, true, BRIDGE_V2_STREAM_TAG};
+    appendResponse(s, r, BRIDGE_V2_STATUS_STREAM, payload, sizeof(payload), timing);
+  } else {
+    uint8_t rec[BRIDGE_FRAME_SIZE] = {BRIDGE_STREAM_MARKER,  sub->pin,
+                                      (uint8_t)(value & 0xFF), (uint8_t)(value >> 8),
+                                      (uint8_t)(t & 0xFF),     (uint8_t)(t >> 8),
+                                      (uint8_t)(t >> 16),      (uint8_t)(t >> 24)};
+    BridgePendingResponse r = {txn.addr, BRIDGE_FRAME_SIZE, false, 0};
+    appendResponse(s, r, (uint8_t)I2cStatus::OK, rec, sizeof(rec), timing);
+  }
+  s.stream_records++;
+}
+
+// ===================================================================================
+// Macros
+// ===================================================================================
+size_t BridgeEngine::runMacros(size_t budget) {
+  BridgeCapture& capture = BridgeCapture::getInstance();
+  size_t done = 0;
+
+  for (int slot = 0; slot < BRIDGE_SESSION_SLOTS; slot++) {
+    BridgeSession& s = sessions_[slot];
+    BridgeMacro& m = s.macro;
+    if (!s.active || !s.macro_run || m.onBus()) continue;
+
+    // A finished program (including a failed transfer) only needs its response
+    if (m.running()) {
+      if ((int32_t)(millis() - m.wakeMs()) < 0) continue;
+      // The step may switch buses (ADDR), so any lane of the class may be next
+      if (done >= budget || !lanesHaveRoom(s.inflight_prio)) continue;
+    }
+
+    if (m.step(millis()) == BridgeMacroAction::BUS) {
+      uint32_t now = micros();
+      capture.logRequest(s.id, m.addr(), BRIDGE_CAPTURE_FLAG_MACRO, m.packet(),
+                         BRIDGE_FRAME_SIZE, BRIDGE_FRAME_SIZE, now);
+      if (!laneFor(m.addr(), s.inflight_prio)) {
+        m.onBusResult((uint8_t)I2cStatus::BUS_ERROR, m.packet(), 0);
+        continue;
+      }
+      submitFrame(slot, m.addr(), m.packet(), BRIDGE_FRAME_SIZE, BRIDGE_FRAME_SIZE, now,
+                  BRIDGE_CHANNEL_MACRO, s.inflight_prio);
+      done++;
+    } else if (!m.running()) {
+      finishMacro(s);
+    }
+  }
+  return done;
+}
+
+void BridgeEngine::finishMacro(BridgeSession& s) {
+  uint8_t resp[BRIDGE_MACRO_RESPONSE_MAX];
+  size_t len = s.macro.writeResponse(s.macro_req, resp);
+
+  const BridgePendingResponse r = s.pending[s.pending_head];
+  s.pending_head = (s.pending_head + 1) % BRIDGE_RING_CAPACITY;
+  s.inflight--;
+  s.tx_reserved -= bridgeResponseSize(r.v2, r.rx_len);
+  s.macro_run = false;
+
+  // The capture keeps the control part; the results are in the step records
+  uint32_t now = micros();
+  uint8_t ok = (uint8_t)I2cStatus::OK;
+  uint8_t flags = BRIDGE_CAPTURE_FLAG_CONTROL | (r.v2 ? BRIDGE_CAPTURE_FLAG_V2 : 0);
+  BridgeCapture::getInstance().logResponse(s.id, r.addr, flags, ok, resp, BRIDGE_FRAME_SIZE,
+                                           s.macro_start_us, now);
+  appendResponse(s, r, ok, resp, len, {s.macro_rx_us, s.macro_start_us, now, 0, s.inflight_prio});
+}
+
+// ===================================================================================
+// Diagnostics
+// ===================================================================================
+size_t BridgeEngine::activeSessionCount() const {
+  size_t n = 0;
+  for (int slot = 0; slot < BRIDGE_SESSION_SLOTS; slot++) {
+    if (sessions_[slot].active) n++;
+  }
+  return n;
+}
+
+bool BridgeEngine::getSessionStats(int slot, BridgeSessionStats& out) const {
+  if (slot < 0 || slot >= BRIDGE_SESSION_SLOTS) return false;
+  const BridgeSession& s = sessions_[slot];
+  if (!s.active) return false;
+
+  out.id = s.id;
+  out.transport = s.transport;
+  memcpy(out.peer, s.peer, sizeof(out.peer));
+  out.connected_ms = s.connected_ms;
+  out.protocol = s.tx_proto;
+  out.priority = s.prio;
+  out.queue_depth = s.rx.size();
+  out.queue_peak = s.rx_peak;
+  out.inflight = s.inflight;
+  out.backlog_peak = s.backlog_peak;
+  out.throttled = s.throttled;
+  out.throttle_events = s.throttle_events;
+  out.throttled_ms = s.throttled_ms + (s.throttled ? millis() - s.throttle_start_ms : 0);
+  out.frames_in = s.frames_in;
+  out.frames_high = s.frames_high;
+  out.frames_out = s.frames_out;
+  out.bytes_in = s.bytes_in;
+  out.bytes_out = s.bytes_out;
+  out.subscriptions = s.sub_count;
+  out.stream_records = s.stream_records;
+  return true;
+}
+
+const char* bridgeTransportToStr(BridgeTransport t) {
+  switch (t) {
+    case BridgeTransport::TCP:
+      return "tcp";
+    case BridgeTransport::UDP:
+      return "udp";
+    case BridgeTransport::SERIAL_PORT:
+      return "serial";
+    default:
+      return "unknown";
+  }
+}
+
+// ===================================================================================
+// Configuration Helpers
+// ===================================================================================
+size_t bridgeClampBatch(int requested) {
+  if (requested < 1) return 1;
+  if (requested > BRIDGE_RING_CAPACITY) return BRIDGE_RING_CAPACITY;
+  return (size_t)requested;
+}
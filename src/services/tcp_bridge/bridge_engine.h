@@ -0,0 +1,411 @@
+/*
+ * Bridge Engine - Header
+ *
+ * Transport-independent core of the SerialWombat bridge. Each connected client
+ * is a session with its own fixed-capacity frame ring. A round-robin arbiter
+ * interleaves queued frames from all sessions, one frame per session per turn,
+ * so a busy client cannot starve the others.
+ *
+ * Bus execution is delegated to the I2C engine through lock-free lanes:
+ * dispatch() submits arbitrated frames as repeated-start write/read
+ * transactions, and collect() moves finished responses back into each
+ * session's tx buffer so the transport can return a whole drain cycle with a
+ * single write.
+ *
+ * Target addresses are bus-qualified (i2c_bus.h). Each configured I2C bus has
+ * its own engine and lanes, so sessions talking to different buses are
+ * serviced in parallel. A session only has frames on one lane (bus and class)
+ * at a time, so its responses stay in order. Frames for a bus that is not
+ * configured are answered with a BUS_ERROR status.
+ *
+ * Priority classes (bridge_protocol.h): each dispatch serves HIGH frames from
+ * every session before the NORMAL round robin, and HIGH frames use the I2C
+ * engine's priority lane, which pre-empts the NORMAL backlog at the next
+ * transaction boundary. A session only has frames of one class on the bus at
+ * a time, so its responses stay in order.
+ *
+ * Control frames (bridge_protocol.h) are answered by the engine itself. Stream
+ * sessions (TCP, serial) can subscribe to pin public data: due subscriptions
+ * are sampled ahead of arbitrated frames and changed values are pushed as
+ * stream records. Stream sessions can also switch to protocol v2 (per-frame address, lengths and
+ * tag); parse() splits the byte stream in whichever mode is active.
+ *
+ * Whitelisted read-only requests can be answered from the read cache
+ * (bridge_cache.h) without a bus transaction.
+ *
+ * Macros (bridge_macro.h): a MACRO_RUN frame occupies its session until the
+ * program ends. dispatch() steps running macros between subscriptions and
+ * arbitrated frames, and their bus transfers share the session's lane.
+ *
+ * Every request produces exactly one response, in order, on the session that
+ * sent it. Legacy responses are 8 bytes, except a MACRO_RUN response.
+ *
+ * Flow control: a session's backlog is its queued plus in-flight frames. Once
+ * it reaches the high watermark the session is throttled: parse() stops
+ * consuming and acceptsFrames() returns false, so transports stop reading the
+ * socket (TCP backpressure) or drop datagrams (UDP) until the backlog falls to
+ * the low watermark.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../i2c_manager/i2c_engine.h"
+#include "bridge_macro.h"
+#include "bridge_protocol.h"
+
+// Size of one SerialWombat packet (request and response)
+#define BRIDGE_FRAME_SIZE 8
+
+// Maximum number of frames buffered per session (upper bound for batch size)
+#define BRIDGE_RING_CAPACITY 32
+
+// Per-session response buffer; holds a full ring of legacy responses
+#define BRIDGE_TX_BUFFER_SIZE (BRIDGE_RING_CAPACITY * BRIDGE_FRAME_SIZE)
+
+// Flow control watermarks until setWatermarks() is called
+#define BRIDGE_QUEUE_HIGH_DEFAULT 24
+#define BRIDGE_QUEUE_LOW_DEFAULT 8
+
+// Maximum number of concurrent stream sessions (TCP clients and the serial port)
+#define BRIDGE_MAX_SESSIONS 4
+
+// Session slots kept for UDP peers. Stream transports never use them, so
+// datagrams from arbitrary (or spoofed) sources cannot lock out TCP clients.
+#define BRIDGE_MAX_UDP_SESSIONS 2
+
+// All session slots: stream slots first, then the UDP slots
+#define BRIDGE_SESSION_SLOTS (BRIDGE_MAX_SESSIONS + BRIDGE_MAX_UDP_SESSIONS)
+
+// Frame target placeholder: resolved to the current SerialWombat at dispatch
+#define BRIDGE_ADDR_CURRENT 0xFF
+
+static_assert(BRIDGE_V2_MAX_PAYLOAD <= I2C_TXN_MAX_LEN, "v2 payload exceeds I2C transaction");
+
+// One request frame (legacy 8-byte or v2)
+struct BridgeFrame {
+  uint8_t data[BRIDGE_V2_MAX_PAYLOAD];
+  uint8_t tx_len;
+  uint8_t rx_len;
+  uint8_t addr;  // Target address or BRIDGE_ADDR_CURRENT
+  bool v2;       // Respond in v2 format
+  uint16_t tag;  // v2 client tag
+  uint8_t prio;  // BRIDGE_PRIO_*, assigned when queued
+  uint32_t rx_us;  // micros() when read from the transport
+};
+
+// Response still owed for a frame on the bus (per session, in dispatch order)
+struct BridgePendingResponse {
+  uint8_t addr;
+  uint8_t rx_len;
+  bool v2;
+  uint16_t tag;
+};
+
+// Size and timestamps of a response waiting in a session's tx buffer
+struct BridgeFrameTiming {
+  uint32_t rx_us;
+  uint32_t start_us;
+  uint32_t done_us;
+  uint8_t len;
+  uint8_t prio;
+};
+
+// Bitmap of command bytes assigned BRIDGE_PRIO_HIGH
+struct BridgeCommandClasses {
+  uint8_t high[32] = {0};
+
+  bool isHigh(uint8_t cmd) const { return high[cmd >> 3] & (1 << (cmd & 7)); }
+  void set(uint8_t cmd, bool isHigh) {
+    if (isHigh) {
+      high[cmd >> 3] |= 1 << (cmd & 7);
+    } else {
+      high[cmd >> 3] &= ~(1 << (cmd & 7));
+    }
+  }
+};
+
+// Fixed-capacity FIFO of bridge frames (single owner, no locking)
+class BridgeFrameRing {
+ public:
+  BridgeFrameRing() : head_(0), count_(0) {}
+
+  size_t size() const { return count_; }
+  size_t capacity() const { return BRIDGE_RING_CAPACITY; }
+  size_t freeSlots() const { return BRIDGE_RING_CAPACITY - count_; }
+  bool empty() const { return count_ == 0; }
+  bool full() const { return count_ == BRIDGE_RING_CAPACITY; }
+
+  // Append one frame; returns false when full
+  bool push(const BridgeFrame& frame);
+
+  // Remove the oldest frame; returns false when empty
+  bool pop(BridgeFrame& out);
+
+  // Oldest frame (ring must not be empty)
+  const BridgeFrame& front() const { return frames_[head_]; }
+
+  void clear() {
+    head_ = 0;
+    count_ = 0;
+  }
+
+ private:
+  BridgeFrame frames_[BRIDGE_RING_CAPACITY];
+  uint16_t head_;
+  uint16_t count_;
+};
+
+// Transport that owns a session
+enum class BridgeTransport : uint8_t { TCP = 0, UDP, SERIAL_PORT };
+
+// Byte-stream transports (TCP, serial) support protocol v2 and subscriptions;
+// UDP pairs each request datagram with one reply
+inline bool bridgeTransportIsStream(BridgeTransport t) {
+  return t != BridgeTransport::UDP;
+}
+
+// Periodic public-data sample pushed to a session as stream records
+struct BridgeSubscription {
+  bool active = false;
+  bool pending = false;  // Sample on the bus
+  bool has_value = false;
+  uint8_t pin = 0;
+  uint16_t interval_ms = 0;
+  uint16_t last_value = 0;
+  uint32_t next_ms = 0;
+};
+
+// Per-session state owned by the engine
+struct BridgeSession {
+  bool active = false;
+  uint32_t id = 0;
+  BridgeTransport transport = BridgeTransport::TCP;
+  char peer[24] = {0};  // Remote endpoint, for diagnostics
+  uint32_t connected_ms = 0;
+
+  // Wire format of incoming bytes (parse side) and of responses/records
+  uint8_t rx_proto = BRIDGE_PROTO_LEGACY;
+  uint8_t tx_proto = BRIDGE_PROTO_LEGACY;
+
+  // Priority class of the session and per-command overrides
+  uint8_t prio = BRIDGE_PRIO_NORMAL;
+  BridgeCommandClasses cmd_classes;
+
+  // Request frames waiting for the bus
+  BridgeFrameRing rx;
+  uint16_t rx_peak = 0;
+
+  // Flow control: not read from while throttled
+  bool throttled = false;
+  uint16_t backlog_peak = 0;     // Queued + in-flight frames
+  uint32_t throttle_events = 0;
+  uint32_t throttled_ms = 0;     // Completed throttle periods
+  uint32_t throttle_start_ms = 0;
+
+  // Frames handed to the I2C engine whose responses have not been collected
+  BridgePendingResponse pending[BRIDGE_RING_CAPACITY];
+  uint8_t pending_head = 0;
+  uint16_t inflight = 0;
+  uint8_t inflight_prio = BRIDGE_PRIO_NORMAL;  // Class (lane) of the frames in flight
+  uint8_t inflight_bus = I2C_BUS_PRIMARY_PORT;  // Bus (lane) of the frames in flight
+
+  // Subscriptions and their samples currently on the bus
+  BridgeSubscription subs[BRIDGE_MAX_SUBSCRIPTIONS];
+  uint8_t sub_count = 0;
+  uint16_t sub_inflight = 0;
+
+  // Uploaded macro and the RUN request whose response it owes (macro_run)
+  BridgeMacro macro;
+  bool macro_run = false;
+  uint8_t macro_req[BRIDGE_FRAME_SIZE] = {0};
+  uint32_t macro_rx_us = 0;
+  uint32_t macro_start_us = 0;
+
+  // Responses produced during the current drain cycle
+  uint8_t tx[BRIDGE_TX_BUFFER_SIZE];
+  size_t tx_len = 0;
+  size_t tx_reserved = 0;  // Worst-case bytes of responses still on the bus
+
+  // One entry per response not yet fully sent; tx_partial bytes of the first
+  // one have already gone out
+  BridgeFrameTiming tx_timing[BRIDGE_RING_CAPACITY];
+  uint8_t tx_count = 0;
+  uint8_t tx_partial = 0;
+
+  // Traffic counters
+  uint32_t frames_in = 0;
+  uint32_t frames_high = 0;  // Frames queued as BRIDGE_PRIO_HIGH
+  uint32_t frames_out = 0;
+  uint32_t bytes_in = 0;
+  uint32_t bytes_out = 0;
+  uint32_t stream_records = 0;
+};
+
+// Snapshot of one session for diagnostics
+struct BridgeSessionStats {
+  uint32_t id;
+  BridgeTransport transport;
+  char peer[24];
+  uint32_t connected_ms;
+  uint8_t protocol;
+  uint8_t priority;
+  uint16_t queue_depth;
+  uint16_t queue_peak;
+  uint16_t inflight;
+  uint16_t backlog_peak;
+  bool throttled;
+  uint32_t throttle_events;
+  uint32_t throttled_ms;  // Including the current throttle period
+  uint32_t frames_in;
+  uint32_t frames_high;
+  uint32_t frames_out;
+  uint32_t bytes_in;
+  uint32_t bytes_out;
+  uint8_t subscriptions;
+  uint32_t stream_records;
+};
+
+class BridgeEngine {
+ public:
+  static BridgeEngine& getInstance();
+
+  // Bind the engine to the I2C engines (one lane per priority class on every
+  // running bus engine); owner is the task that calls dispatch() and
+  // collect() and is notified when submitted frames complete. Returns false
+  // when the primary bus lanes could not be opened.
+  bool begin(TaskHandle_t owner);
+
+  // Allocate a session slot from the transport's budget (UDP or stream);
+  // returns slot index or -1 when all of those slots are in use
+  int openSession(BridgeTransport transport, const char* peer);
+
+  // Release a session slot and drop its queued frames
+  void closeSession(int slot);
+
+  // Access an active session (nullptr if slot is free or out of range)
+  BridgeSession* session(int slot);
+
+  // Queue one legacy 8-byte frame on a session; returns false when its ring is full
+  bool enqueue(int slot, const uint8_t* frame);
+
+  // Command bytes that are BRIDGE_PRIO_HIGH in every session opened from now on
+  void setPriorityCommands(const uint8_t* cmds, size_t count);
+
+  // Flow control watermarks in frames; high is clamped to [1, BRIDGE_RING_CAPACITY]
+  // and low to below high
+  void setWatermarks(int high, int low);
+  size_t watermarkHigh() const { return wm_high_; }
+  size_t watermarkLow() const { return wm_low_; }
+
+  // Update a session's throttle state; false while the transport should not
+  // read more frames for it
+  bool acceptsFrames(int slot);
+
+  // Split received stream bytes into frames in the session's current protocol
+  // and queue them. Only whole frames are consumed, and none once the session
+  // is throttled; the caller keeps the rest for the next call. Returns bytes consumed, or -1 on
+  // a malformed v2 header (the transport should drop the connection).
+  int parse(int slot, const uint8_t* data, size_t len, size_t& frames);
+
+  // Sample due subscriptions, step running macros, then arbitrate queued
+  // frames from all sessions (HIGH heads first, then round robin) onto the I2C
+  // engine lanes, at most
+  // maxFrames bus transactions per call. addr is the current SerialWombat for
+  // legacy frames. Returns frames dispatched.
+  size_t dispatch(uint8_t addr, size_t maxFrames);
+
+  // Append finished responses to their sessions' tx buffers. Responses for
+  // sessions closed meanwhile are dropped. Returns transactions collected.
+  size_t collect();
+
+  // Drop the first written bytes of a session's pending responses once the
+  // transport has sent them; any remainder stays queued for the next flush.
+  // Fully sent frames are recorded in BridgeStats.
+  void markFlushed(int slot, size_t written);
+
+  // Diagnostics
+  size_t activeSessionCount() const;
+  size_t inflight() const { return outstanding_; }
+  bool getSessionStats(int slot, BridgeSessionStats& out) const;
+
+ private:
+  BridgeEngine()
+      : next_id_(1),
+        rr_cursor_(0),
+        outstanding_(0),
+        dispatch_seq_(0),
+        wm_high_(BRIDGE_QUEUE_HIGH_DEFAULT),
+        wm_low_(BRIDGE_QUEUE_LOW_DEFAULT),
+        lanes_{} {}
+  BridgeEngine(const BridgeEngine&) = delete;
+  BridgeEngine& operator=(const BridgeEngine&) = delete;
+
+  // Assigns the frame's priority class, then queues it
+  bool enqueueFrame(BridgeSession& s, BridgeFrame& frame);
+
+  // One arbitration pass over all sessions; with highOnly only sessions whose
+  // next frame is BRIDGE_PRIO_HIGH take part. Returns the updated done count.
+  size_t arbitrate(uint8_t addr, size_t maxFrames, size_t done, bool highOnly);
+
+  // Move one lane's finished transactions to their sessions
+  size_t collectLane(I2cLane& lane);
+
+  // Apply the watermarks to a session's backlog; returns true while throttled
+  bool updateThrottle(BridgeSession& s);
+
+  // Append one response to a session's tx in the frame's format. Legacy
+  // responses are padded with 0xFF to a full frame; only a MACRO_RUN response
+  // is longer.
+  void appendResponse(BridgeSession& s, const BridgePendingResponse& r, uint8_t status,
+                      const uint8_t* rx, size_t rxGot, const BridgeFrameTiming& timing);
+
+  // True when a session can take another response of up to bytes in its tx
+  bool hasTxRoom(const BridgeSession& s, size_t bytes) const;
+
+  // Lane of a class on the bus of a bus-qualified address; nullptr when that
+  // bus is not running
+  I2cLane* laneFor(uint8_t addr, uint8_t prio) const { return lanes_[i2cAddrBus(addr)][prio]; }
+
+  // True when the class's lane has room on every running bus
+  bool lanesHaveRoom(uint8_t prio) const;
+
+  // Submit one transfer to the class's lane of the target's bus on behalf of
+  // a session slot (the lane must exist); channelFlags mark subscription
+  // samples and macro steps
+  void submitFrame(int slot, uint8_t addr, const uint8_t* tx, uint8_t txLen, uint8_t rxLen,
+                   uint32_t rxUs, uint8_t channelFlags, uint8_t prio);
+
+  // Control frames and subscriptions
+  void handleControl(BridgeSession& s, const uint8_t* req, uint8_t* resp);
+  size_t sampleSubscriptions(uint8_t addr, size_t budget);
+  void completeSample(BridgeSession& s, const I2cTransaction& txn);
+
+  // Macros: advance running programs, then answer a finished MACRO_RUN
+  size_t runMacros(size_t budget);
+  void finishMacro(BridgeSession& s);
+
+  BridgeSession sessions_[BRIDGE_SESSION_SLOTS];
+  uint32_t next_id_;
+  uint8_t rr_cursor_;      // Session that gets the first turn next cycle
+  size_t outstanding_;     // Frames dispatched but not yet collected (owner task only)
+  uint32_t dispatch_seq_;  // Frames submitted to the lanes (read cache ordering)
+  size_t wm_high_;         // Backlog at which a session is throttled
+  size_t wm_low_;          // Backlog at which it is read from again
+  BridgeCommandClasses default_cmd_classes_;
+  I2cLane* lanes_[I2C_BUS_COUNT][BRIDGE_PRIO_COUNT];  // Submission lane per bus and class
+};
+
+// Bytes a response to this request occupies in the tx buffer
+inline size_t bridgeResponseSize(bool v2, uint8_t rxLen) {
+  if (v2) return BRIDGE_V2_HDR_SIZE + rxLen;
+  return rxLen > BRIDGE_FRAME_SIZE ? rxLen : BRIDGE_FRAME_SIZE;
+}
+
+// Clamp a configured batch size to the supported range [1, BRIDGE_RING_CAPACITY]
+size_t bridgeClampBatch(int requested);
+
+// Transport name for diagnostics
+const char* bridgeTransportToStr(BridgeTransport t);
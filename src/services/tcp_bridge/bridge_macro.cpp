@@ -0,0 +1,199 @@
+/*
+ * Bridge Macro - Implementation
+ */
+
+#include "bridge_macro.h"
+
+#include <string.h>
+
+#include "bridge_protocol.h"
+
+// Operand bytes following each opcode
+static int operandCount(uint8_t op) {
+  switch (op) {
+    case BRIDGE_MACRO_OP_END:
+    case BRIDGE_MACRO_OP_RESULT:
+      return 0;
+    case BRIDGE_MACRO_OP_SEND:
+      return 8;
+    case BRIDGE_MACRO_OP_DELAY:
+      return 2;
+    case BRIDGE_MACRO_OP_WAIT:
+      return 4;
+    case BRIDGE_MACRO_OP_BRANCH:
+      return 5;
+    case BRIDGE_MACRO_OP_JUMP:
+    case BRIDGE_MACRO_OP_COUNT:
+    case BRIDGE_MACRO_OP_LOOP:
+    case BRIDGE_MACRO_OP_ADDR:
+      return 1;
+    default:
+      return -1;
+  }
+}
+
+static bool compare(uint8_t lhs, uint8_t cmp, uint8_t rhs, bool& ok) {
+  ok = true;
+  switch (cmp) {
+    case 0:
+      return lhs == rhs;
+    case 1:
+      return lhs != rhs;
+    case 2:
+      return lhs < rhs;
+    case 3:
+      return lhs >= rhs;
+    default:
+      ok = false;
+      return false;
+  }
+}
+
+// ===================================================================================
+// Program Upload
+// ===================================================================================
+void BridgeMacro::clear() {
+  len_ = 0;
+  running_ = false;
+  on_bus_ = false;
+  status_ = BRIDGE_CTRL_OK;
+}
+
+bool BridgeMacro::append(const uint8_t* bytes, size_t len) {
+  if (len_ + len > sizeof(program_)) return false;
+  memcpy(program_ + len_, bytes, len);
+  len_ += len;
+  return true;
+}
+
+// ===================================================================================
+// Execution
+// ===================================================================================
+void BridgeMacro::start(uint8_t addr, uint16_t limitMs, uint32_t nowMs) {
+  if (limitMs == 0) limitMs = BRIDGE_MACRO_DEFAULT_MS;
+  if (limitMs > BRIDGE_MACRO_MAX_MS) limitMs = BRIDGE_MACRO_MAX_MS;
+
+  running_ = true;
+  on_bus_ = false;
+  status_ = BRIDGE_CTRL_OK;
+  addr_ = addr;
+  pc_ = 0;
+  send_pc_ = SIZE_MAX;
+  steps_ = 0;
+  counter_ = 0;
+  deadline_ms_ = nowMs + limitMs;
+  wake_ms_ = nowMs;
+  memset(last_, 0, sizeof(last_));
+  i2c_status_ = 0;
+  result_count_ = 0;
+}
+
+// Never sleep past the deadline, so the limit is enforced on time
+BridgeMacroAction BridgeMacro::sleep(uint32_t nowMs, uint32_t ms) {
+  wake_ms_ = nowMs + ms;
+  if ((int32_t)(wake_ms_ - deadline_ms_) > 0) wake_ms_ = deadline_ms_;
+  return BridgeMacroAction::SLEEP;
+}
+
+BridgeMacroAction BridgeMacro::finish(uint8_t status) {
+  status_ = status;
+  running_ = false;
+  on_bus_ = false;
+  return BridgeMacroAction::DONE;
+}
+
+BridgeMacroAction BridgeMacro::step(uint32_t nowMs) {
+  if (!running_) return BridgeMacroAction::DONE;
+
+  for (;;) {
+    if ((int32_t)(nowMs - deadline_ms_) >= 0 || steps_ >= BRIDGE_MACRO_MAX_STEPS) {
+      return finish(BRIDGE_CTRL_ERR_LIMIT);
+    }
+    // Running off the end is an implicit END
+    if (pc_ >= len_) return finish(BRIDGE_CTRL_OK);
+
+    uint8_t op = program_[pc_];
+    int n = operandCount(op);
+    if (n < 0 || pc_ + 1 + n > len_) return finish(BRIDGE_CTRL_ERR_PROGRAM);
+    const uint8_t* a = &program_[pc_ + 1];
+    size_t next = pc_ + 1 + n;
+    steps_++;
+
+    switch (op) {
+      case BRIDGE_MACRO_OP_END:
+        return finish(BRIDGE_CTRL_OK);
+
+      case BRIDGE_MACRO_OP_SEND:
+        memcpy(packet_, a, sizeof(packet_));
+        send_pc_ = pc_;
+        pc_ = next;
+        on_bus_ = true;
+        return BridgeMacroAction::BUS;
+
+      case BRIDGE_MACRO_OP_RESULT:
+        if (result_count_ >= BRIDGE_MACRO_MAX_RESULTS) return finish(BRIDGE_CTRL_ERR_PROGRAM);
+        memcpy(results_[result_count_++], last_, sizeof(last_));
+        break;
+
+      case BRIDGE_MACRO_OP_DELAY:
+        pc_ = next;
+        return sleep(nowMs, a[0] | (a[1] << 8));
+
+      case BRIDGE_MACRO_OP_WAIT:
+        if (a[0] >= sizeof(last_) || send_pc_ == SIZE_MAX) return finish(BRIDGE_CTRL_ERR_PROGRAM);
+        if ((last_[a[0]] & a[1]) == a[2]) break;
+        // Not ready: poll again with the last packet
+        pc_ = send_pc_;
+        if (a[3] == 0) continue;
+        return sleep(nowMs, a[3]);
+
+      case BRIDGE_MACRO_OP_BRANCH: {
+        bool ok;
+        if (a[0] >= sizeof(last_)) return finish(BRIDGE_CTRL_ERR_PROGRAM);
+        bool taken = compare(last_[a[0]] & a[1], a[3], a[2], ok);
+        if (!ok) return finish(BRIDGE_CTRL_ERR_PROGRAM);
+        if (taken) next = a[4];
+        break;
+      }
+
+      case BRIDGE_MACRO_OP_JUMP:
+        next = a[0];
+        break;
+
+      case BRIDGE_MACRO_OP_COUNT:
+        counter_ = a[0];
+        break;
+
+      case BRIDGE_MACRO_OP_LOOP:
+        if (counter_ > 0 && --counter_ > 0) next = a[0];
+        break;
+
+      case BRIDGE_MACRO_OP_ADDR:
+        addr_ = a[0];
+        break;
+    }
+    pc_ = next;
+  }
+}
+
+void BridgeMacro::onBusResult(uint8_t i2cStatus, const uint8_t* rx, size_t got) {
+  on_bus_ = false;
+  i2c_status_ = i2cStatus;
+  if (i2cStatus != 0) {
+    // Retries are exhausted by then; the program cannot act on missing data
+    finish(BRIDGE_CTRL_ERR_BUS);
+    return;
+  }
+  memset(last_, 0xFF, sizeof(last_));
+  memcpy(last_, rx, got < sizeof(last_) ? got : sizeof(last_));
+}
+
+size_t BridgeMacro::writeResponse(const uint8_t* req, uint8_t* out) const {
+  memcpy(out, req, 4);
+  out[4] = status_;
+  out[5] = result_count_;
+  out[6] = (uint8_t)pc_;
+  out[7] = i2c_status_;
+  memcpy(out + 8, results_, result_count_ * 8);
+  return 8 + result_count_ * 8;
+}
@@ -0,0 +1,131 @@
+/*
+ * Bridge Macro - Header
+ *
+ * Small bytecode interpreter for SerialWombat packet sequences that would
+ * otherwise cost one network round trip per step (write config, poll a
+ * status byte until ready, read the result). A client uploads a program into
+ * its session with MACRO_CLEAR/MACRO_APPEND control frames and starts it with
+ * MACRO_RUN; the bridge engine runs it next to other sessions' traffic and
+ * answers the RUN frame with one response carrying every collected result.
+ *
+ * Program format: opcode byte, then operands. Jump targets are byte offsets
+ * into the program. "last" is the most recent 8-byte SerialWombat response.
+ *
+ *   END                          0x00            Stop, success
+ *   SEND p0..p7                  0x01 + 8 bytes  Send a packet, response -> last
+ *   RESULT                       0x02            Append last to the results
+ *   DELAY ms_lo ms_hi            0x03 + 2        Pause
+ *   WAIT i mask value ms         0x04 + 4        Until (last[i] & mask) == value,
+ *                                                repeat the last SEND every ms
+ *   BRANCH i mask value cmp tgt  0x05 + 5        Jump if (last[i] & mask) cmp value
+ *                                                (cmp: 0 ==, 1 !=, 2 <, 3 >=)
+ *   JUMP tgt                     0x06 + 1        Jump
+ *   COUNT n                      0x07 + 1        counter = n
+ *   LOOP tgt                     0x08 + 1        If --counter > 0, jump
+ *   ADDR a                       0x09 + 1        Send to I2C address a from now on
+ *
+ * Every run is bounded by a wall-clock limit (MACRO_RUN argument, clamped to
+ * BRIDGE_MACRO_MAX_MS) and by BRIDGE_MACRO_MAX_STEPS executed instructions, so
+ * a program that never finishes (a WAIT whose condition never holds, an
+ * endless loop) is aborted rather than holding its session.
+ *
+ * Single owner (bridge I/O task), no locking.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Program size per session (bytes; multiple of the 4-byte MACRO_APPEND chunk)
+#define BRIDGE_MACRO_MAX_LEN 128
+
+// Results returned per run (8 bytes each)
+#define BRIDGE_MACRO_MAX_RESULTS 8
+
+// Instructions executed per run
+#define BRIDGE_MACRO_MAX_STEPS 1024
+
+// Run time limit when MACRO_RUN passes 0, and upper bound for any limit
+#define BRIDGE_MACRO_DEFAULT_MS 100
+#define BRIDGE_MACRO_MAX_MS 1000
+
+// RUN response: 8-byte control response followed by the results
+#define BRIDGE_MACRO_RESPONSE_MAX (8 + 8 * BRIDGE_MACRO_MAX_RESULTS)
+
+// Opcodes
+#define BRIDGE_MACRO_OP_END 0x00
+#define BRIDGE_MACRO_OP_SEND 0x01
+#define BRIDGE_MACRO_OP_RESULT 0x02
+#define BRIDGE_MACRO_OP_DELAY 0x03
+#define BRIDGE_MACRO_OP_WAIT 0x04
+#define BRIDGE_MACRO_OP_BRANCH 0x05
+#define BRIDGE_MACRO_OP_JUMP 0x06
+#define BRIDGE_MACRO_OP_COUNT 0x07
+#define BRIDGE_MACRO_OP_LOOP 0x08
+#define BRIDGE_MACRO_OP_ADDR 0x09
+
+// What the engine has to do for a running macro next
+enum class BridgeMacroAction : uint8_t {
+  BUS = 0,  // Send packet() to addr(), then call onBusResult()
+  SLEEP,    // Call step() again once millis() reaches wakeMs()
+  DONE      // Finished or aborted; see status()
+};
+
+class BridgeMacro {
+ public:
+  BridgeMacro() { clear(); }
+
+  // Program upload; append() returns false when the program would not fit
+  void clear();
+  bool append(const uint8_t* bytes, size_t len);
+  size_t length() const { return len_; }
+
+  // Start a run against I2C address addr with a time limit (0 = default)
+  void start(uint8_t addr, uint16_t limitMs, uint32_t nowMs);
+  bool running() const { return running_; }
+  bool onBus() const { return on_bus_; }
+
+  // Execute instructions until the next bus transfer, pause or end
+  BridgeMacroAction step(uint32_t nowMs);
+
+  const uint8_t* packet() const { return packet_; }
+  uint8_t addr() const { return addr_; }
+  uint32_t wakeMs() const { return wake_ms_; }
+
+  // Response to the packet of the last BUS action
+  void onBusResult(uint8_t i2cStatus, const uint8_t* rx, size_t got);
+
+  // Stop without a result (session closed)
+  void abort() { running_ = on_bus_ = false; }
+
+  // After DONE: control status (BRIDGE_CTRL_*) and the RUN response
+  // [req 0..3, status, results, pc, i2c status] + results (at most
+  // BRIDGE_MACRO_RESPONSE_MAX bytes); returns bytes written
+  uint8_t status() const { return status_; }
+  size_t writeResponse(const uint8_t* req, uint8_t* out) const;
+
+ private:
+  BridgeMacroAction sleep(uint32_t nowMs, uint32_t ms);
+  BridgeMacroAction finish(uint8_t status);
+
+  uint8_t program_[BRIDGE_MACRO_MAX_LEN];
+  size_t len_;
+
+  bool running_;
+  bool on_bus_;
+  uint8_t status_;
+  uint8_t addr_;
+  size_t pc_;
+  size_t send_pc_;  // Last SEND, repeated by WAIT
+  uint16_t steps_;
+  uint8_t counter_;
+  uint32_t deadline_ms_;
+  uint32_t wake_ms_;
+
+  uint8_t packet_[8];
+  uint8_t last_[8];
+  uint8_t i2c_status_;  // Of the last transfer
+  uint8_t results_[BRIDGE_MACRO_MAX_RESULTS][8];
+  uint8_t result_count_;
+};
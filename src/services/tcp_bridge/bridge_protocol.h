@@ -0,0 +1,131 @@
+/*
+ * Bridge Protocol - Header
+ *
+ * Wire formats spoken by bridge sessions.
+ *
+ * Legacy (default): fixed 8-byte frames to the current SerialWombat address.
+ * Ordinary frames are forwarded unchanged; only frames carrying the control
+ * magic are handled by the bridge itself.
+ *
+ * Control request:  [0xFF, 'W', 'B', op, a, b, c, d]
+ * Control response: [0xFF, 'W', 'B', op, status, x, y, z]
+ *   Answered in order with the session's other responses.
+ *
+ * Priority classes: every request is NORMAL or HIGH. A request is HIGH when
+ * its session was set HIGH (SET_PRIORITY) or its command byte (first payload
+ * byte) was marked HIGH for the session (CMD_PRIORITY, or the bridge's
+ * configured default list). HIGH requests of all sessions are dispatched
+ * before NORMAL ones and bypass the bus backlog at the next frame boundary.
+ * Responses still keep request order within a session, so a HIGH request
+ * waits for earlier requests of its own session.
+ *
+ * Macros (TCP and serial; bridge_macro.h): MACRO_CLEAR and MACRO_APPEND
+ * upload a small program into the session, MACRO_RUN executes it on the
+ * bridge against the current SerialWombat. The RUN response is the 8-byte
+ * control response [0xFF, 'W', 'B', op, status, n, pc, i2c status] followed
+ * by n 8-byte results (n <= 8); in v2 all of it is the reply payload. Later
+ * requests of the session wait until the run has finished.
+ *
+ * Bus failure response: a request whose I2C transfer failed after the
+ * engine's retries is answered with a SerialWombat-style error packet
+ *   ['E', d4, d3, d2, d1, d0, 0x55, 0x55]
+ * where d4..d0 are the ASCII digits of BRIDGE_ERR_CODE_BASE + I2C status, so
+ * SerialWombat client libraries report it as error 32001..32006 instead of
+ * decoding fabricated data.
+ *
+ * Stream record (TCP and serial, unsolicited, interleaved between responses):
+ *   [0xFE, pin, value_lo, value_hi, t0, t1, t2, t3]
+ *   value is the pin's 16-bit public data, t is millis() (LE) at sample time.
+ *   While a session has subscriptions, a response frame starting with 0xFE is
+ *   always a stream record.
+ *
+ * Protocol v2 (TCP and serial, opt-in with SET_MODE): variable-length frames
+ * that carry their own target address and a client tag echoed in the response.
+ *   Request:  [addr, tag_lo, tag_hi, tx_len, rx_len] + tx_len bytes
+ *   Response: [addr, tag_lo, tag_hi, status, rx_got] + rx_got bytes
+ *   addr 0xFF targets the current SerialWombat. Bit 7 of addr selects the
+ *   secondary I2C bus (0x80 | addr7); a frame for a bus that is not configured
+ *   fails with status 3 (bus error). Responses echo addr as sent.
+ *   tx_len and rx_len are 0..32 (not both 0); status is the I2C status
+ *   (0 OK, 1 NACK, 2 timeout, 3 bus error, 4 arbitration lost, 5 short read,
+ *   6 bus stuck). A failed response carries only the bytes actually read
+ *   (rx_got). Responses keep request order.
+ *   A request to address 0x00 with an 8-byte payload is a control frame; its
+ *   control response is the payload of the reply.
+ *   Stream records use tag 0xFFFF, status 0x80 and a 7-byte payload
+ *   [pin, value_lo, value_hi, t0, t1, t2, t3].
+ *   SET_MODE back to legacy is sent as a v2 control frame; the mode change
+ *   applies to bytes after that frame in both directions.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Control frame magic (bytes 0-2)
+#define BRIDGE_CTRL_MAGIC0 0xFF
+#define BRIDGE_CTRL_MAGIC1 'W'
+#define BRIDGE_CTRL_MAGIC2 'B'
+
+// Control operations (byte 3)
+#define BRIDGE_CTRL_NOP 0x00        // Ping; status OK
+#define BRIDGE_CTRL_SUB_ADD 0x01    // a = pin, b/c = interval ms (LE); replaces existing
+#define BRIDGE_CTRL_SUB_REMOVE 0x02 // a = pin, 0xFF = all
+#define BRIDGE_CTRL_SET_MODE 0x03   // a = BRIDGE_PROTO_LEGACY or BRIDGE_PROTO_V2
+#define BRIDGE_CTRL_SET_PRIORITY 0x04  // a = session class (BRIDGE_PRIO_*)
+#define BRIDGE_CTRL_CMD_PRIORITY 0x05  // a = command byte, b = its class in this session
+#define BRIDGE_CTRL_MACRO_CLEAR 0x06   // Discard the session's macro program
+#define BRIDGE_CTRL_MACRO_APPEND 0x07  // a..d = next 4 program bytes; x = program length
+#define BRIDGE_CTRL_MACRO_RUN 0x08     // a/b = time limit ms (LE, 0 = default)
+
+// Control status (response byte 4)
+#define BRIDGE_CTRL_OK 0x00
+#define BRIDGE_CTRL_ERR_ARG 0x01          // Bad pin, interval, mode or class
+#define BRIDGE_CTRL_ERR_FULL 0x02         // No free subscription slot or macro space
+#define BRIDGE_CTRL_ERR_UNSUPPORTED 0x03  // Unknown op or not available on this transport
+#define BRIDGE_CTRL_ERR_BUS 0x04          // Macro: I2C transfer failed
+#define BRIDGE_CTRL_ERR_LIMIT 0x05        // Macro: time or step limit reached
+#define BRIDGE_CTRL_ERR_PROGRAM 0x06      // Macro: bad opcode, operand or result overflow
+
+// Priority classes
+#define BRIDGE_PRIO_NORMAL 0
+#define BRIDGE_PRIO_HIGH 1
+#define BRIDGE_PRIO_COUNT 2
+
+// Bus failure response (legacy): error code is BRIDGE_ERR_CODE_BASE + I2cStatus
+#define BRIDGE_ERR_MARKER 'E'
+#define BRIDGE_ERR_CODE_BASE 32000
+#define BRIDGE_ERR_PAD 0x55
+
+// Stream record marker (byte 0)
+#define BRIDGE_STREAM_MARKER 0xFE
+
+// Session wire formats
+#define BRIDGE_PROTO_LEGACY 1
+#define BRIDGE_PROTO_V2 2
+
+// Protocol v2 framing
+#define BRIDGE_V2_HDR_SIZE 5
+#define BRIDGE_V2_MAX_PAYLOAD 32
+#define BRIDGE_V2_CTRL_ADDR 0x00
+#define BRIDGE_V2_STREAM_TAG 0xFFFF
+#define BRIDGE_V2_STATUS_STREAM 0x80
+#define BRIDGE_V2_STREAM_PAYLOAD 7
+
+// Subscriptions per session and fastest allowed sampling interval
+#define BRIDGE_MAX_SUBSCRIPTIONS 8
+#define BRIDGE_SUB_MIN_INTERVAL_MS 5
+
+// Highest SerialWombat pin number accepted for subscriptions
+#define BRIDGE_SUB_MAX_PIN 19
+
+inline bool bridgeIsControlFrame(const uint8_t* f) {
+  return f[0] == BRIDGE_CTRL_MAGIC0 && f[1] == BRIDGE_CTRL_MAGIC1 && f[2] == BRIDGE_CTRL_MAGIC2;
+}
+
+// Protocol a valid SET_MODE control frame switches to, or 0 if the frame is
+// not a mode switch
+inline uint8_t bridgeModeSwitchTarget(const uint8_t* f) {
+  if (!bridgeIsControlFrame(f) || f[3] != BRIDGE_CTRL_SET_MODE) return 0;
+  return (f[4] == BRIDGE_PROTO_LEGACY || f[4] == BRIDGE_PROTO_V2) ? f[4] : 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * Bridge Statistics - Implementation
+ */
+
+#include "bridge_stats.h"
+
+#include <Arduino.h>
+
+// ===================================================================================
+// Histogram
+// ===================================================================================
+// Values below 4 us get their own bucket; above that each power of two is
+// split into four linear sub-buckets.
+static uint8_t bucketFor(uint32_t us) {
+  if (us < 4) return (uint8_t)us;
+  uint8_t msb = 31 - __builtin_clz(us);
+  uint32_t idx = (msb - 1) * 4 + ((us >> (msb - 2)) & 3);
+  return idx < BRIDGE_HIST_BUCKETS ? (uint8_t)idx : BRIDGE_HIST_BUCKETS - 1;
+}
+
+static uint32_t bucketMid(uint8_t idx) {
+  if (idx < 4) return idx;
+  uint8_t msb = idx / 4 + 1;
+  uint32_t width = 1UL << (msb - 2);
+  uint32_t lower = (4 + idx % 4) * width;
+  return lower + width / 2;
+}
+
+void BridgeHistogram::clear() {
+  memset(buckets, 0, sizeof(buckets));
+  count = 0;
+  max_us = 0;
+  sum_us = 0;
+}
+
+void BridgeHistogram::record(uint32_t us) {
+  buckets[bucketFor(us)]++;
+  count++;
+  sum_us += us;
+  if (us > max_us) max_us = us;
+}
+
+uint32_t BridgeHistogram::percentile(uint8_t p) const {
+  if (count == 0) return 0;
+  // Rank of the sample at percentile p (1-based, rounded up)
+  uint32_t rank = (uint32_t)(((uint64_t)count * p + 99) / 100);
+  if (rank == 0) rank = 1;
+
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < BRIDGE_HIST_BUCKETS; i++) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      uint32_t mid = bucketMid(i);
+      return mid < max_us ? mid : max_us;
+    }
+  }
+  return max_us;
+}
+
+// ===================================================================================
+// Singleton Implementation
+// ===================================================================================
+BridgeStats& BridgeStats::getInstance() {
+  static BridgeStats instance;
+  return instance;
+}
+
+BridgeStats::BridgeStats() : reset_requests_(0), resets_applied_(0) {
+  clear();
+}
+
+void BridgeStats::clear() {
+  for (auto& h : stages_) h.clear();
+  for (auto& h : classes_) h.clear();
+  frames_ = 0;
+  since_ms_ = millis();
+  window_start_ms_ = since_ms_;
+  window_frames_ = 0;
+  frames_per_sec_ = 0;
+}
+
+// ===================================================================================
+// Recording (bridge I/O task only)
+// ===================================================================================
+void BridgeStats::recordFrame(uint32_t rx_us, uint32_t start_us, uint32_t done_us,
+                              uint32_t tx_us, uint8_t prio) {
+  // micros() wraps every ~71 minutes; unsigned differences stay correct
+  stages_[(size_t)BridgeStage::QUEUE].record(start_us - rx_us);
+  stages_[(size_t)BridgeStage::I2C].record(done_us - start_us);
+  stages_[(size_t)BridgeStage::WRITEBACK].record(tx_us - done_us);
+  stages_[(size_t)BridgeStage::TOTAL].record(tx_us - rx_us);
+  if (prio < BRIDGE_PRIO_COUNT) classes_[prio].record(tx_us - rx_us);
+  frames_++;
+  window_frames_++;
+}
+
+void BridgeStats::poll() {
+  uint32_t requested = reset_requests_.load(std::memory_order_acquire);
+  if (requested != resets_applied_) {
+    resets_applied_ = requested;
+    clear();
+    return;
+  }
+
+  uint32_t now = millis();
+  uint32_t elapsed = now - window_start_ms_;
+  if (elapsed >= BRIDGE_RATE_WINDOW_MS) {
+    frames_per_sec_ = (uint32_t)((uint64_t)window_frames_ * 1000 / elapsed);
+    window_frames_ = 0;
+    window_start_ms_ = now;
+  }
+}
+
+// ===================================================================================
+// Diagnostics
+// ===================================================================================
+void BridgeStats::snapshot(BridgeStatsSnapshot& out) const {
+  memcpy(out.stages, stages_, sizeof(out.stages));
+  memcpy(out.classes, classes_, sizeof(out.classes));
+  out.frames = frames_;
+  out.since_ms = since_ms_;
+  out.frames_per_sec = frames_per_sec_;
+}
+
+const char* bridgeStageToStr(BridgeStage stage) {
+  switch (stage) {
+    case BridgeStage::QUEUE:
+      return "queue";
+    case BridgeStage::I2C:
+      return "i2c";
+    case BridgeStage::WRITEBACK:
+      return "writeback";
+    case BridgeStage::TOTAL:
+      return "total";
+    default:
+      return "unknown";
+  }
+}
+
+const char* bridgePriorityToStr(uint8_t prio) {
+  switch (prio) {
+    case BRIDGE_PRIO_NORMAL:
+      return "normal";
+    case BRIDGE_PRIO_HIGH:
+      return "high";
+    default:
+      return "unknown";
+  }
+}
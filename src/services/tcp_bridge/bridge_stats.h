@@ -0,0 +1,106 @@
+/*
+ * Bridge Statistics - Header
+ *
+ * Per-frame latency accounting for the bridge. Every frame carries four
+ * micros() timestamps:
+ *   rx     - frame read from the socket/datagram
+ *   start  - I2C transfer started
+ *   done   - I2C transfer finished
+ *   tx     - response handed to the socket
+ *
+ * and each interval lands in a fixed-bucket log-linear histogram (four
+ * buckets per power of two, so reported percentiles are within ~12%). The
+ * end-to-end interval is also kept per priority class.
+ * Recording is a handful of integer ops with no allocation or locking, so it
+ * stays on in production.
+ *
+ * Writes happen only on the bridge I/O task. Readers on other tasks take an
+ * unlocked snapshot (counters may be a frame apart). Reset is requested from
+ * any task and applied by the I/O task on its next poll().
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+
+#include "bridge_protocol.h"
+
+// Histogram size: covers 0 us .. ~33 s
+#define BRIDGE_HIST_BUCKETS 96
+
+// Interval between frames/s rate samples
+#define BRIDGE_RATE_WINDOW_MS 1000
+
+// Latency stages
+enum class BridgeStage : uint8_t {
+  QUEUE = 0,  // rx -> start: waiting in session ring and I2C lane
+  I2C,        // start -> done: bus transfer
+  WRITEBACK,  // done -> tx: waiting for the transport to send the response
+  TOTAL,      // rx -> tx: end to end inside the bridge
+  COUNT
+};
+
+// Fixed-bucket latency histogram (microseconds)
+struct BridgeHistogram {
+  uint32_t buckets[BRIDGE_HIST_BUCKETS];
+  uint32_t count;
+  uint32_t max_us;
+  uint64_t sum_us;
+
+  void clear();
+  void record(uint32_t us);
+
+  // Estimated value at percentile p (0-100), bucket midpoint
+  uint32_t percentile(uint8_t p) const;
+};
+
+struct BridgeStatsSnapshot {
+  BridgeHistogram stages[(size_t)BridgeStage::COUNT];
+  BridgeHistogram classes[BRIDGE_PRIO_COUNT];  // rx -> tx by BRIDGE_PRIO_*
+  uint32_t frames;          // Frames completed since reset
+  uint32_t since_ms;        // millis() of last reset
+  uint32_t frames_per_sec;  // Rate over the last complete window
+};
+
+class BridgeStats {
+ public:
+  static BridgeStats& getInstance();
+
+  // I/O task: account one frame of class prio that has just been written to
+  // its transport
+  void recordFrame(uint32_t rx_us, uint32_t start_us, uint32_t done_us, uint32_t tx_us,
+                   uint8_t prio);
+
+  // I/O task: apply pending reset and roll the rate window (call every cycle)
+  void poll();
+
+  // Any task
+  void requestReset() { reset_requests_.fetch_add(1, std::memory_order_release); }
+  void snapshot(BridgeStatsSnapshot& out) const;
+
+ private:
+  BridgeStats();
+  BridgeStats(const BridgeStats&) = delete;
+  BridgeStats& operator=(const BridgeStats&) = delete;
+
+  void clear();
+
+  BridgeHistogram stages_[(size_t)BridgeStage::COUNT];
+  BridgeHistogram classes_[BRIDGE_PRIO_COUNT];
+  uint32_t frames_;
+  uint32_t since_ms_;
+
+  uint32_t window_start_ms_;
+  uint32_t window_frames_;
+  uint32_t frames_per_sec_;
+
+  std::atomic<uint32_t> reset_requests_;
+  uint32_t resets_applied_;
+};
+
+// Stage and priority class names for diagnostics
+const char* bridgeStageToStr(BridgeStage stage);
+const char* bridgePriorityToStr(uint8_t prio);
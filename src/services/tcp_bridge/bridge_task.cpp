@@ -0,0 +1,115 @@
+/*
+ * Bridge Task - Implementation
+ *
+ * I/O task cycle:
+ *   1. collect() finished responses from the I2C engine
+ *   2. handleTcpBridge(): flush responses, accept clients, read frames
+ *      handleUdpBridge(): send completed replies, read datagrams
+ *      handleSerialBridge(): write responses, read frames from the Serial port
+ *   3. dispatch() arbitrated frames to the I2C engine lane
+ *   4. sleep until the engine signals completion, or one tick when idle
+ */
+
+#include "bridge_task.h"
+
+#include <Arduino.h>
+
+#include "../../config/system_config.h"
+#include "bridge_cache.h"
+#include "bridge_engine.h"
+#include "bridge_stats.h"
+#include "serial_bridge.h"
+#include "tcp_bridge.h"
+#include "udp_bridge.h"
+
+extern uint8_t currentWombatAddress;  // Defined in serialwombat_manager.cpp
+
+static WiFiServer* s_server = nullptr;
+static TaskHandle_t s_ioTask = nullptr;
+
+// Start handshake: the I/O task opens its lanes, then reports back
+static SemaphoreHandle_t s_started = nullptr;
+static volatile bool s_startOk = false;
+
+// Apply the configured high-priority command bytes ("0x82,131,...")
+static void applyPriorityCommands(const char* list) {
+  uint8_t cmds[256];
+  size_t count = 0;
+  const char* p = list;
+  while (*p && count < sizeof(cmds)) {
+    char* end;
+    unsigned long v = strtoul(p, &end, 0);
+    if (end == p) {
+      p++;  // Skip separators
+      continue;
+    }
+    if (v <= 0xFF) cmds[count++] = (uint8_t)v;
+    p = end;
+  }
+  BridgeEngine::getInstance().setPriorityCommands(cmds, count);
+}
+
+static void bridgeIoTask(void* arg) {
+  (void)arg;
+  BridgeEngine& engine = BridgeEngine::getInstance();
+  BridgeStats& stats = BridgeStats::getInstance();
+
+  // Completion notifications from the I2C engine come to this task. The
+  // lanes are opened here, before the first dispatch, so they are never read
+  // while being written; on failure the task ends before touching a socket.
+  bool ok = engine.begin(xTaskGetCurrentTaskHandle());
+  s_startOk = ok;
+  xSemaphoreGive(s_started);
+  if (!ok) {
+    vTaskDelete(nullptr);
+    return;
+  }
+
+  for (;;) {
+    stats.poll();
+    engine.collect();
+    size_t received = handleTcpBridge(*s_server);
+    received += handleUdpBridge();
+    received += handleSerialBridge();
+
+    engine.dispatch(currentWombatAddress, bridgeClampBatch(g_cfg.bridge_max_batch));
+
+    if (engine.inflight() > 0) {
+      // Wake as soon as the batch completes, but keep polling sockets
+      ulTaskNotifyTake(pdTRUE, 1);
+    } else if (received == 0) {
+      vTaskDelay(1);
+    }
+  }
+}
+
+bool startBridgeTask(WiFiServer& server, int core, int priority) {
+  if (s_ioTask) return true;
+  if (!s_started) s_started = xSemaphoreCreateBinary();
+  if (!s_started) return false;
+
+  BaseType_t affinity = (core >= 0 && core < portNUM_PROCESSORS) ? core : tskNO_AFFINITY;
+  if (priority < 1) priority = 1;
+  if (priority > configMAX_PRIORITIES - 1) priority = configMAX_PRIORITIES - 1;
+
+  s_server = &server;
+  BridgeReadCache::getInstance().configure(g_cfg.bridge_cache_ms > 0 ? g_cfg.bridge_cache_ms : 0);
+  BridgeEngine::getInstance().setWatermarks(g_cfg.bridge_queue_high, g_cfg.bridge_queue_low);
+  applyPriorityCommands(g_cfg.bridge_priority_cmds.c_str());
+
+  TaskHandle_t task = nullptr;
+  if (xTaskCreatePinnedToCore(bridgeIoTask, "bridge_io", BRIDGE_IO_TASK_STACK, nullptr, priority,
+                              &task, affinity) != pdPASS) {
+    return false;
+  }
+
+  // Wait until the task has opened its lanes; a failed task deletes itself
+  xSemaphoreTake(s_started, portMAX_DELAY);
+  if (!s_startOk) return false;
+  s_ioTask = task;
+  return true;
+}
+
+bool bridgeTaskRunning() {
+  return s_ioTask != nullptr;
+}
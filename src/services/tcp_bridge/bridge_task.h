@@ -0,0 +1,26 @@
+/*
+ * Bridge Task - Header
+ *
+ * Runs the SerialWombat bridge socket I/O and arbitration on its own pinned
+ * FreeRTOS task ("bridge_io") so bridge latency no longer depends on how long
+ * the Arduino loop spends in the web server or display code. Bus execution is
+ * handed to the I2C engine task through a lock-free lane; the engine notifies
+ * this task when a dispatched batch has completed.
+ */
+
+#pragma once
+
+#include <WiFiServer.h>
+#include <stdint.h>
+
+// Task stack size (bytes)
+#define BRIDGE_IO_TASK_STACK 4096
+
+// Start the bridge task on the given core (-1 = no affinity) and priority.
+// The server must already be listening and the I2C engine running.
+// Returns once the task has opened its I2C engine lanes; false if the task
+// could not be created or the lanes could not be opened.
+bool startBridgeTask(WiFiServer& server, int core, int priority);
+
+// True once the bridge task is running
+bool bridgeTaskRunning();
@@ -0,0 +1,110 @@
+/*
+ * Serial Bridge Service - Implementation
+ */
+
+#include "serial_bridge.h"
+
+#include <Arduino.h>
+
+#include "bridge_engine.h"
+
+// Bytes buffered while waiting for a whole frame or ring space
+#define SERIAL_BRIDGE_RX_BUFFER (BRIDGE_RING_CAPACITY * BRIDGE_FRAME_SIZE)
+
+static bool s_serialReady = false;
+static int s_slot = -1;
+static uint8_t s_rx[SERIAL_BRIDGE_RX_BUFFER];
+static size_t s_rxLen = 0;
+static uint32_t s_lastRxMs = 0;
+static SerialBridgeStats s_stats = {};
+
+static void closeSerialSession() {
+  BridgeEngine::getInstance().closeSession(s_slot);
+  s_slot = -1;
+  s_stats.bytes_discarded += s_rxLen;
+  s_rxLen = 0;
+}
+
+// Send as much of the session's responses as the port takes without blocking
+static void flushResponses() {
+  BridgeEngine& engine = BridgeEngine::getInstance();
+  BridgeSession* s = engine.session(s_slot);
+  if (!s || s->tx_len == 0) return;
+
+  int room = Serial.availableForWrite();
+  if (room <= 0) return;
+  size_t len = s->tx_len < (size_t)room ? s->tx_len : (size_t)room;
+  size_t written = Serial.write(s->tx, len);
+  engine.markFlushed(s_slot, written);
+}
+
+// Returns frames queued, or -1 on a malformed v2 frame
+static int readFrames() {
+  BridgeEngine& engine = BridgeEngine::getInstance();
+  if (!engine.acceptsFrames(s_slot)) return 0;
+
+  size_t space = sizeof(s_rx) - s_rxLen;
+  int avail = Serial.available();
+  if (avail > 0 && space > 0) {
+    size_t want = (size_t)avail < space ? (size_t)avail : space;
+    s_rxLen += Serial.read(s_rx + s_rxLen, want);
+    s_lastRxMs = millis();
+  }
+  if (s_rxLen == 0) return 0;
+
+  size_t frames;
+  int used = engine.parse(s_slot, s_rx, s_rxLen, frames);
+  if (used < 0) return -1;
+
+  s_rxLen -= used;
+  if (s_rxLen > 0) memmove(s_rx, s_rx + used, s_rxLen);
+
+  // Whatever parse() left while it could still consume is a partial frame
+  BridgeSession* s = engine.session(s_slot);
+  if (s_rxLen > 0 && s && !s->throttled && !s->rx.full() &&
+      millis() - s_lastRxMs >= SERIAL_BRIDGE_FRAME_GAP_MS) {
+    s_stats.resyncs++;
+    s_stats.bytes_discarded += s_rxLen;
+    s_rxLen = 0;
+  }
+  return (int)frames;
+}
+
+// ===================================================================================
+// Public API
+// ===================================================================================
+void initSerialBridge() {
+  s_serialReady = true;
+}
+
+size_t handleSerialBridge() {
+  if (!s_serialReady) return 0;
+
+  if (s_slot >= 0) {
+    flushResponses();
+    if (!Serial) {
+      // USB host closed the port
+      closeSerialSession();
+      return 0;
+    }
+  }
+
+  if (s_slot < 0) {
+    if (Serial.available() <= 0) return 0;
+    s_slot = BridgeEngine::getInstance().openSession(BridgeTransport::SERIAL_PORT, "serial");
+    if (s_slot < 0) return 0;  // All session slots in use; retry next cycle
+    s_stats.sessions++;
+    s_rxLen = 0;
+  }
+
+  int frames = readFrames();
+  if (frames < 0) {
+    closeSerialSession();
+    return 0;
+  }
+  return (size_t)frames;
+}
+
+SerialBridgeStats getSerialBridgeStats() {
+  return s_stats;
+}
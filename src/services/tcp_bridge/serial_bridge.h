@@ -0,0 +1,43 @@
+/*
+ * Serial Bridge Service - Header
+ *
+ * Wired transport for the SerialWombat bridge on the board's Serial port
+ * (USB-CDC on the S3 envs, which set ARDUINO_USB_CDC_ON_BOOT=1; UART0
+ * otherwise). The byte stream is the same as on the TCP bridge: 8-byte legacy
+ * frames, or protocol v2 after a mode switch, with subscriptions available.
+ * Frames go through the same bridge engine and I2C executor as TCP and UDP.
+ *
+ * The port carries one session, opened by the first byte received and closed
+ * when the USB host drops the port (DTR). A partial frame followed by
+ * SERIAL_BRIDGE_FRAME_GAP_MS of silence is discarded, so a host that lost
+ * alignment only has to pause before its next request.
+ *
+ * The port is then no longer the debug console: the app moves MessageCenter
+ * output to UART0 (Serial0) on USB-CDC boards and silences it otherwise.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Silence after which buffered bytes of an incomplete frame are dropped
+#define SERIAL_BRIDGE_FRAME_GAP_MS 20
+
+// Transport-level counters
+struct SerialBridgeStats {
+  uint32_t sessions;         // Sessions opened since boot
+  uint32_t resyncs;          // Partial frames dropped after a gap
+  uint32_t bytes_discarded;  // Bytes dropped by resyncs and failed sessions
+};
+
+// Take over the Serial port for the bridge (call once before the bridge task
+// starts, after the debug console has been moved off the port)
+void initSerialBridge();
+
+// Handle serial bridge I/O (called from the bridge task): send responses,
+// open/close the session and queue received frames. Returns frames received.
+size_t handleSerialBridge();
+
+// Snapshot of transport counters
+SerialBridgeStats getSerialBridgeStats();
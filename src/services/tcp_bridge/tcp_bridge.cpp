@@ -8,72 +8,150 @@
  * - Sends 8-byte command packets
  * - Receives 8-byte response packets
  * - Commands are forwarded to I2C device
- * - Single client at a time (additional connections rejected)
+ * - Up to BRIDGE_MAX_SESSIONS clients at a time (additional connections rejected)
+ * - Control frames can subscribe to pin values; changes are then pushed as
+ *   stream records between responses (see bridge_protocol.h)
+ * - A SET_MODE control frame switches the connection to protocol v2
+ *   (per-frame address, lengths and tag); malformed v2 frames drop the client
+ *
+ * This module only does socket I/O for the bridge task: it writes each
+ * client's collected responses in one coalesced write, then accepts new
+ * clients and hands buffered socket bytes to the engine's parser, which moves
+ * every complete frame into that session's ring. Arbitration and bus execution
+ * live in the bridge engine.
+ *
+ * A session throttled by the engine's flow control is not read from at all:
+ * its bytes stay in lwIP, the receive window closes and the client's sends
+ * block, instead of the bridge buffering work the bus cannot keep up with.
  *
  * Extracted from original .ino file (lines 3812-3847).
  */
 
 #include "tcp_bridge.h"
 
-#include <Arduino.h>
+#if BRIDGE_TCP_BACKEND == BRIDGE_TCP_BACKEND_WIFICLIENT
+
+#  include <Arduino.h>
+
+#  include "bridge_engine.h"
 
-#include <ArduinoOTA.h>
-#include <Wire.h>
+// Bytes buffered per connection while waiting for a whole frame or ring space
+#  define TCP_BRIDGE_RX_BUFFER (BRIDGE_RING_CAPACITY * BRIDGE_FRAME_SIZE)
 
-#include "../../core/i2c_monitor.h"
+// One TCP connection bound to a bridge engine session slot
+struct TcpBridgeConn {
+  WiFiClient client;
+  int slot = -1;
+  uint8_t rx[TCP_BRIDGE_RX_BUFFER];
+  size_t rx_len = 0;
+};
 
-void initTcpBridge(WiFiServer& server) {
-  server.begin();
+static TcpBridgeConn s_conns[BRIDGE_MAX_SESSIONS];
+
+static void closeConn(TcpBridgeConn& conn) {
+  BridgeEngine::getInstance().closeSession(conn.slot);
+  conn.slot = -1;
+  conn.rx_len = 0;
+  conn.client.stop();
 }
 
-void handleTcpBridge(WiFiServer& server, WiFiClient& client, uint8_t targetI2CAddress) {
-  // Check for new client connection
-  if (server.hasClient()) {
-    if (!client || !client.connected()) {
-      // Accept new client
-      client = server.available();
-      client.setNoDelay(true);
-    } else {
-      // Already have a client, reject new connection
-      WiFiClient reject = server.available();
-      reject.stop();
+static void acceptClients(WiFiServer& server) {
+  while (server.hasClient()) {
+    WiFiClient incoming = server.available();
+
+    TcpBridgeConn* free_conn = nullptr;
+    for (auto& conn : s_conns) {
+      if (conn.slot < 0) {
+        free_conn = &conn;
+        break;
+      }
     }
+
+    String peer = incoming.remoteIP().toString() + ":" + String(incoming.remotePort());
+    int slot = free_conn ? BridgeEngine::getInstance().openSession(BridgeTransport::TCP,
+                                                                   peer.c_str())
+                         : -1;
+    if (slot < 0) {
+      // All session slots in use, reject new connection
+      incoming.stop();
+      continue;
+    }
+
+    incoming.setNoDelay(true);
+    free_conn->client = incoming;
+    free_conn->slot = slot;
+    free_conn->rx_len = 0;
   }
+}
 
-  // Handle active client communication
-  if (client && client.connected()) {
-    // Process available data in 8-byte packets
-    while (client.available() >= 8) {
-      uint8_t txBuffer[8];
-      uint8_t rxBuffer[8];
-
-      // Read 8-byte command from TCP client
-      client.read(txBuffer, 8);
-
-      // Forward to I2C device
-      Wire.beginTransmission(targetI2CAddress);
-      Wire.write(txBuffer, 8);
-      Wire.endTransmission();
-      i2cMarkTx();  // Update I2C traffic indicator
-
-      // Read 8-byte response from I2C device
-      uint8_t bytesRead = Wire.requestFrom(targetI2CAddress, (uint8_t)8);
-      i2cMarkRx();  // Update I2C traffic indicator
-
-      for (int i = 0; i < 8; i++) {
-        if (i < bytesRead) {
-          rxBuffer[i] = Wire.read();
-        } else {
-          rxBuffer[i] = 0xFF;  // Pad with 0xFF if less than 8 bytes received
-        }
-      }
+// Returns frames queued, or -1 when the client sent a malformed v2 frame
+static int readFrames(TcpBridgeConn& conn) {
+  BridgeEngine& engine = BridgeEngine::getInstance();
+  if (!engine.acceptsFrames(conn.slot)) return 0;
+
+  // Top up the connection buffer, then hand every whole frame the session
+  // ring has room for to the engine; partial frames wait for more bytes
+  int avail = conn.client.available();
+  size_t space = sizeof(conn.rx) - conn.rx_len;
+  if (avail > 0 && space > 0) {
+    int got = conn.client.read(conn.rx + conn.rx_len, (size_t)avail < space ? avail : space);
+    if (got > 0) conn.rx_len += got;
+  }
+  if (conn.rx_len == 0) return 0;
+
+  size_t frames;
+  int used = engine.parse(conn.slot, conn.rx, conn.rx_len, frames);
+  if (used < 0) return -1;
 
-      // Send response back to TCP client
-      client.write(rxBuffer, 8);
+  conn.rx_len -= used;
+  if (conn.rx_len > 0) memmove(conn.rx, conn.rx + used, conn.rx_len);
+  return (int)frames;
+}
+
+static void flushResponses(TcpBridgeConn& conn) {
+  BridgeEngine& engine = BridgeEngine::getInstance();
+  BridgeSession* s = engine.session(conn.slot);
+  if (!s || s->tx_len == 0) return;
+
+  size_t written = conn.client.write(s->tx, s->tx_len);
+  engine.markFlushed(conn.slot, written);
+}
+
+bool initTcpBridge(WiFiServer& server, uint16_t port) {
+  server.begin(port);
+  return (bool)server;
+}
+
+const char* tcpBridgeBackendName() {
+  return "wificlient";
+}
 
-      // Keep system responsive during bridge operations
-      ArduinoOTA.handle();
-      yield();
+size_t handleTcpBridge(WiFiServer& server) {
+  size_t received = 0;
+
+  // Return everything the executor finished since the last call
+  for (auto& conn : s_conns) {
+    if (conn.slot >= 0) flushResponses(conn);
+  }
+
+  acceptClients(server);
+
+  // Drop closed connections and queue whatever the live ones have sent
+  for (auto& conn : s_conns) {
+    if (conn.slot < 0) continue;
+    if (!conn.client.connected()) {
+      closeConn(conn);
+      continue;
     }
+    int frames = readFrames(conn);
+    if (frames < 0) {
+      closeConn(conn);
+      continue;
+    }
+    received += frames;
   }
+
+  return received;
 }
+
+#endif  // BRIDGE_TCP_BACKEND == BRIDGE_TCP_BACKEND_WIFICLIENT
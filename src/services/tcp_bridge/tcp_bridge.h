@@ -4,20 +4,39 @@
  * Provides TCP-to-I2C bridge functionality for remote SerialWombat access.
  * Listens on TCP port 3000 and forwards 8-byte packets to/from I2C devices.
  *
+ * Two socket backends implement this interface, chosen at build time:
+ * - BRIDGE_TCP_BACKEND_WIFICLIENT (default, tcp_bridge.cpp): Arduino
+ *   WiFiServer/WiFiClient
+ * - BRIDGE_TCP_BACKEND_SOCKETS (tcp_bridge_sockets.cpp): non-blocking lwIP BSD
+ *   sockets; one select() per cycle finds ready clients instead of per-client
+ *   connected()/available() calls. The WiFiServer passed in is left unused.
+ *
  * Extracted from original .ino file (lines 3812-3847).
  */
 
 #pragma once
 
-#include <WiFiClient.h>
 #include <WiFiServer.h>
 #include <stdint.h>
 
 // TCP Bridge Configuration
 #define TCP_PORT 3000
 
-// Initialize TCP bridge server
-void initTcpBridge(WiFiServer& server);
+// Socket backends (build with -D BRIDGE_TCP_BACKEND=2 for raw sockets)
+#define BRIDGE_TCP_BACKEND_WIFICLIENT 1
+#define BRIDGE_TCP_BACKEND_SOCKETS 2
+#ifndef BRIDGE_TCP_BACKEND
+#  define BRIDGE_TCP_BACKEND BRIDGE_TCP_BACKEND_WIFICLIENT
+#endif
+
+// Start listening on port. Returns false when the port cannot be opened.
+bool initTcpBridge(WiFiServer& server, uint16_t port);
+
+// Backend name for logs ("wificlient" or "sockets")
+const char* tcpBridgeBackendName();
 
-// Handle TCP bridge communication (call in loop)
-void handleTcpBridge(WiFiServer& server, WiFiClient& client, uint8_t targetI2CAddress);
+// Handle TCP bridge socket I/O (called from the bridge task).
+// Flushes each client's collected responses in one write, accepts up to
+// BRIDGE_MAX_SESSIONS clients and queues their complete frames on the bridge
+// engine. Returns the number of frames received.
+size_t handleTcpBridge(WiFiServer& server);
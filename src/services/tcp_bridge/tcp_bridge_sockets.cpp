@@ -0,0 +1,214 @@
+/*
+ * TCP Bridge Service - lwIP Socket Backend
+ *
+ * Same behaviour as the WiFiClient backend (tcp_bridge.cpp) on non-blocking
+ * BSD sockets:
+ * - One select() over the listening socket and every client finds new
+ *   connections, received data and closed peers; idle clients cost nothing.
+ * - Data is read with one recv() straight into the connection buffer, without
+ *   WiFiClient's available()/connected() probes and internal copy.
+ * - Each session's responses are already gathered back to back in its tx
+ *   buffer by the engine and leave in a single send() per cycle.
+ *
+ * Throttled sessions (engine flow control) are not read from; a readable
+ * throttled socket is only peeked to notice a closed peer.
+ */
+
+#include "tcp_bridge.h"
+
+#if BRIDGE_TCP_BACKEND == BRIDGE_TCP_BACKEND_SOCKETS
+
+#  include <Arduino.h>
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <lwip/sockets.h>
+#  include <unistd.h>
+
+#  include "bridge_engine.h"
+
+// Bytes buffered per connection while waiting for a whole frame or ring space
+#  define TCP_BRIDGE_RX_BUFFER (BRIDGE_RING_CAPACITY * BRIDGE_FRAME_SIZE)
+
+#  ifndef MSG_NOSIGNAL
+#    define MSG_NOSIGNAL 0
+#  endif
+
+// One TCP connection bound to a bridge engine session slot
+struct TcpBridgeConn {
+  int fd = -1;
+  int slot = -1;
+  uint8_t rx[TCP_BRIDGE_RX_BUFFER];
+  size_t rx_len = 0;
+};
+
+static TcpBridgeConn s_conns[BRIDGE_MAX_SESSIONS];
+static int s_listenFd = -1;
+
+static bool wouldBlock() {
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+
+static void setNonBlocking(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+static void closeConn(TcpBridgeConn& conn) {
+  BridgeEngine::getInstance().closeSession(conn.slot);
+  close(conn.fd);
+  conn.fd = -1;
+  conn.slot = -1;
+  conn.rx_len = 0;
+}
+
+static void acceptClients() {
+  for (;;) {
+    struct sockaddr_in sa;
+    socklen_t saLen = sizeof(sa);
+    int fd = accept(s_listenFd, (struct sockaddr*)&sa, &saLen);
+    if (fd < 0) return;
+
+    TcpBridgeConn* free_conn = nullptr;
+    for (auto& conn : s_conns) {
+      if (conn.slot < 0) {
+        free_conn = &conn;
+        break;
+      }
+    }
+
+    char peer[24];
+    char ip[16];
+    inet_ntop(AF_INET, &sa.sin_addr, ip, sizeof(ip));
+    snprintf(peer, sizeof(peer), "%s:%u", ip, (unsigned)ntohs(sa.sin_port));
+    int slot = free_conn ? BridgeEngine::getInstance().openSession(BridgeTransport::TCP, peer)
+                         : -1;
+    if (slot < 0) {
+      // All session slots in use, reject new connection
+      close(fd);
+      continue;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#  ifdef SO_NOSIGPIPE
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#  endif
+    setNonBlocking(fd);
+    free_conn->fd = fd;
+    free_conn->slot = slot;
+    free_conn->rx_len = 0;
+  }
+}
+
+// Returns frames queued, or -1 when the peer closed, failed or sent a
+// malformed v2 frame. readable: select() reported data or a closed peer.
+static int readFrames(TcpBridgeConn& conn, bool readable) {
+  BridgeEngine& engine = BridgeEngine::getInstance();
+  if (!engine.acceptsFrames(conn.slot)) {
+    if (!readable) return 0;
+    uint8_t b;
+    ssize_t n = recv(conn.fd, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+    return (n == 0 || (n < 0 && !wouldBlock())) ? -1 : 0;
+  }
+
+  size_t space = sizeof(conn.rx) - conn.rx_len;
+  if (readable && space > 0) {
+    ssize_t got = recv(conn.fd, conn.rx + conn.rx_len, space, MSG_DONTWAIT);
+    if (got == 0 || (got < 0 && !wouldBlock())) return -1;
+    if (got > 0) conn.rx_len += got;
+  }
+  if (conn.rx_len == 0) return 0;
+
+  size_t frames;
+  int used = engine.parse(conn.slot, conn.rx, conn.rx_len, frames);
+  if (used < 0) return -1;
+
+  conn.rx_len -= used;
+  if (conn.rx_len > 0) memmove(conn.rx, conn.rx + used, conn.rx_len);
+  return (int)frames;
+}
+
+// Returns false when the connection failed
+static bool flushResponses(TcpBridgeConn& conn) {
+  BridgeEngine& engine = BridgeEngine::getInstance();
+  BridgeSession* s = engine.session(conn.slot);
+  if (!s || s->tx_len == 0) return true;
+
+  ssize_t written = send(conn.fd, s->tx, s->tx_len, MSG_DONTWAIT | MSG_NOSIGNAL);
+  if (written < 0) {
+    if (!wouldBlock()) return false;
+    written = 0;
+  }
+  engine.markFlushed(conn.slot, (size_t)written);
+  return true;
+}
+
+bool initTcpBridge(WiFiServer& server, uint16_t port) {
+  (void)server;
+  if (s_listenFd >= 0) return true;
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return false;
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_addr.s_addr = htonl(INADDR_ANY);
+  sa.sin_port = htons(port);
+  if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) < 0 || listen(fd, BRIDGE_MAX_SESSIONS) < 0) {
+    close(fd);
+    return false;
+  }
+  setNonBlocking(fd);
+  s_listenFd = fd;
+  return true;
+}
+
+const char* tcpBridgeBackendName() {
+  return "sockets";
+}
+
+size_t handleTcpBridge(WiFiServer& server) {
+  (void)server;
+  size_t received = 0;
+
+  // Return everything the executor finished since the last call
+  for (auto& conn : s_conns) {
+    if (conn.slot >= 0 && !flushResponses(conn)) closeConn(conn);
+  }
+
+  // One readiness check for the listener and every client
+  fd_set readable;
+  FD_ZERO(&readable);
+  int maxFd = s_listenFd;
+  if (s_listenFd >= 0) FD_SET(s_listenFd, &readable);
+  for (auto& conn : s_conns) {
+    if (conn.slot < 0) continue;
+    FD_SET(conn.fd, &readable);
+    if (conn.fd > maxFd) maxFd = conn.fd;
+  }
+  if (maxFd < 0) return 0;
+
+  struct timeval noWait = {0, 0};
+  int ready = select(maxFd + 1, &readable, nullptr, nullptr, &noWait);
+
+  // Frames left in a connection buffer by parse() still need handing over
+  for (auto& conn : s_conns) {
+    if (conn.slot < 0) continue;
+    bool hasData = ready > 0 && FD_ISSET(conn.fd, &readable);
+    if (!hasData && conn.rx_len == 0) continue;
+
+    int frames = readFrames(conn, hasData);
+    if (frames < 0) {
+      closeConn(conn);
+      continue;
+    }
+    received += frames;
+  }
+
+  if (ready > 0 && s_listenFd >= 0 && FD_ISSET(s_listenFd, &readable)) acceptClients();
+  return received;
+}
+
+#endif  // BRIDGE_TCP_BACKEND == BRIDGE_TCP_BACKEND_SOCKETS
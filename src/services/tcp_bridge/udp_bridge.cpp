@@ -0,0 +1,219 @@
+/*
+ * UDP Bridge Service - Implementation
+ */
+
+#include "udp_bridge.h"
+
+#include <Arduino.h>
+
+#include "bridge_engine.h"
+
+#define UDP_BRIDGE_HDR_SIZE 2
+#define UDP_BRIDGE_MAX_DATAGRAM (UDP_BRIDGE_HDR_SIZE + UDP_BRIDGE_MAX_FRAMES * BRIDGE_FRAME_SIZE)
+
+// Reply kept for duplicate suppression
+struct UdpReplay {
+  bool valid = false;
+  uint16_t seq = 0;
+  uint16_t len = 0;
+  uint8_t data[UDP_BRIDGE_MAX_DATAGRAM];
+};
+
+// Request whose frames are queued or executing
+struct UdpPending {
+  uint16_t seq;
+  uint8_t frames;
+};
+
+// One remote endpoint bound to a bridge engine session slot
+struct UdpPeer {
+  int slot = -1;
+  IPAddress ip;
+  uint16_t port = 0;
+  uint32_t last_ms = 0;
+
+  UdpPending pending[UDP_BRIDGE_PENDING_DEPTH];
+  uint8_t pending_count = 0;
+
+  UdpReplay replay[UDP_BRIDGE_REPLAY_DEPTH];
+  uint8_t replay_next = 0;
+};
+
+static WiFiUDP s_udp;
+static bool s_udpReady = false;
+static UdpPeer s_peers[UDP_BRIDGE_MAX_PEERS];
+static UdpBridgeStats s_stats = {};
+static uint8_t s_buf[UDP_BRIDGE_MAX_DATAGRAM];
+
+// ===================================================================================
+// Peer Management
+// ===================================================================================
+static void releasePeer(UdpPeer& peer) {
+  BridgeEngine::getInstance().closeSession(peer.slot);
+  peer = UdpPeer();
+}
+
+static UdpPeer* findPeer(const IPAddress& ip, uint16_t port) {
+  for (auto& peer : s_peers) {
+    if (peer.slot >= 0 && peer.ip == ip && peer.port == port) return &peer;
+  }
+  return nullptr;
+}
+
+static UdpPeer* openPeer(const IPAddress& ip, uint16_t port) {
+  for (auto& peer : s_peers) {
+    if (peer.slot >= 0) continue;
+
+    String name = ip.toString() + ":" + String(port);
+    int slot = BridgeEngine::getInstance().openSession(BridgeTransport::UDP, name.c_str());
+    if (slot < 0) return nullptr;
+
+    peer.slot = slot;
+    peer.ip = ip;
+    peer.port = port;
+    return &peer;
+  }
+  return nullptr;
+}
+
+// ===================================================================================
+// Duplicate Suppression
+// ===================================================================================
+static const UdpReplay* findReplay(const UdpPeer& peer, uint16_t seq) {
+  for (const auto& r : peer.replay) {
+    if (r.valid && r.seq == seq) return &r;
+  }
+  return nullptr;
+}
+
+static bool isPending(const UdpPeer& peer, uint16_t seq) {
+  for (uint8_t i = 0; i < peer.pending_count; i++) {
+    if (peer.pending[i].seq == seq) return true;
+  }
+  return false;
+}
+
+static void sendDatagram(const UdpPeer& peer, const uint8_t* data, size_t len) {
+  s_udp.beginPacket(peer.ip, peer.port);
+  s_udp.write(data, len);
+  s_udp.endPacket();
+  s_stats.datagrams_out++;
+}
+
+// ===================================================================================
+// Reply Assembly
+// ===================================================================================
+// Send every request whose responses have all been collected, oldest first
+static void flushReplies(UdpPeer& peer) {
+  BridgeEngine& engine = BridgeEngine::getInstance();
+
+  while (peer.pending_count > 0) {
+    BridgeSession* s = engine.session(peer.slot);
+    if (!s) return;
+
+    const UdpPending& head = peer.pending[0];
+    size_t bytes = head.frames * BRIDGE_FRAME_SIZE;
+    if (s->tx_len < bytes) return;  // Still executing
+
+    UdpReplay& r = peer.replay[peer.replay_next];
+    peer.replay_next = (peer.replay_next + 1) % UDP_BRIDGE_REPLAY_DEPTH;
+    r.valid = true;
+    r.seq = head.seq;
+    r.len = UDP_BRIDGE_HDR_SIZE + bytes;
+    r.data[0] = head.seq & 0xFF;
+    r.data[1] = head.seq >> 8;
+    memcpy(&r.data[UDP_BRIDGE_HDR_SIZE], s->tx, bytes);
+
+    sendDatagram(peer, r.data, r.len);
+    engine.markFlushed(peer.slot, bytes);
+
+    peer.pending_count--;
+    memmove(&peer.pending[0], &peer.pending[1], peer.pending_count * sizeof(UdpPending));
+  }
+}
+
+// ===================================================================================
+// Request Intake
+// ===================================================================================
+static size_t receiveDatagram(int len) {
+  if (len < UDP_BRIDGE_HDR_SIZE + BRIDGE_FRAME_SIZE || len > UDP_BRIDGE_MAX_DATAGRAM ||
+      (len - UDP_BRIDGE_HDR_SIZE) % BRIDGE_FRAME_SIZE != 0) {
+    s_udp.read(s_buf, sizeof(s_buf));  // Discard
+    s_stats.dropped++;
+    return 0;
+  }
+
+  s_udp.read(s_buf, len);
+  s_stats.datagrams_in++;
+
+  IPAddress ip = s_udp.remoteIP();
+  uint16_t port = s_udp.remotePort();
+  uint16_t seq = s_buf[0] | (s_buf[1] << 8);
+  uint8_t frames = (len - UDP_BRIDGE_HDR_SIZE) / BRIDGE_FRAME_SIZE;
+
+  UdpPeer* peer = findPeer(ip, port);
+  if (!peer) peer = openPeer(ip, port);
+  if (!peer) {
+    s_stats.dropped++;
+    return 0;
+  }
+  peer->last_ms = millis();
+
+  // Retransmit: answer from cache, or let the in-flight execution answer it
+  if (const UdpReplay* r = findReplay(*peer, seq)) {
+    sendDatagram(*peer, r->data, r->len);
+    s_stats.duplicates++;
+    return 0;
+  }
+  if (isPending(*peer, seq)) {
+    s_stats.duplicates++;
+    return 0;
+  }
+
+  // All-or-nothing: a partially queued request could never be answered
+  BridgeEngine& engine = BridgeEngine::getInstance();
+  BridgeSession* s = engine.session(peer->slot);
+  if (!s || peer->pending_count >= UDP_BRIDGE_PENDING_DEPTH || s->rx.freeSlots() < frames ||
+      !engine.acceptsFrames(peer->slot)) {
+    s_stats.dropped++;
+    return 0;
+  }
+
+  for (uint8_t i = 0; i < frames; i++) {
+    engine.enqueue(peer->slot, &s_buf[UDP_BRIDGE_HDR_SIZE + i * BRIDGE_FRAME_SIZE]);
+  }
+  peer->pending[peer->pending_count++] = {seq, frames};
+  return frames;
+}
+
+// ===================================================================================
+// Public API
+// ===================================================================================
+bool initUdpBridge(uint16_t port) {
+  s_udpReady = s_udp.begin(port) == 1;
+  return s_udpReady;
+}
+
+size_t handleUdpBridge() {
+  if (!s_udpReady) return 0;
+
+  uint32_t now = millis();
+  for (auto& peer : s_peers) {
+    if (peer.slot < 0) continue;
+    flushReplies(peer);
+    if (peer.pending_count == 0 && now - peer.last_ms > UDP_BRIDGE_PEER_TIMEOUT_MS) {
+      releasePeer(peer);
+    }
+  }
+
+  size_t received = 0;
+  int len;
+  while ((len = s_udp.parsePacket()) > 0) {
+    received += receiveDatagram(len);
+  }
+  return received;
+}
+
+UdpBridgeStats getUdpBridgeStats() {
+  return s_stats;
+}
@@ -0,0 +1,62 @@
+/*
+ * UDP Bridge Service - Header
+ *
+ * Low-latency datagram transport for the SerialWombat bridge, listening on the
+ * same port number as the TCP bridge. Avoids TCP head-of-line blocking and
+ * Nagle/delayed-ACK interaction on small exchanges.
+ *
+ * Datagram format (little-endian):
+ *   Request: [seq:u16][frame 8 bytes] x N     (1 <= N <= UDP_BRIDGE_MAX_FRAMES)
+ *   Reply:   [seq:u16][response 8 bytes] x N  (same seq, same order)
+ *
+ * Each peer (IP:port) gets its own bridge session, so UDP frames are arbitrated
+ * fairly against TCP clients. Peers use the engine's UDP session slots
+ * (BRIDGE_MAX_UDP_SESSIONS), which TCP and serial clients never compete for;
+ * a peer holds its slot until it has been idle for UDP_BRIDGE_PEER_TIMEOUT_MS,
+ * so unknown senders can only exhaust the UDP slots. The last few replies per
+ * peer are kept; a
+ * retransmitted request with a remembered or in-flight sequence number is
+ * answered from that cache (or ignored while in flight) and never executed on
+ * the bus twice. Datagrams that do not fit the session queue are dropped and
+ * left to the client's retransmit.
+ */
+
+#pragma once
+
+#include <WiFiUdp.h>
+#include <stdint.h>
+
+#include "bridge_engine.h"
+
+// Maximum frames per datagram
+#define UDP_BRIDGE_MAX_FRAMES 16
+
+// Concurrent UDP peers (each uses one of the engine's UDP session slots)
+#define UDP_BRIDGE_MAX_PEERS BRIDGE_MAX_UDP_SESSIONS
+
+// Replies remembered per peer for duplicate suppression
+#define UDP_BRIDGE_REPLAY_DEPTH 4
+
+// Requests per peer that may be queued or executing at once
+#define UDP_BRIDGE_PENDING_DEPTH 4
+
+// Idle time after which a peer's session is released
+#define UDP_BRIDGE_PEER_TIMEOUT_MS 30000
+
+// Transport-level counters
+struct UdpBridgeStats {
+  uint32_t datagrams_in;
+  uint32_t datagrams_out;
+  uint32_t duplicates;  // Retransmits answered from cache or ignored in flight
+  uint32_t dropped;     // Malformed, no free peer slot, or queue full
+};
+
+// Open the UDP socket (call once before the bridge task starts)
+bool initUdpBridge(uint16_t port);
+
+// Handle UDP bridge I/O (called from the bridge task): send completed replies,
+// expire idle peers and queue newly received frames. Returns frames received.
+size_t handleUdpBridge();
+
+// Snapshot of transport counters
+UdpBridgeStats getUdpBridgeStats();
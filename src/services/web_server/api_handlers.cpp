@@ -6,21 +6,33 @@
 #include <WiFiManager.h>
 
 #include "../../config/config_manager.h"
+#include "../../core/i2c_monitor.h"
 #include "../../core/messages/boot_manager.h"
 #include "../../core/messages/health_snapshot.h"
 #include "../../core/messages/message_center.h"
+#include "../i2c_manager/fingerprint_cache.h"
+#include "../i2c_manager/i2c_clock.h"
+#include "../i2c_manager/i2c_engine.h"
 #include "../i2c_manager/i2c_manager.h"
+#include "../i2c_manager/i2c_trace.h"
+#include "../i2c_manager/presence_scanner.h"
+#include "../i2c_manager/scan_job.h"
 #include "../security/auth_service.h"
 #include "../security/validators.h"
 #include "../serialwombat/serialwombat_manager.h"
+#include "../tcp_bridge/bridge_cache.h"
+#include "../tcp_bridge/bridge_capture_writer.h"
+#include "../tcp_bridge/bridge_engine.h"
+#include "../tcp_bridge/bridge_stats.h"
+#include "../tcp_bridge/bridge_task.h"
+#include "../tcp_bridge/serial_bridge.h"
+#include "../tcp_bridge/udp_bridge.h"
 #include "html_templates.h"
 
 // External global variables
 extern SerialWombat sw;
 extern uint8_t currentWombatAddress;
 extern WebServer server;
-extern WiFiServer tcpServer;
-extern WiFiClient tcpClient;
 extern SystemConfig g_cfg;
 extern bool isSDEnabled;
 
@@ -102,8 +114,9 @@ void handleRoot(WebServer& server) {
                      "</div>";
   s.replace("<body>", "<body>" + nav);
 
-  String addrHex = String(currentWombatAddress, HEX);
+  String addrHex = String(i2cAddr7(currentWombatAddress), HEX);
   addrHex.toUpperCase();
+  if (i2cAddrBus(currentWombatAddress) == I2C_BUS_SECONDARY_PORT) addrHex += " (bus 1)";
   s.replace("%ADDR%", addrHex);
   s.replace("%IP%", WiFi.localIP().toString());
 
@@ -127,6 +140,20 @@ void handleScanner(WebServer& server) {
   server.send(200, "text/html", FPSTR(SCANNER_HTML));
 }
 
+// Renders the background deep scan from /api/scan/*
+void handleDeepScan(WebServer& server) {
+  String modes = "[";
+  for (int pm = 0; pm < 41; pm++) {
+    if (pm) modes += ",";
+    modes += "\"" + String(FPSTR(pinModeStrings[pm])) + "\"";
+  }
+  modes += "]";
+
+  String s = FPSTR(DEEPSCAN_HTML);
+  s.replace("%PIN_MODES%", modes);
+  server.send(200, "text/html", s);
+}
+
 // ===================================================================================
 // WIFI AND SYSTEM HANDLERS
 // ===================================================================================
@@ -449,25 +476,38 @@ void handleFlashFW(WebServer& server) {
         "pre-wrap;}</style></head><body><h2>SW8B Firmware Update</h2>"));
   server.sendContent("Flashing: " + fwName + " (" + String(fwFile.size()) + " bytes)\n");
 
-  sw.begin(Wire, currentWombatAddress, false);
-  if (!sw.queryVersion()) server.sendContent("Connecting...\n");
-
-  if (!sw.inBoot) {
-    sw.jumpToBoot();
-    sw.hardwareReset();
-    delay(2000);
+  // The SerialWombat library drives Wire directly; lock out bus clears meanwhile
+  const uint8_t bus = i2cAddrBus(currentWombatAddress);
+  bool inBoot;
+  {
+    I2cBusGuard guard(bus);
+    swAttachCurrent(false);
+    if (!sw.queryVersion()) server.sendContent("Connecting...\n");
+    inBoot = sw.inBoot;
+    if (!inBoot) {
+      sw.jumpToBoot();
+      sw.hardwareReset();
+    }
   }
+  if (!inBoot) delay(2000);
 
-  sw.begin(Wire, currentWombatAddress, false);
-  if (!sw.queryVersion()) {
+  bool found;
+  {
+    I2cBusGuard guard(bus);
+    swAttachCurrent(false);
+    found = sw.queryVersion();
+    if (found) sw.eraseFlashPage(0);
+  }
+  if (!found) {
     server.sendContent("Error: Bootloader not found.\n");
     fwFile.close();
     return;
   }
-
-  sw.eraseFlashPage(0);
   server.sendContent("Erasing...\n");
 
+  // Variant builds can share a version string; rescan the chip after any reflash
+  FingerprintCache::getInstance().invalidate();
+
   uint32_t address = 0;
   uint8_t buffer[64];
 
@@ -491,8 +531,11 @@ void handleFlashFW(WebServer& server) {
     }
 
     if (dirty) {
-      sw.writeUserBuffer(0, (uint8_t*)page, 64);
-      sw.writeFlashRow(address * 4 + 0x08000000);
+      {
+        I2cBusGuard guard(bus);
+        sw.writeUserBuffer(0, (uint8_t*)page, 64);
+        sw.writeFlashRow(address * 4 + 0x08000000);
+      }
       if (address % 128 == 0) server.sendContent("Writing addr: 0x" + String(address, HEX) + "\n");
       delay(10);
     }
@@ -503,57 +546,18 @@ void handleFlashFW(WebServer& server) {
   fwFile.close();
 
   uint8_t tx[] = {164, 4, 0, 0, 0, 0, 0, 0};
-  sw.sendPacket(tx);
-  delay(100);
-  sw.hardwareReset();
+  {
+    I2cBusGuard guard(bus);
+    sw.sendPacket(tx);
+    delay(100);
+    sw.hardwareReset();
+  }
 
   server.sendContent("\n<h3>SUCCESS! Redirecting...</h3></body></html>");
   server.sendContent("");
 
   delay(1000);
-  sw.begin(Wire, currentWombatAddress);
-}
-
-// ===================================================================================
-// TCP BRIDGE HANDLER
-// ===================================================================================
-void handleTcpBridge() {
-  if (tcpServer.hasClient()) {
-    if (!tcpClient || !tcpClient.connected()) {
-      tcpClient = tcpServer.available();
-      tcpClient.setNoDelay(true);
-    } else {
-      WiFiClient reject = tcpServer.available();
-      reject.stop();
-    }
-  }
-
-  if (tcpClient && tcpClient.connected()) {
-    while (tcpClient.available() >= 8) {
-      uint8_t txBuffer[8];
-      uint8_t rxBuffer[8];
-
-      tcpClient.read(txBuffer, 8);
-
-      Wire.beginTransmission(currentWombatAddress);
-      Wire.write(txBuffer, 8);
-      Wire.endTransmission();
-      i2cMarkTx();
-
-      uint8_t bytesRead = Wire.requestFrom(currentWombatAddress, (uint8_t)8);
-      i2cMarkRx();
-      for (int i = 0; i < 8; i++) {
-        if (i < bytesRead)
-          rxBuffer[i] = Wire.read();
-        else
-          rxBuffer[i] = 0xFF;
-      }
-
-      tcpClient.write(rxBuffer, 8);
-      ArduinoOTA.handle();
-      yield();
-    }
-  }
+  swAttachCurrent();
 }
 
 // ===================================================================================
@@ -572,12 +576,34 @@ void handleApiVariant(WebServer& server) {
   if (!checkAuth(server)) return;
   addSecurityHeaders(server);
 
-  VariantInfo info = getDeepScanInfoSingle(currentWombatAddress);
+  // The configurator needs every supported mode, not just the variant
+  VariantInfo info = getDeepScanInfoSingle(currentWombatAddress, true);
   DynamicJsonDocument doc(1536);
   doc["variant"] = info.variant;
+  doc["cached"] = info.cached;
   JsonArray capsArr = doc.createNestedArray("capabilities");
-  for (int i = 0; i < 41; i++)
-    if (info.caps[i]) capsArr.add(i);
+  for (int i = 0; i < SW_PIN_MODE_COUNT; i++)
+    if (info.caps.has(i)) capsArr.add(i);
+  String out;
+  serializeJson(doc, out);
+  server.send(200, "application/json", out);
+}
+
+// POST /api/variant/invalidate
+// Drops every cached capability scan; the next variant query probes again
+void handleApiVariantInvalidate(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+
+  FingerprintCache& cache = FingerprintCache::getInstance();
+  size_t removed = cache.invalidate();
+  FingerprintCacheStats st = cache.getStats();
+
+  DynamicJsonDocument doc(256);
+  doc["removed"] = removed;
+  doc["hits"] = st.hits;
+  doc["misses"] = st.misses;
+  doc["stores"] = st.stores;
   String out;
   serializeJson(doc, out);
   server.send(200, "application/json", out);
@@ -791,7 +817,7 @@ void handleApiSystem(WebServer& server) {
   if (!checkAuth(server)) return;
   addSecurityHeaders(server);
 
-  DynamicJsonDocument doc(768);
+  DynamicJsonDocument doc(6144);
   doc["cpu_mhz"] = ESP.getCpuFreqMHz();
   doc["flash_speed_hz"] = (uint32_t)ESP.getFlashChipSpeed();
   doc["sdk"] = String(ESP.getSdkVersion());
@@ -837,6 +863,504 @@ void handleApiSystem(WebServer& server) {
   doc["sd_free"] = 0;
 #endif
 
+  // I2C clock controller: chosen rate and per-device error counters
+  I2cClockStatus clk;
+  I2cClockController::getInstance().getStatus(clk);
+  JsonObject i2c = doc.createNestedObject("i2c");
+  i2c["clock_hz"] = clk.hz;
+  i2c["clock_auto"] = clk.adaptive;
+  i2c["clock_probed_hz"] = clk.probed_hz;
+  i2c["clock_max_hz"] = clk.max_hz;
+  i2c["step_downs"] = clk.step_downs;
+  i2c["step_ups"] = clk.step_ups;
+  i2c["last_change_ms"] = clk.last_change_ms;
+  JsonArray devices = i2c.createNestedArray("devices");
+  for (uint8_t i = 0; i < clk.addr_count; i++) {
+    const I2cAddrErrorStats& a = clk.addrs[i];
+    JsonObject d = devices.createNestedObject();
+    char addr[5];
+    snprintf(addr, sizeof(addr), "0x%02X", a.addr);
+    d["addr"] = addr;
+    d["transfers"] = a.transfers;
+    d["nacks"] = a.nacks;
+    d["timeouts"] = a.timeouts;
+    d["bus_errors"] = a.bus_errors;
+    d["short_reads"] = a.short_reads;
+    d["error_permille"] = a.window_permille;
+  }
+
+  // Transaction engine: failure classes (per attempt), retries and bus clears
+  I2cErrorCounters ec;
+  I2cEngine::getInstance().getErrorCounters(ec);
+  JsonObject errors = i2c.createNestedObject("errors");
+  errors["attempts"] = ec.attempts;
+  errors["nack"] = ec.nacks;
+  errors["timeout"] = ec.timeouts;
+  errors["arb_lost"] = ec.arb_lost;
+  errors["short_read"] = ec.short_reads;
+  errors["bus_stuck"] = ec.bus_stuck;
+  errors["bus_error"] = ec.bus_errors;
+  errors["retries"] = ec.retries;
+  errors["recovered"] = ec.recovered;
+  errors["failed"] = ec.failed;
+  errors["bus_clears"] = ec.bus_clears;
+  errors["bus_clear_failures"] = ec.bus_clear_failures;
+
+  // Secondary bus: fixed clock, own engine (absent when not configured)
+  I2cEngine& engine1 = I2cEngine::getInstance(I2C_BUS_SECONDARY_PORT);
+  if (engine1.isRunning()) {
+    engine1.getErrorCounters(ec);
+    JsonObject bus1 = i2c.createNestedObject("bus1");
+    bus1["sda"] = g_cfg.i2c1_sda;
+    bus1["scl"] = g_cfg.i2c1_scl;
+    bus1["clock_hz"] = g_cfg.i2c1_clock_hz;
+    bus1["attempts"] = ec.attempts;
+    bus1["nack"] = ec.nacks;
+    bus1["retries"] = ec.retries;
+    bus1["failed"] = ec.failed;
+    bus1["bus_clears"] = ec.bus_clears;
+  }
+
+  // Transaction trace ring (/api/i2c/trace)
+  I2cTrace& trace = I2cTrace::getInstance();
+  JsonObject traceObj = i2c.createNestedObject("trace");
+  traceObj["enabled"] = trace.isEnabled();
+  traceObj["recorded"] = trace.recorded();
+  traceObj["depth"] = I2C_TRACE_DEPTH;
+  traceObj["append_cycles"] = trace.appendCycles();  // Boot self-test
+
+  // Traffic: rates over the last second and per-device totals since boot
+  const I2cMonitorRates& rates = i2cMonitorGetRates();
+  I2cMonitorAddrStats stats[portNUM_PROCESSORS * I2C_MONITOR_MAX_ADDRS];
+  I2cMonitorCounters totals;
+  size_t statCount = i2cMonitorSnapshot(stats, sizeof(stats) / sizeof(stats[0]), totals);
+  JsonObject traffic = i2c.createNestedObject("traffic");
+  traffic["tx_per_sec"] = rates.tx_per_sec;
+  traffic["bytes_per_sec"] = rates.bytes_per_sec;
+  JsonArray util = traffic.createNestedArray("util_permille");  // Per bus
+  for (uint16_t u : rates.util_permille) util.add(u);
+  traffic["transactions"] = totals.transactions;
+  traffic["bytes"] = totals.bytes;
+  traffic["errors"] = totals.errors;
+  JsonArray trafficDevices = traffic.createNestedArray("devices");
+  for (size_t i = 0; i < statCount; i++) {
+    const I2cMonitorAddrStats& s = stats[i];
+    JsonObject d = trafficDevices.createNestedObject();
+    if (s.addr >= I2C_MONITOR_OTHER) {
+      // Probe misses and addresses beyond the table
+      d["bus"] = s.addr - I2C_MONITOR_OTHER;
+      d["other"] = true;
+    } else {
+      d["bus"] = i2cAddrBus((uint8_t)s.addr);
+      d["addr"] = i2cAddr7((uint8_t)s.addr);
+    }
+    d["transactions"] = s.counters.transactions;
+    d["bytes"] = s.counters.bytes;
+    d["errors"] = s.counters.errors;
+    d["bus_us"] = s.counters.bus_us;
+  }
+
+  // Background presence scan
+  PresenceSnapshot ps;
+  PresenceScanner::getInstance().getSnapshot(ps);
+  JsonObject presence = i2c.createNestedObject("presence");
+  presence["enabled"] = ps.enabled;
+  presence["devices"] = ps.count;
+  presence["sweeps"] = ps.sweeps;
+  presence["sweep_ms"] = ps.sweep_ms;
+  presence["events_dropped"] = ps.events_dropped;
+
+  String out;
+  serializeJson(doc, out);
+  server.send(200, "application/json", out);
+}
+
+// ===================================================================================
+// BRIDGE API HANDLERS
+// ===================================================================================
+
+// GET /api/bridge/sessions
+// Returns: { task_running, max_sessions, queue_capacity, queue_high, queue_low,
+//            sessions: [ { id, transport, peer, connected_ms, protocol, priority, queue_depth,
+//                          queue_peak, inflight, backlog_peak, throttled, throttle_events,
+//                          throttled_ms, frames_in, frames_high, frames_out, bytes_in,
+//                          bytes_out, subscriptions, stream_records }, ... ],
+//            udp: { enabled, datagrams_in, datagrams_out, duplicates, dropped },
+//            serial: { enabled, sessions, resyncs, bytes_discarded } }
+void handleApiBridgeSessions(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+
+  BridgeEngine& engine = BridgeEngine::getInstance();
+  DynamicJsonDocument doc(3584);
+  doc["task_running"] = bridgeTaskRunning();
+  doc["max_sessions"] = BRIDGE_MAX_SESSIONS;
+  doc["max_udp_sessions"] = BRIDGE_MAX_UDP_SESSIONS;
+  doc["queue_capacity"] = BRIDGE_RING_CAPACITY;
+  doc["queue_high"] = engine.watermarkHigh();
+  doc["queue_low"] = engine.watermarkLow();
+  JsonArray arr = doc.createNestedArray("sessions");
+
+  for (int slot = 0; slot < BRIDGE_SESSION_SLOTS; slot++) {
+    BridgeSessionStats st;
+    if (!engine.getSessionStats(slot, st)) continue;
+
+    JsonObject obj = arr.createNestedObject();
+    obj["id"] = st.id;
+    obj["transport"] = bridgeTransportToStr(st.transport);
+    obj["peer"] = st.peer;
+    obj["connected_ms"] = millis() - st.connected_ms;
+    obj["protocol"] = st.protocol;
+    obj["priority"] = bridgePriorityToStr(st.priority);
+    obj["queue_depth"] = st.queue_depth;
+    obj["queue_peak"] = st.queue_peak;
+    obj["inflight"] = st.inflight;
+    obj["backlog_peak"] = st.backlog_peak;
+    obj["throttled"] = st.throttled;
+    obj["throttle_events"] = st.throttle_events;
+    obj["throttled_ms"] = st.throttled_ms;
+    obj["frames_in"] = st.frames_in;
+    obj["frames_high"] = st.frames_high;
+    obj["frames_out"] = st.frames_out;
+    obj["bytes_in"] = st.bytes_in;
+    obj["bytes_out"] = st.bytes_out;
+    obj["subscriptions"] = st.subscriptions;
+    obj["stream_records"] = st.stream_records;
+  }
+
+  UdpBridgeStats udp = getUdpBridgeStats();
+  JsonObject u = doc.createNestedObject("udp");
+  u["enabled"] = g_cfg.bridge_udp_enable;
+  u["datagrams_in"] = udp.datagrams_in;
+  u["datagrams_out"] = udp.datagrams_out;
+  u["duplicates"] = udp.duplicates;
+  u["dropped"] = udp.dropped;
+
+  SerialBridgeStats ser = getSerialBridgeStats();
+  JsonObject sr = doc.createNestedObject("serial");
+  sr["enabled"] = g_cfg.bridge_serial_enable;
+  sr["sessions"] = ser.sessions;
+  sr["resyncs"] = ser.resyncs;
+  sr["bytes_discarded"] = ser.bytes_discarded;
+
+  String out;
+  serializeJson(doc, out);
+  server.send(200, "application/json", out);
+}
+
+static void addLatencyHistogram(JsonObject parent, const char* name, const BridgeHistogram& h) {
+  JsonObject obj = parent.createNestedObject(name);
+  obj["count"] = h.count;
+  obj["avg"] = h.count ? (uint32_t)(h.sum_us / h.count) : 0;
+  obj["p50"] = h.percentile(50);
+  obj["p95"] = h.percentile(95);
+  obj["p99"] = h.percentile(99);
+  obj["max"] = h.max_us;
+}
+
+// GET /api/bridge/stats
+// Returns: per-stage and per-priority-class latency percentiles (us), frame
+// throughput and read cache counters
+void handleApiBridgeStats(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+
+  // Snapshot is ~2.4 KB; keep it off the loop task's stack
+  static BridgeStatsSnapshot snap;
+  BridgeStats::getInstance().snapshot(snap);
+
+  uint32_t elapsed_ms = millis() - snap.since_ms;
+  DynamicJsonDocument doc(2048);
+  doc["frames"] = snap.frames;
+  doc["window_ms"] = elapsed_ms;
+  doc["frames_per_sec"] = snap.frames_per_sec;
+  doc["frames_per_sec_avg"] =
+      elapsed_ms ? (uint32_t)((uint64_t)snap.frames * 1000 / elapsed_ms) : 0;
+
+  JsonObject stages = doc.createNestedObject("latency_us");
+  for (size_t i = 0; i < (size_t)BridgeStage::COUNT; i++) {
+    addLatencyHistogram(stages, bridgeStageToStr((BridgeStage)i), snap.stages[i]);
+  }
+
+  // End to end (rx -> tx) per priority class
+  JsonObject classes = doc.createNestedObject("latency_by_class_us");
+  for (uint8_t p = 0; p < BRIDGE_PRIO_COUNT; p++) {
+    addLatencyHistogram(classes, bridgePriorityToStr(p), snap.classes[p]);
+  }
+
+  BridgeReadCache& cache = BridgeReadCache::getInstance();
+  BridgeCacheStats cs = cache.getStats();
+  JsonObject c = doc.createNestedObject("cache");
+  c["enabled"] = cache.enabled();
+  c["window_ms"] = g_cfg.bridge_cache_ms;
+  c["hits"] = cs.hits;
+  c["misses"] = cs.misses;
+  c["stores"] = cs.stores;
+  c["invalidations"] = cs.invalidations;
+  c["flushes"] = cs.flushes;
+
+  String out;
+  serializeJson(doc, out);
+  server.send(200, "application/json", out);
+}
+
+// POST /api/bridge/stats/reset
+// Returns: { "success": true }
+void handleApiBridgeStatsReset(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+
+  BridgeStats::getInstance().requestReset();
+  server.send(200, "application/json", "{\"success\":true}");
+}
+
+static void sendBridgeCaptureStatus(WebServer& server) {
+  BridgeCaptureStatus st = bridgeCaptureGetStatus();
+  DynamicJsonDocument doc(384);
+  doc["active"] = st.active;
+  doc["target"] = bridgeCaptureTargetToStr(st.target);
+  doc["path"] = st.path;
+  doc["records"] = st.records;
+  doc["bytes"] = st.bytes;
+  doc["max_bytes"] = st.max_bytes;
+  doc["dropped"] = st.dropped;
+
+  String out;
+  serializeJson(doc, out);
+  server.send(200, "application/json", out);
+}
+
+// GET /api/bridge/capture
+// Returns: { active, target, path, records, bytes, max_bytes, dropped }
+void handleApiBridgeCapture(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+  sendBridgeCaptureStatus(server);
+}
+
+// POST /api/bridge/capture/start?target=littlefs|sd&max_kb=N
+// Returns: capture status, or 400/500 with an error message
+void handleApiBridgeCaptureStart(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+
+  BridgeCaptureTarget target = BridgeCaptureTarget::LITTLEFS;
+  if (server.hasArg("target")) {
+    String t = server.arg("target");
+    if (t == "sd") {
+      target = BridgeCaptureTarget::SD;
+    } else if (t != "littlefs") {
+      server.send(400, "text/plain", "Invalid target");
+      return;
+    }
+  }
+
+  int maxKb = DEFAULT_BRIDGE_CAPTURE_MAX_KB;
+  if (server.hasArg("max_kb")) maxKb = server.arg("max_kb").toInt();
+  if (!isValidRange(maxKb, 1, 65536)) {
+    server.send(400, "text/plain", "Invalid max_kb");
+    return;
+  }
+
+  String err;
+  if (!bridgeCaptureStart(target, (uint32_t)maxKb * 1024, err)) {
+    server.send(500, "text/plain", sanitizeError(err));
+    return;
+  }
+  sendBridgeCaptureStatus(server);
+}
+
+// POST /api/bridge/capture/stop
+// Returns: capture status
+void handleApiBridgeCaptureStop(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+
+  bridgeCaptureStop();
+  sendBridgeCaptureStatus(server);
+}
+
+// GET /api/bridge/capture/download
+// Returns: the current or last LittleFS capture file (SD captures stay on the card)
+void handleApiBridgeCaptureDownload(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+
+  BridgeCaptureStatus st = bridgeCaptureGetStatus();
+  if (st.active || st.target != BridgeCaptureTarget::LITTLEFS || st.path.length() == 0) {
+    server.send(409, "text/plain", "No finished LittleFS capture");
+    return;
+  }
+  File f = LittleFS.open(st.path, "r");
+  if (!f) {
+    server.send(404, "text/plain", "Not found");
+    return;
+  }
+  server.sendHeader("Content-Disposition", "attachment; filename=bridge.wbc");
+  server.streamFile(f, "application/octet-stream");
+  f.close();
+}
+
+// ===================================================================================
+// I2C TRACE API HANDLERS
+// ===================================================================================
+// GET /api/i2c/trace
+// Returns: the trace ring as a binary file (i2c_trace_format.h), oldest first.
+// Records appended while it streams are left for the next download.
+void handleApiI2cTrace(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+
+  I2cTrace& trace = I2cTrace::getInstance();
+  I2cTraceFileHeader hdr = {};
+  memcpy(hdr.magic, I2C_TRACE_MAGIC, sizeof(hdr.magic));
+  hdr.version = I2C_TRACE_VERSION;
+  hdr.record_size = sizeof(I2cTraceRecord);
+  hdr.depth = I2C_TRACE_DEPTH;
+  hdr.i2c_clock = Wire.getClock();
+  hdr.recorded = trace.recorded();
+
+  server.sendHeader("Content-Disposition", "attachment; filename=i2c.wbt");
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/octet-stream", "");
+  server.sendContent((const char*)&hdr, sizeof(hdr));
+
+  uint32_t cursor = hdr.recorded > I2C_TRACE_DEPTH ? hdr.recorded - I2C_TRACE_DEPTH : 0;
+  I2cTraceRecord chunk[16];
+  while (cursor != hdr.recorded) {
+    size_t n = trace.read(cursor, hdr.recorded, chunk, sizeof(chunk) / sizeof(chunk[0]));
+    if (n) server.sendContent((const char*)chunk, n * sizeof(I2cTraceRecord));
+  }
+  server.sendContent("");
+}
+
+// POST /api/i2c/trace/enable?on=0|1
+// Turns recording on or off until reboot (i2c_trace_enable sets the boot state)
+// Returns: { enabled, recorded, depth }
+void handleApiI2cTraceEnable(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+
+  if (!server.hasArg("on") || (server.arg("on") != "0" && server.arg("on") != "1")) {
+    server.send(400, "text/plain", "Invalid on");
+    return;
+  }
+  I2cTrace& trace = I2cTrace::getInstance();
+  trace.setEnabled(server.arg("on") == "1");
+
+  DynamicJsonDocument doc(128);
+  doc["enabled"] = trace.isEnabled();
+  doc["recorded"] = trace.recorded();
+  doc["depth"] = I2C_TRACE_DEPTH;
+  String out;
+  serializeJson(doc, out);
+  server.send(200, "application/json", out);
+}
+
+// ===================================================================================
+// DEEP SCAN API HANDLERS
+// ===================================================================================
+static void sendScanStatus(WebServer& server, int code) {
+  ScanJobStatus st = scanJobGetStatus();
+  DynamicJsonDocument doc(384);
+  doc["job"] = st.job;
+  doc["state"] = scanJobStateToStr(st.state);
+  doc["full"] = st.full;
+  doc["bus"] = i2cAddrBus(st.addr);
+  doc["addr"] = i2cAddr7(st.addr);
+  doc["progress"] = st.progress;
+  doc["devices"] = st.devices;
+  doc["elapsed_ms"] = st.elapsed_ms;
+  if (st.state == ScanJobState::ABORTED) {
+    doc["fault"] = i2cStatusToStr(st.fault);
+    doc["fault_addr"] = i2cAddr7(st.fault_addr);
+  }
+
+  String out;
+  serializeJson(doc, out);
+  server.send(code, "application/json", out);
+}
+
+// POST /api/scan/start[?full=1]
+// full=1 enumerates every pin mode; by default only the modes needed to name
+// the variant are probed.
+// Returns: 202 and the job status, or 409 while a scan is already running
+void handleApiScanStart(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+
+  bool full = server.hasArg("full") && server.arg("full") == "1";
+  if (scanJobStart(full)) {
+    sendScanStatus(server, 202);
+  } else if (scanJobGetStatus().state == ScanJobState::RUNNING) {
+    sendScanStatus(server, 409);
+  } else {
+    server.send(500, "text/plain", "Could not start scan task");
+  }
+}
+
+// GET /api/scan/status
+// Returns: { job, state, full, bus, addr, progress, devices, elapsed_ms[, fault, fault_addr] }
+void handleApiScanStatus(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+  sendScanStatus(server, 200);
+}
+
+// GET /api/scan/result
+// Returns: { job, state, full, devices: [ { bus, addr, wombat, boot, model, fw, variant,
+//            caps, caps_full, caps_cached, uuid, brand, voltage_mv, temp_c,
+//            frames, overflows, errors, birthday } ] } (devices found so far
+//            while running). Without caps_full, caps only covers the modes
+//            probed to name the variant.
+void handleApiScanResult(WebServer& server) {
+  if (!checkAuth(server)) return;
+  addSecurityHeaders(server);
+
+  // Snapshot before the devices so the list is never older than the state
+  ScanJobStatus st = scanJobGetStatus();
+  static ScanDevice devices[SCAN_JOB_MAX_DEVICES];
+  size_t count = scanJobGetDevices(devices, SCAN_JOB_MAX_DEVICES);
+
+  DynamicJsonDocument doc(16384);
+  doc["job"] = st.job;
+  doc["state"] = scanJobStateToStr(st.state);
+  doc["full"] = st.full;
+  JsonArray arr = doc.createNestedArray("devices");
+  for (size_t i = 0; i < count; i++) {
+    const ScanDevice& d = devices[i];
+    JsonObject o = arr.createNestedObject();
+    o["bus"] = i2cAddrBus(d.addr);
+    o["addr"] = i2cAddr7(d.addr);
+    o["wombat"] = d.wombat;
+    if (!d.wombat) continue;
+
+    char uuid[2 * sizeof(d.uuid) + 1];
+    for (size_t k = 0; k < d.uuid_len; k++)
+      snprintf(uuid + 2 * k, 3, "%02x", d.uuid[k]);
+    uuid[2 * d.uuid_len] = '\0';
+
+    o["boot"] = d.in_boot;
+    o["model"] = d.model;
+    o["fw"] = d.fw;
+    o["variant"] = d.variant;
+    if (d.caps_valid) {
+      JsonArray caps = o.createNestedArray("caps");
+      for (int pm = 0; pm < SW_PIN_MODE_COUNT; pm++)
+        if (d.caps.has(pm)) caps.add(pm);
+      o["caps_full"] = d.caps.complete();
+      o["caps_cached"] = d.caps_cached;
+    }
+    o["uuid"] = uuid;
+    o["brand"] = d.brand;
+    o["voltage_mv"] = d.voltage_mv;
+    if (d.has_temp) o["temp_c"] = d.temp_c100 / 100.0;
+    o["frames"] = d.frames;
+    o["overflows"] = d.overflows;
+    o["errors"] = d.errors;
+    o["birthday"] = d.birthday;
+  }
+
   String out;
   serializeJson(doc, out);
   server.send(200, "application/json", out);
@@ -11,6 +11,7 @@
 // ===================================================================================
 void handleRoot(WebServer& server);
 void handleScanner(WebServer& server);
+void handleDeepScan(WebServer& server);
 
 // ===================================================================================
 // WIFI AND SYSTEM HANDLERS
@@ -27,15 +28,11 @@ void handleUploadHexPost(WebServer& server);
 void handleUploadFW(WebServer& server);
 void handleFlashFW(WebServer& server);
 
-// ===================================================================================
-// TCP BRIDGE HANDLER
-// ===================================================================================
-void handleTcpBridge();
-
 // ===================================================================================
 // CONFIG API HANDLERS
 // ===================================================================================
 void handleApiVariant(WebServer& server);
+void handleApiVariantInvalidate(WebServer& server);
 void handleApiApply(WebServer& server);
 void handleConfigSave(WebServer& server);
 void handleConfigLoad(WebServer& server);
@@ -49,6 +46,30 @@ void handleConfigDelete(WebServer& server);
 void handleApiHealth(WebServer& server);
 void handleApiSystem(WebServer& server);
 
+// ===================================================================================
+// BRIDGE API HANDLERS
+// ===================================================================================
+void handleApiBridgeSessions(WebServer& server);
+void handleApiBridgeStats(WebServer& server);
+void handleApiBridgeStatsReset(WebServer& server);
+void handleApiBridgeCapture(WebServer& server);
+void handleApiBridgeCaptureStart(WebServer& server);
+void handleApiBridgeCaptureStop(WebServer& server);
+void handleApiBridgeCaptureDownload(WebServer& server);
+
+// ===================================================================================
+// I2C TRACE API HANDLERS
+// ===================================================================================
+void handleApiI2cTrace(WebServer& server);
+void handleApiI2cTraceEnable(WebServer& server);
+
+// ===================================================================================
+// DEEP SCAN API HANDLERS
+// ===================================================================================
+void handleApiScanStart(WebServer& server);
+void handleApiScanStatus(WebServer& server);
+void handleApiScanResult(WebServer& server);
+
 // ===================================================================================
 // MESSAGE CENTER API HANDLERS
 // ===================================================================================
@@ -268,6 +268,7 @@ const char INDEX_HTML_TAIL[] PROGMEM = R"rawliteral(
     <h3>Settings</h3>
     <form action="/connect" method="GET">
       <input type="text" name="addr" placeholder="Hex (e.g. 0x6C)"><br>
+      <select name="bus"><option value="0">Bus 0 (Wire)</option><option value="1">Bus 1 (Wire1)</option></select><br>
       <button type="submit">Connect to Address</button>
     </form>
     
@@ -584,6 +585,76 @@ const char SCANNER_HTML[] PROGMEM = R"rawliteral(
 </html>
 )rawliteral";
 
+const char DEEPSCAN_HTML[] PROGMEM = R"rawliteral(
+<!DOCTYPE HTML><html>
+<head>
+  <meta name="viewport" content="width=device-width, initial-scale=1">
+  <title>Serial Wombat Deep Scan</title>
+  <style>
+    body { font-family: monospace; background: #222; color: #eee; padding: 10px; }
+    .chip { border: 1px solid #0f0; padding: 10px; margin-bottom: 10px; background: #333; }
+    h3 { color: #00d2ff; margin: 0; }
+    b { color: #0f0; }
+    .modes { font-size: 0.8em; color: #aaa; }
+    .btn { display: block; padding: 10px; background: #007acc; color: white; text-align: center; text-decoration: none; margin-top: 20px; }
+  </style>
+</head>
+<body>
+  <h2>Serial Wombat Deep Scan</h2>
+  <div id="status">Starting scan...</div>
+  <div id="chips"></div>
+  <a href="/deepscan?full=1" class="btn">Rescan With All Pin Modes</a>
+  <a href="/" class="btn">Return to Dashboard</a>
+  <script>
+    const MODES = %PIN_MODES%;
+    const esc = s => String(s).replace(/[&<>'"]/g, c => '&#' + c.charCodeAt(0) + ';');
+    const hex = n => '0x' + n.toString(16);
+    const at = (bus, addr) => hex(addr) + (bus ? ' (bus ' + bus + ')' : '');
+
+    function chipHtml(d) {
+      let h = "<div class='chip'><h3>Device @ " + at(d.bus, d.addr) + "</h3>";
+      if (!d.wombat) return h + "Unknown I2C Device</div>";
+      h += "<b>Serial Wombat Found!</b><br>";
+      h += d.boot ? "STATUS: <b style='color:orange'>BOOT MODE</b><br>" : "STATUS: <b>APP MODE</b><br>";
+      h += "Model: " + esc(d.model) + "<br>FW Version: " + esc(d.fw) + "<br>";
+      h += "<b>Variant: <span style='color:#0ff'>" + esc(d.variant) + "</span></b><br><br>";
+      h += "Uptime: " + d.frames + " frames<br>Overflows: " + d.overflows + "<br>";
+      h += "Errors: " + d.errors + "<br>Birthday: " + d.birthday + "<br>";
+      h += "Brand: " + esc(d.brand) + "<br>UUID: " + esc(d.uuid) + "<br>";
+      h += "Voltage: " + d.voltage_mv + " mV<br>";
+      if (d.temp_c !== undefined) h += "Temp: " + d.temp_c.toFixed(2) + " C<br>";
+      if (d.caps) {
+        h += "<br><b>" + (d.caps_full ? "Supported Pin Modes" : "Pin Modes Found While Classifying");
+        h += (d.caps_cached ? " (cached)" : "") + ":</b><br>";
+        h += "<span class='modes'>" + d.caps.map(pm => MODES[pm] || pm).join(', ') + "</span>";
+      }
+      return h + "</div>";
+    }
+
+    async function render() {
+      const r = await (await fetch('/api/scan/result')).json();
+      document.getElementById('chips').innerHTML = r.devices.map(chipHtml).join('');
+    }
+
+    async function poll() {
+      const st = await (await fetch('/api/scan/status')).json();
+      let text = 'Scanning ' + at(st.bus, st.addr) + ' (' + st.progress + '%), ' + st.devices + ' found';
+      if (st.state === 'done') text = 'Scan complete: ' + st.devices + ' devices in ' + st.elapsed_ms + ' ms';
+      if (st.state === 'aborted') text = 'Bus fault at ' + at(st.bus, st.fault_addr) + ': ' + st.fault + ' (scan aborted)';
+      document.getElementById('status').textContent = text;
+      await render();
+      if (st.state === 'running') setTimeout(poll, 500);
+    }
+
+    const full = new URLSearchParams(location.search).get('full') === '1';
+    fetch('/api/scan/start' + (full ? '?full=1' : ''), {method: 'POST'}).then(poll).catch(e => {
+      document.getElementById('status').textContent = 'Scan failed: ' + e;
+    });
+  </script>
+</body>
+</html>
+)rawliteral";
+
 // ===================================================================================
 // --- HTML: Configurator (secondary tab) ---
 // ===================================================================================
@@ -9,6 +9,7 @@ extern const char SD_FW_OPTION_HTML[] PROGMEM;
 extern const char SD_FW_AREA_HTML[] PROGMEM;
 extern const char SD_TILE_HTML[] PROGMEM;
 extern const char SCANNER_HTML[] PROGMEM;
+extern const char DEEPSCAN_HTML[] PROGMEM;
 extern const char CONFIG_HTML[] PROGMEM;
 extern const char SETTINGS_HTML[] PROGMEM;
 extern const char MESSAGES_HTML[] PROGMEM;
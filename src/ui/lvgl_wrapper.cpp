@@ -7,6 +7,7 @@
 #  include <time.h>
 
 #  include "../../hal/display/lgfx_display.h"
+#  include "../core/i2c_monitor.h"
 #  include "components/statusbar.h"
 
 // Forward declarations for functions still in main .ino
@@ -167,11 +168,13 @@ void lvglTickAndUpdate() {
     lv_label_set_text(g_lbl_rssi, buf);
   }
 
-  // I2C traffic
+  // I2C traffic: transactions/s and utilization of the busiest bus
   if (g_lbl_i2c) {
+    const I2cMonitorRates& rates = i2cMonitorGetRates();
+    uint16_t util = 0;
+    for (uint16_t u : rates.util_permille) util = u > util ? u : util;
     char buf[32];
-    snprintf(buf, sizeof(buf), "I2C: %lu/%lu", (unsigned long)g_i2c_tx_count,
-             (unsigned long)g_i2c_rx_count);
+    snprintf(buf, sizeof(buf), "I2C: %lu/s %u%%", (unsigned long)rates.tx_per_sec, util / 10);
     lv_label_set_text(g_lbl_i2c, buf);
   }
 
@@ -0,0 +1,607 @@
+/*
+ * Bridge Load Generator
+ *
+ * Opens several TCP connections to a bridge, keeps a window of legacy 8-byte
+ * frames in flight on each, and reports frames/s and round-trip latency
+ * percentiles.
+ *
+ * Without --target it runs the firmware's TCP bridge in-process: the real
+ * tcp_bridge, bridge engine and I2C engine sources built against the host
+ * shims (tools/host), with the bus answered by a simulated SerialWombat
+ * (sim_wombat.h). Bridge performance changes can then be measured on any
+ * Linux/macOS machine, CI included:
+ *
+ *   bridge_loadgen [--target HOST[:PORT]] [--port P] [--connections N]
+ *                  [--duration S] [--window W] [--mix SPEC] [--clock HZ]
+ *                  [--batch N] [--cache MS] [--queue HIGH,LOW] [--nack PERMILLE]
+ *                  [--priority N] [--buses N] [--trace FILE] [--min-fps F]
+ *
+ *   --target     Drive an external bridge (e.g. a device) instead
+ *   --port       Port of the in-process bridge (default 3000)
+ *   --connections  Concurrent clients (default 4; the bridge accepts
+ *                  BRIDGE_MAX_SESSIONS and rejects the rest)
+ *   --duration   Seconds to send for (default 5)
+ *   --window     Frames in flight per connection (default 4)
+ *   --mix        Frame mix by weight, e.g. read=70,write=20,version=10,control=0
+ *                read/write: pin public data (0x81/0x82), version: 'V',
+ *                control: bridge NOP control frame (answered without the bus)
+ *   --clock      Simulated bus clock in Hz (default 100000)
+ *   --batch      Frames per dispatch cycle (default 16, as on the device)
+ *   --cache      Read cache staleness window in ms (default 0, off)
+ *   --queue      Flow control watermarks in frames (default 24,8, as on the device)
+ *   --nack       Simulated transfer attempts that NACK, per mille (default 0);
+ *                exercises the I2C engine's retries and the bridge error frame
+ *   --priority   The first N connections switch their session to HIGH priority
+ *                (SET_PRIORITY) and keep one frame in flight, like an
+ *                interactive client next to bulk traffic (default 0)
+ *   --buses      2 also runs the secondary bus engine: every other connection
+ *                switches to protocol v2 (SET_MODE) and addresses the same
+ *                SerialWombat on bus 1 (default 1)
+ *   --trace      Write the in-process I2C trace ring to FILE at the end, as
+ *                served by /api/i2c/trace (read it with tools/i2c_trace_dump)
+ *   --min-fps    Exit with status 1 when throughput is below F (CI gate)
+ */
+
+#include <Arduino.h>
+#include <WiFiServer.h>
+#include <Wire.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../src/services/i2c_manager/i2c_clock.h"
+#include "../../src/services/i2c_manager/i2c_engine.h"
+#include "../../src/services/i2c_manager/i2c_trace.h"
+#include "../../src/services/tcp_bridge/bridge_cache.h"
+#include "../../src/services/tcp_bridge/bridge_engine.h"
+#include "../../src/services/tcp_bridge/bridge_stats.h"
+#include "../../src/services/tcp_bridge/tcp_bridge.h"
+#include "../host/sim_wombat.h"
+
+// Firmware defaults for bridge_max_batch, bridge_queue_high and
+// bridge_queue_low (config/defaults.h)
+#define LOADGEN_DEFAULT_BATCH 16
+#define LOADGEN_DEFAULT_QUEUE_HIGH 24
+#define LOADGEN_DEFAULT_QUEUE_LOW 8
+
+// SerialWombat address served by the in-process bridge
+#define LOADGEN_WOMBAT_ADDR 0x6B
+
+// A response slower than this ends the connection
+#define LOADGEN_RECV_TIMEOUT_MS 2000
+
+enum FrameKind { FRAME_READ = 0, FRAME_WRITE, FRAME_VERSION, FRAME_CONTROL, FRAME_KINDS };
+
+static const char* const frameKindNames[FRAME_KINDS] = {"read", "write", "version", "control"};
+
+struct LoadgenOptions {
+  const char* target = nullptr;
+  uint16_t port = TCP_PORT;
+  int connections = 4;
+  double duration = 5.0;
+  int window = 4;
+  uint32_t mix[FRAME_KINDS] = {70, 20, 10, 0};
+  uint32_t clock = 100000;
+  int batch = LOADGEN_DEFAULT_BATCH;
+  uint32_t cache_ms = 0;
+  int queue_high = LOADGEN_DEFAULT_QUEUE_HIGH;
+  int queue_low = LOADGEN_DEFAULT_QUEUE_LOW;
+  uint16_t nack_permille = 0;
+  int priority = 0;
+  int buses = 1;
+  const char* trace = nullptr;
+  double min_fps = 0;
+};
+
+// Per-connection results
+struct ConnResult {
+  bool connected = false;
+  bool rejected = false;  // Closed by the bridge before any response
+  bool high = false;      // Session switched to BRIDGE_PRIO_HIGH
+  bool v2 = false;        // Session switched to protocol v2, frames for bus 1
+  uint32_t frames = 0;
+  uint32_t mismatches = 0;  // Response did not echo the request's command byte
+  uint32_t bus_errors = 0;  // Bridge error frames (transfer failed after retries)
+  BridgeHistogram rtt;
+};
+
+// ===================================================================================
+// In-process bridge (mirrors the firmware's bridge_io task)
+// ===================================================================================
+static WiFiServer* s_server = nullptr;
+static size_t s_batch = LOADGEN_DEFAULT_BATCH;
+
+static void bridgeHostTask(void* arg) {
+  (void)arg;
+  BridgeEngine& engine = BridgeEngine::getInstance();
+  BridgeStats& stats = BridgeStats::getInstance();
+
+  for (;;) {
+    stats.poll();
+    engine.collect();
+    size_t received = handleTcpBridge(*s_server);
+
+    engine.dispatch(LOADGEN_WOMBAT_ADDR, s_batch);
+
+    if (engine.inflight() > 0) {
+      ulTaskNotifyTake(pdTRUE, 1);
+    } else if (received == 0) {
+      vTaskDelay(1);
+    }
+  }
+}
+
+static bool startHostBridge(const LoadgenOptions& opt) {
+  Wire.begin();
+  I2cClockController::getInstance().begin(opt.clock, false, LOADGEN_WOMBAT_ADDR);
+  BridgeReadCache::getInstance().configure(opt.cache_ms);
+  BridgeEngine::getInstance().setWatermarks(opt.queue_high, opt.queue_low);
+  simWombatSetStableClock(0, opt.nack_permille);
+  I2cTrace::getInstance().setEnabled(true);
+  s_batch = bridgeClampBatch(opt.batch);
+
+  s_server = new WiFiServer(opt.port);
+  if (!initTcpBridge(*s_server, opt.port)) {
+    fprintf(stderr, "cannot listen on port %u\n", opt.port);
+    return false;
+  }
+  if (!I2cEngine::getInstance().begin(0, 10)) return false;
+  if (opt.buses > 1 && !I2cEngine::getInstance(I2C_BUS_SECONDARY_PORT).begin(0, 10)) return false;
+
+  TaskHandle_t task = nullptr;
+  if (xTaskCreatePinnedToCore(bridgeHostTask, "bridge_io", 4096, nullptr, 5, &task, 0) !=
+      pdPASS) {
+    return false;
+  }
+  return BridgeEngine::getInstance().begin(task);
+}
+
+// ===================================================================================
+// Clients
+// ===================================================================================
+static int connectTo(const std::string& host, uint16_t port) {
+  struct addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  struct addrinfo* res = nullptr;
+  if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &res) != 0) return -1;
+
+  int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+  if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) < 0) {
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(res);
+  if (fd < 0) return -1;
+
+  int one = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  struct timeval tv = {LOADGEN_RECV_TIMEOUT_MS / 1000, (LOADGEN_RECV_TIMEOUT_MS % 1000) * 1000};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  return fd;
+}
+
+static bool recvAll(int fd, uint8_t* buf, size_t len) {
+  size_t got = 0;
+  while (got < len) {
+    ssize_t n = recv(fd, buf + got, len - got, 0);
+    if (n <= 0) return false;
+    got += n;
+  }
+  return true;
+}
+
+static uint32_t nextRandom(uint32_t& state) {
+  // xorshift32
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+static FrameKind pickKind(const LoadgenOptions& opt, uint32_t total, uint32_t& rng) {
+  uint32_t r = nextRandom(rng) % total;
+  for (int k = 0; k < FRAME_KINDS; k++) {
+    if (r < opt.mix[k]) return (FrameKind)k;
+    r -= opt.mix[k];
+  }
+  return FRAME_READ;
+}
+
+static void buildFrame(FrameKind kind, uint32_t& rng, uint8_t* f) {
+  memset(f, 0x55, BRIDGE_FRAME_SIZE);
+  uint8_t pin = nextRandom(rng) % SIM_WOMBAT_PINS;
+  switch (kind) {
+    case FRAME_READ:
+      f[0] = 0x81;
+      f[1] = pin;
+      break;
+    case FRAME_WRITE: {
+      uint16_t v = nextRandom(rng);
+      f[0] = 0x82;
+      f[1] = pin;
+      f[2] = v & 0xFF;
+      f[3] = v >> 8;
+      break;
+    }
+    case FRAME_VERSION:
+      f[0] = 'V';
+      break;
+    default: {
+      const uint8_t nop[BRIDGE_FRAME_SIZE] = {BRIDGE_CTRL_MAGIC0, BRIDGE_CTRL_MAGIC1,
+                                              BRIDGE_CTRL_MAGIC2, BRIDGE_CTRL_NOP};
+      memcpy(f, nop, BRIDGE_FRAME_SIZE);
+      break;
+    }
+  }
+}
+
+// Legacy control request; returns the control status, or -1 when the bridge closed
+static int sendControl(int fd, uint8_t op, uint8_t a) {
+  const uint8_t req[BRIDGE_FRAME_SIZE] = {BRIDGE_CTRL_MAGIC0, BRIDGE_CTRL_MAGIC1,
+                                          BRIDGE_CTRL_MAGIC2, op, a};
+  uint8_t resp[BRIDGE_FRAME_SIZE];
+  if (send(fd, req, sizeof(req), MSG_NOSIGNAL) != (ssize_t)sizeof(req) ||
+      !recvAll(fd, resp, sizeof(resp))) {
+    return -1;
+  }
+  return resp[4];
+}
+
+// Send one 8-byte frame, legacy or wrapped in a v2 header for the bus 1 chip
+static bool sendFrame(int fd, bool v2, uint16_t tag, const uint8_t* frame) {
+  uint8_t buf[BRIDGE_V2_HDR_SIZE + BRIDGE_FRAME_SIZE];
+  size_t len = 0;
+  if (v2) {
+    bool control = frame[0] == BRIDGE_CTRL_MAGIC0;
+    buf[len++] = control ? BRIDGE_V2_CTRL_ADDR
+                         : i2cAddrOnBus(I2C_BUS_SECONDARY_PORT, LOADGEN_WOMBAT_ADDR);
+    buf[len++] = tag & 0xFF;
+    buf[len++] = tag >> 8;
+    buf[len++] = BRIDGE_FRAME_SIZE;
+    buf[len++] = BRIDGE_FRAME_SIZE;
+  }
+  memcpy(buf + len, frame, BRIDGE_FRAME_SIZE);
+  len += BRIDGE_FRAME_SIZE;
+  return send(fd, buf, len, MSG_NOSIGNAL) == (ssize_t)len;
+}
+
+// Receive one response; status is the I2C status (v2) or 0/3 from the error marker (legacy)
+static bool recvResponse(int fd, bool v2, uint8_t& status, uint8_t* resp) {
+  memset(resp, 0, BRIDGE_FRAME_SIZE);
+  if (!v2) {
+    if (!recvAll(fd, resp, BRIDGE_FRAME_SIZE)) return false;
+    status = resp[0] == BRIDGE_ERR_MARKER ? (uint8_t)I2cStatus::BUS_ERROR : 0;
+    return true;
+  }
+  uint8_t hdr[BRIDGE_V2_HDR_SIZE];
+  uint8_t payload[BRIDGE_V2_MAX_PAYLOAD];
+  if (!recvAll(fd, hdr, sizeof(hdr)) || hdr[4] > sizeof(payload) ||
+      !recvAll(fd, payload, hdr[4])) {
+    return false;
+  }
+  status = hdr[3];
+  memcpy(resp, payload, hdr[4] < BRIDGE_FRAME_SIZE ? hdr[4] : BRIDGE_FRAME_SIZE);
+  return true;
+}
+
+static void runConnection(const LoadgenOptions& opt, const std::string& host, uint16_t port,
+                          int index, uint32_t deadlineMs, ConnResult& out) {
+  out.rtt.clear();
+  int fd = connectTo(host, port);
+  if (fd < 0) return;
+  out.connected = true;
+
+  size_t window = opt.window;
+  if (index < opt.priority) {
+    int status = sendControl(fd, BRIDGE_CTRL_SET_PRIORITY, BRIDGE_PRIO_HIGH);
+    if (status < 0) {
+      out.rejected = true;
+      close(fd);
+      return;
+    }
+    out.high = status == BRIDGE_CTRL_OK;
+    window = 1;
+  }
+  if (opt.buses > 1 && index % 2 == 1) {
+    int status = sendControl(fd, BRIDGE_CTRL_SET_MODE, BRIDGE_PROTO_V2);
+    if (status < 0) {
+      out.rejected = true;
+      close(fd);
+      return;
+    }
+    out.v2 = status == BRIDGE_CTRL_OK;
+  }
+
+  uint32_t total = 0;
+  for (int k = 0; k < FRAME_KINDS; k++) total += opt.mix[k];
+  uint32_t rng = 0x9E3779B9u ^ (uint32_t)(index + 1) * 2654435761u;
+
+  // Responses come back in request order, so a FIFO pairs them with sends
+  std::vector<uint32_t> sentUs(window);
+  std::vector<uint8_t> sentCmd(window);
+  size_t head = 0;
+  size_t outstanding = 0;
+
+  for (;;) {
+    bool sending = millis() < deadlineMs;
+    while (sending && outstanding < window) {
+      uint8_t frame[BRIDGE_FRAME_SIZE];
+      buildFrame(pickKind(opt, total, rng), rng, frame);
+      size_t at = (head + outstanding) % window;
+      sentUs[at] = micros();
+      sentCmd[at] = frame[0];
+      if (!sendFrame(fd, out.v2, (uint16_t)(out.frames + outstanding), frame)) {
+        sending = false;
+        break;
+      }
+      outstanding++;
+    }
+    if (outstanding == 0) break;
+
+    uint8_t resp[BRIDGE_FRAME_SIZE];
+    uint8_t status = 0;
+    if (!recvResponse(fd, out.v2, status, resp)) {
+      out.rejected = out.frames == 0;
+      break;
+    }
+    out.rtt.record(micros() - sentUs[head]);
+    if (status != 0 && sentCmd[head] != BRIDGE_CTRL_MAGIC0) {
+      out.bus_errors++;
+    } else if (resp[0] != sentCmd[head]) {
+      out.mismatches++;
+    }
+    out.frames++;
+    head = (head + 1) % window;
+    outstanding--;
+  }
+  close(fd);
+}
+
+// ===================================================================================
+// Reporting
+// ===================================================================================
+static void printHistogram(const char* name, const BridgeHistogram& h) {
+  printf("%-10s %8llu %8u %8u %8u %8u\n", name,
+         h.count ? (unsigned long long)(h.sum_us / h.count) : 0ULL, h.percentile(50),
+         h.percentile(90), h.percentile(99), h.max_us);
+}
+
+static void mergeHistogram(BridgeHistogram& into, const BridgeHistogram& h) {
+  for (size_t i = 0; i < BRIDGE_HIST_BUCKETS; i++) into.buckets[i] += h.buckets[i];
+  into.count += h.count;
+  into.sum_us += h.sum_us;
+  if (h.max_us > into.max_us) into.max_us = h.max_us;
+}
+
+// ===================================================================================
+// Entry point
+// ===================================================================================
+static bool parseMix(const char* spec, uint32_t* mix) {
+  uint32_t parsed[FRAME_KINDS] = {0};
+  std::string s(spec);
+  size_t pos = 0;
+  while (pos < s.size()) {
+    size_t end = s.find(',', pos);
+    if (end == std::string::npos) end = s.size();
+    std::string item = s.substr(pos, end - pos);
+    size_t eq = item.find('=');
+    if (eq == std::string::npos) return false;
+
+    int kind = -1;
+    for (int k = 0; k < FRAME_KINDS; k++) {
+      if (item.compare(0, eq, frameKindNames[k]) == 0) kind = k;
+    }
+    if (kind < 0) return false;
+    parsed[kind] = (uint32_t)strtoul(item.c_str() + eq + 1, nullptr, 10);
+    pos = end + 1;
+  }
+
+  uint32_t total = 0;
+  for (int k = 0; k < FRAME_KINDS; k++) total += parsed[k];
+  if (total == 0) return false;
+  memcpy(mix, parsed, sizeof(parsed));
+  return true;
+}
+
+static bool parseArgs(int argc, char** argv, LoadgenOptions& opt) {
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    if (i + 1 >= argc) return false;
+    const char* v = argv[++i];
+    if (strcmp(a, "--target") == 0) {
+      opt.target = v;
+    } else if (strcmp(a, "--port") == 0) {
+      opt.port = (uint16_t)atoi(v);
+    } else if (strcmp(a, "--connections") == 0) {
+      opt.connections = atoi(v);
+    } else if (strcmp(a, "--duration") == 0) {
+      opt.duration = atof(v);
+    } else if (strcmp(a, "--window") == 0) {
+      opt.window = atoi(v);
+    } else if (strcmp(a, "--mix") == 0) {
+      if (!parseMix(v, opt.mix)) return false;
+    } else if (strcmp(a, "--clock") == 0) {
+      opt.clock = (uint32_t)strtoul(v, nullptr, 10);
+    } else if (strcmp(a, "--batch") == 0) {
+      opt.batch = atoi(v);
+    } else if (strcmp(a, "--cache") == 0) {
+      opt.cache_ms = (uint32_t)strtoul(v, nullptr, 10);
+    } else if (strcmp(a, "--queue") == 0) {
+      if (sscanf(v, "%d,%d", &opt.queue_high, &opt.queue_low) != 2) return false;
+    } else if (strcmp(a, "--nack") == 0) {
+      opt.nack_permille = (uint16_t)atoi(v);
+    } else if (strcmp(a, "--priority") == 0) {
+      opt.priority = atoi(v);
+    } else if (strcmp(a, "--buses") == 0) {
+      opt.buses = atoi(v);
+    } else if (strcmp(a, "--trace") == 0) {
+      opt.trace = v;
+    } else if (strcmp(a, "--min-fps") == 0) {
+      opt.min_fps = atof(v);
+    } else {
+      return false;
+    }
+  }
+  return opt.connections > 0 && opt.window > 0 && opt.duration > 0 && opt.buses >= 1 &&
+         opt.buses <= I2C_BUS_COUNT;
+}
+
+static void usage() {
+  fprintf(stderr,
+          "usage: bridge_loadgen [--target HOST[:PORT]] [--port P] [--connections N]\n"
+          "                      [--duration S] [--window W] [--mix read=70,write=20,...]\n"
+          "                      [--clock HZ] [--batch N] [--cache MS] [--queue HIGH,LOW]\n"
+          "                      [--nack PERMILLE] [--priority N] [--buses N] [--trace FILE]\n"
+          "                      [--min-fps F]\n");
+}
+
+// Same file as /api/i2c/trace
+static bool writeTrace(const char* path) {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+
+  I2cTrace& trace = I2cTrace::getInstance();
+  I2cTraceFileHeader hdr = {};
+  memcpy(hdr.magic, I2C_TRACE_MAGIC, sizeof(hdr.magic));
+  hdr.version = I2C_TRACE_VERSION;
+  hdr.record_size = sizeof(I2cTraceRecord);
+  hdr.depth = I2C_TRACE_DEPTH;
+  hdr.i2c_clock = Wire.getClock();
+  hdr.recorded = trace.recorded();
+  bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+
+  uint32_t cursor = hdr.recorded > I2C_TRACE_DEPTH ? hdr.recorded - I2C_TRACE_DEPTH : 0;
+  I2cTraceRecord chunk[16];
+  while (ok && cursor != hdr.recorded) {
+    size_t n = trace.read(cursor, hdr.recorded, chunk, sizeof(chunk) / sizeof(chunk[0]));
+    ok = fwrite(chunk, sizeof(I2cTraceRecord), n, f) == n;
+  }
+  return fclose(f) == 0 && ok;
+}
+
+// Threads keep running in the bridge and I2C engine; leave without running
+// static destructors underneath them
+static void finish(int status) {
+  fflush(stdout);
+  fflush(stderr);
+  _exit(status);
+}
+
+int main(int argc, char** argv) {
+  LoadgenOptions opt;
+  if (!parseArgs(argc, argv, opt)) {
+    usage();
+    finish(2);
+  }
+
+  std::string host = "127.0.0.1";
+  uint16_t port = opt.port;
+  if (opt.target) {
+    host = opt.target;
+    size_t colon = host.rfind(':');
+    if (colon != std::string::npos) {
+      port = (uint16_t)atoi(host.c_str() + colon + 1);
+      host.resize(colon);
+    }
+  } else if (!startHostBridge(opt)) {
+    fprintf(stderr, "in-process bridge failed to start\n");
+    finish(1);
+  }
+
+  std::vector<ConnResult> results(opt.connections);
+  std::vector<std::thread> threads;
+  uint32_t startUs = micros();
+  uint32_t deadlineMs = millis() + (uint32_t)(opt.duration * 1000);
+  for (int i = 0; i < opt.connections; i++) {
+    threads.emplace_back(runConnection, std::cref(opt), std::cref(host), port, i, deadlineMs,
+                         std::ref(results[i]));
+  }
+  for (auto& t : threads) t.join();
+  uint32_t wallUs = micros() - startUs;
+
+  BridgeHistogram rtt;
+  BridgeHistogram rttByClass[BRIDGE_PRIO_COUNT];
+  rtt.clear();
+  for (auto& h : rttByClass) h.clear();
+  uint32_t frames = 0;
+  uint32_t mismatches = 0;
+  uint32_t busErrors = 0;
+  int served = 0;
+  int rejected = 0;
+  int failed = 0;
+  for (const auto& r : results) {
+    if (!r.connected) {
+      failed++;
+    } else if (r.rejected) {
+      rejected++;
+    } else {
+      served++;
+    }
+    frames += r.frames;
+    mismatches += r.mismatches;
+    busErrors += r.bus_errors;
+    mergeHistogram(rtt, r.rtt);
+    mergeHistogram(rttByClass[r.high ? BRIDGE_PRIO_HIGH : BRIDGE_PRIO_NORMAL], r.rtt);
+  }
+  double fps = wallUs ? frames * 1e6 / wallUs : 0.0;
+
+  if (opt.target) {
+    printf("target       %s:%u\n", host.c_str(), port);
+  } else {
+    printf("target       %s:%u (in-process, %s backend)\n", host.c_str(), port,
+           tcpBridgeBackendName());
+  }
+  printf("connections  %d served, %d rejected, %d failed\n", served, rejected, failed);
+  printf("mix          read=%u write=%u version=%u control=%u, window %d\n", opt.mix[FRAME_READ],
+         opt.mix[FRAME_WRITE], opt.mix[FRAME_VERSION], opt.mix[FRAME_CONTROL], opt.window);
+  printf("frames       %u in %.3f s (%.0f frames/s), %u mismatched, %u bus errors\n", frames,
+         wallUs / 1e6, fps, mismatches, busErrors);
+  printf("\n%-10s %8s %8s %8s %8s %8s\n", "latency_us", "mean", "p50", "p90", "p99", "max");
+  printHistogram("rtt", rtt);
+  if (opt.priority > 0) {
+    printHistogram("rtt_normal", rttByClass[BRIDGE_PRIO_NORMAL]);
+    printHistogram("rtt_high", rttByClass[BRIDGE_PRIO_HIGH]);
+  }
+
+  if (!opt.target) {
+    BridgeStatsSnapshot snap;
+    BridgeStats::getInstance().snapshot(snap);
+    for (size_t i = 0; i < (size_t)BridgeStage::COUNT; i++) {
+      printHistogram(bridgeStageToStr((BridgeStage)i), snap.stages[i]);
+    }
+    if (opt.priority > 0) {
+      printHistogram("total_norm", snap.classes[BRIDGE_PRIO_NORMAL]);
+      printHistogram("total_high", snap.classes[BRIDGE_PRIO_HIGH]);
+    }
+    SimWombatStats bus = simWombatGetStats();
+    BridgeCacheStats cache = BridgeReadCache::getInstance().getStats();
+    printf("\nbus          %u transfers at %u Hz, %.1f%% busy (per bus)\n", bus.transfers,
+           opt.clock, wallUs ? bus.bus_us * 100.0 / wallUs / opt.buses : 0.0);
+    printf("cache        %u hits, %u misses\n", cache.hits, cache.misses);
+
+    I2cErrorCounters ec;
+    I2cEngine::getInstance().getErrorCounters(ec);
+    printf("i2c          %u attempts, %u nacks, %u retries, %u recovered, %u failed\n",
+           ec.attempts, ec.nacks, ec.retries, ec.recovered, ec.failed);
+    if (opt.buses > 1) {
+      I2cEngine::getInstance(I2C_BUS_SECONDARY_PORT).getErrorCounters(ec);
+      printf("i2c bus 1    %u attempts, %u nacks, %u retries, %u recovered, %u failed\n",
+             ec.attempts, ec.nacks, ec.retries, ec.recovered, ec.failed);
+    }
+  }
+
+  if (opt.trace && !opt.target && !writeTrace(opt.trace)) {
+    fprintf(stderr, "cannot write %s\n", opt.trace);
+    finish(1);
+  }
+
+  bool ok = frames > 0 && mismatches == 0 && failed == 0 && fps >= opt.min_fps;
+  finish(ok ? 0 : 1);
+}
@@ -0,0 +1,34 @@
+#!/bin/sh
+# Build the bridge load generator for the host (Linux/macOS, g++ or clang++).
+# Same sources as the PlatformIO "native" environment (pio run -e native).
+#   ./build.sh                  -> ./bridge_loadgen (WiFiClient backend)
+#   BACKEND=sockets ./build.sh  -> ./bridge_loadgen_sockets (lwIP socket backend)
+#   CXX=clang++ ./build.sh
+set -e
+cd "$(dirname "$0")"
+
+OUT=bridge_loadgen
+FLAGS=
+if [ "$BACKEND" = "sockets" ]; then
+  OUT=bridge_loadgen_sockets
+  FLAGS=-DBRIDGE_TCP_BACKEND=2
+fi
+
+SRC=../../src
+${CXX:-g++} -std=gnu++17 -O2 -Wall -pthread -I../host $FLAGS \
+  bridge_loadgen.cpp \
+  ../host/host_rtos.cpp \
+  ../host/host_wifi.cpp \
+  ../host/sim_wombat.cpp \
+  $SRC/services/tcp_bridge/tcp_bridge.cpp \
+  $SRC/services/tcp_bridge/tcp_bridge_sockets.cpp \
+  $SRC/services/tcp_bridge/bridge_engine.cpp \
+  $SRC/services/tcp_bridge/bridge_macro.cpp \
+  $SRC/services/tcp_bridge/bridge_cache.cpp \
+  $SRC/services/tcp_bridge/bridge_capture.cpp \
+  $SRC/services/tcp_bridge/bridge_stats.cpp \
+  $SRC/services/i2c_manager/i2c_engine.cpp \
+  $SRC/services/i2c_manager/i2c_clock.cpp \
+  $SRC/services/i2c_manager/i2c_trace.cpp \
+  $SRC/core/i2c_monitor.cpp \
+  -o $OUT
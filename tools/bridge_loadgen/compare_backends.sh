@@ -0,0 +1,18 @@
+#!/bin/sh
+# Run the same load against both TCP bridge socket backends and print their
+# results one after the other. Control frames are answered without the bus,
+# so the default mix measures the socket path rather than the I2C clock.
+#   ./compare_backends.sh [loadgen options...]
+set -e
+cd "$(dirname "$0")"
+
+./build.sh
+BACKEND=sockets ./build.sh
+
+ARGS=${*:-"--duration 5 --connections 4 --window 8 --mix control=100"}
+for bin in bridge_loadgen bridge_loadgen_sockets; do
+  echo "=== $bin"
+  # shellcheck disable=SC2086
+  ./$bin $ARGS
+  echo
+done
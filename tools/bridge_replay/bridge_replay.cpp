@@ -0,0 +1,327 @@
+/*
+ * Bridge Replay
+ *
+ * Replays a bridge traffic capture (/api/bridge/capture) through the real
+ * bridge engine, read cache and I2C engine on the host, against a simulated
+ * SerialWombat (tools/host/sim_wombat.h) that answers with the recorded
+ * responses. Use it to measure arbitration, batching and cache changes
+ * against real client traffic without hardware:
+ *
+ *   bridge_replay capture.wbc [--speed X] [--model] [--clock HZ]
+ *                             [--batch N] [--cache MS]
+ *
+ *   --speed X   Pace requests at X times the recorded rate; 0 sends them as
+ *               fast as the session rings accept them (default 1)
+ *   --model     Time every transfer with the bus model instead of the
+ *               recorded bus times
+ *   --clock HZ  Bus clock for the model (default: clock in the capture)
+ *   --batch N   Frames per dispatch cycle (default 16, as on the device)
+ *   --cache MS  Read cache staleness window (default 0, off)
+ *
+ * The tool plays the bridge I/O task: it feeds captured request bytes into
+ * each session as a transport would, dispatches, collects, and "sends" every
+ * response immediately, then prints throughput and the BridgeStats
+ * percentiles.
+ */
+
+#include <Arduino.h>
+
+#include <map>
+#include <vector>
+
+#include "../../src/services/i2c_manager/i2c_engine.h"
+#include "../../src/services/tcp_bridge/bridge_cache.h"
+#include "../../src/services/tcp_bridge/bridge_capture_format.h"
+#include "../../src/services/tcp_bridge/bridge_engine.h"
+#include "../../src/services/tcp_bridge/bridge_stats.h"
+#include "../host/Wire.h"
+#include "../host/sim_wombat.h"
+
+// Firmware default for bridge_max_batch (config/defaults.h)
+#define REPLAY_DEFAULT_BATCH 16
+
+struct ReplayRequest {
+  uint64_t at_us;  // Offset from the first request
+  uint8_t session;
+  uint8_t addr;
+  bool v2;
+  uint8_t bytes[BRIDGE_V2_HDR_SIZE + BRIDGE_CAPTURE_MAX_PAYLOAD];
+  uint8_t len;  // Bytes as sent by the client
+};
+
+struct ReplayOptions {
+  const char* path = nullptr;
+  double speed = 1.0;
+  bool model = false;
+  uint32_t clock = 0;
+  int batch = REPLAY_DEFAULT_BATCH;
+  uint32_t cache_ms = 0;
+};
+
+// ===================================================================================
+// Capture loading
+// ===================================================================================
+static bool readRecord(FILE* f, BridgeCaptureRecordHeader& hdr, uint8_t* payload) {
+  if (fread(&hdr, sizeof(hdr), 1, f) != 1) return false;
+  if (hdr.len > BRIDGE_CAPTURE_MAX_PAYLOAD) return false;
+  return fread(payload, 1, hdr.len, f) == hdr.len;
+}
+
+// Rebuild the client byte stream for each request and queue every bus
+// response in the simulated device. Responses on a session follow its
+// requests in order, which pairs them without ids.
+static bool loadCapture(const char* path, std::vector<ReplayRequest>& out, uint32_t& clock) {
+  FILE* f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "cannot open %s\n", path);
+    return false;
+  }
+
+  BridgeCaptureFileHeader fh;
+  if (fread(&fh, sizeof(fh), 1, f) != 1 || memcmp(fh.magic, BRIDGE_CAPTURE_MAGIC, 4) != 0 ||
+      fh.version != BRIDGE_CAPTURE_VERSION ||
+      fh.header_size != sizeof(BridgeCaptureRecordHeader)) {
+    fprintf(stderr, "%s: not a version %d bridge capture\n", path, BRIDGE_CAPTURE_VERSION);
+    fclose(f);
+    return false;
+  }
+  clock = fh.i2c_clock;
+
+  std::map<uint8_t, std::vector<size_t>> unanswered;  // Per session, oldest first
+  std::map<uint8_t, std::vector<uint8_t>> macroTx;     // Last macro step per session
+  BridgeCaptureRecordHeader hdr;
+  uint8_t payload[BRIDGE_CAPTURE_MAX_PAYLOAD];
+  uint32_t lastUs = 0;
+  uint64_t atUs = 0;
+  size_t orphans = 0;
+
+  while (readRecord(f, hdr, payload)) {
+    // Macro steps run on the bridge again when their MACRO_RUN is replayed;
+    // only their bus replies are needed
+    if (hdr.flags & BRIDGE_CAPTURE_FLAG_MACRO) {
+      std::vector<uint8_t>& tx = macroTx[hdr.session];
+      if (hdr.type == BRIDGE_CAPTURE_REQUEST) {
+        tx.assign(payload, payload + hdr.len);
+        continue;
+      }
+      SimWombatReply r = {};
+      r.status = (I2cStatus)hdr.status;
+      r.len = hdr.len;
+      memcpy(r.rx, payload, hdr.len);
+      r.bus_us = hdr.aux;
+      simWombatAddReply(hdr.addr, tx.data(), tx.size(), r);
+      continue;
+    }
+
+    if (hdr.type == BRIDGE_CAPTURE_REQUEST) {
+      // Timestamps are 32-bit micros(); accumulate deltas to survive the wrap
+      if (!out.empty()) {
+        int32_t delta = (int32_t)(hdr.t_us - lastUs);
+        if (delta > 0) atUs += (uint32_t)delta;
+      }
+      lastUs = hdr.t_us;
+
+      ReplayRequest req = {};
+      req.at_us = atUs;
+      req.session = hdr.session;
+      req.addr = hdr.addr;
+      req.v2 = hdr.flags & BRIDGE_CAPTURE_FLAG_V2;
+      if (req.v2) {
+        req.bytes[0] = hdr.addr;
+        req.bytes[1] = 0;
+        req.bytes[2] = 0;
+        req.bytes[3] = hdr.len;
+        req.bytes[4] = (uint8_t)hdr.aux;
+        memcpy(req.bytes + BRIDGE_V2_HDR_SIZE, payload, hdr.len);
+        req.len = BRIDGE_V2_HDR_SIZE + hdr.len;
+      } else {
+        memcpy(req.bytes, payload, hdr.len);
+        req.len = hdr.len;
+      }
+      unanswered[hdr.session].push_back(out.size());
+      out.push_back(req);
+      continue;
+    }
+
+    std::vector<size_t>& q = unanswered[hdr.session];
+    if (q.empty()) {
+      orphans++;
+      continue;
+    }
+    const ReplayRequest& req = out[q.front()];
+    q.erase(q.begin());
+    if (hdr.flags & BRIDGE_CAPTURE_FLAG_CONTROL) continue;
+
+    // Cache hits never reached the bus; they get model timing if replayed uncached
+    SimWombatReply r = {};
+    r.status = (I2cStatus)hdr.status;
+    r.len = hdr.len;
+    memcpy(r.rx, payload, hdr.len);
+    r.bus_us = (hdr.flags & BRIDGE_CAPTURE_FLAG_CACHED) ? 0 : hdr.aux;
+    const uint8_t* tx = req.v2 ? req.bytes + BRIDGE_V2_HDR_SIZE : req.bytes;
+    size_t txLen = req.v2 ? req.len - BRIDGE_V2_HDR_SIZE : req.len;
+    simWombatAddReply(hdr.addr, tx, txLen, r);
+  }
+  fclose(f);
+
+  if (orphans) fprintf(stderr, "warning: %zu responses without a request\n", orphans);
+  return true;
+}
+
+// ===================================================================================
+// Replay loop
+// ===================================================================================
+static int slotFor(std::map<uint8_t, int>& slots, uint8_t session) {
+  auto it = slots.find(session);
+  if (it != slots.end()) return it->second;
+
+  char peer[24];
+  snprintf(peer, sizeof(peer), "replay:%u", session);
+  int slot = BridgeEngine::getInstance().openSession(BridgeTransport::TCP, peer);
+  if (slot >= 0) slots[session] = slot;
+  return slot;
+}
+
+static bool engineIdle(BridgeEngine& engine, const std::map<uint8_t, int>& slots) {
+  if (engine.inflight() > 0) return false;
+  for (const auto& kv : slots) {
+    BridgeSession* s = engine.session(kv.second);
+    if (s && (!s->rx.empty() || s->tx_len > 0)) return false;
+  }
+  return true;
+}
+
+static void runReplay(const std::vector<ReplayRequest>& reqs, const ReplayOptions& opt) {
+  BridgeEngine& engine = BridgeEngine::getInstance();
+  BridgeStats& stats = BridgeStats::getInstance();
+  std::map<uint8_t, int> slots;
+  size_t next = 0;
+  size_t skipped = 0;
+  uint8_t current = reqs.empty() ? 0 : reqs[0].addr;
+  size_t batch = bridgeClampBatch(opt.batch);
+  uint32_t startUs = micros();
+
+  while (next < reqs.size() || !engineIdle(engine, slots)) {
+    stats.poll();
+    engine.collect();
+
+    // Feed due requests in capture order; a full ring stalls the replay the
+    // same way a blocked socket stalls a client
+    uint64_t elapsed = (uint32_t)(micros() - startUs);
+    while (next < reqs.size()) {
+      const ReplayRequest& req = reqs[next];
+      if (opt.speed > 0 && req.at_us / opt.speed > elapsed) break;
+
+      int slot = slotFor(slots, req.session);
+      if (slot < 0) {
+        skipped++;
+        next++;
+        continue;
+      }
+      size_t frames = 0;
+      int used = engine.parse(slot, req.bytes, req.len, frames);
+      if (used < 0) {
+        skipped++;
+        next++;
+        continue;
+      }
+      if (used == 0) break;
+      if (!req.v2) current = req.addr;
+      next++;
+    }
+
+    engine.dispatch(current, batch);
+
+    // Every response is sent the moment it is ready
+    for (const auto& kv : slots) {
+      BridgeSession* s = engine.session(kv.second);
+      if (s && s->tx_len > 0) engine.markFlushed(kv.second, s->tx_len);
+    }
+
+    if (engine.inflight() > 0) {
+      ulTaskNotifyTake(pdTRUE, 1);
+    } else if (next < reqs.size() && opt.speed > 0) {
+      vTaskDelay(1);
+    }
+  }
+
+  uint32_t wallUs = micros() - startUs;
+  if (skipped) fprintf(stderr, "warning: %zu requests skipped (session limit or bad frame)\n",
+                       skipped);
+
+  BridgeStatsSnapshot snap;
+  stats.snapshot(snap);
+  SimWombatStats bus = simWombatGetStats();
+  BridgeCacheStats cache = BridgeReadCache::getInstance().getStats();
+
+  printf("requests   %zu in %.3f s (%.0f frames/s)\n", reqs.size(), wallUs / 1e6,
+         wallUs ? snap.frames * 1e6 / wallUs : 0.0);
+  printf("sessions   %zu, batch %zu\n", slots.size(), batch);
+  printf("bus        %u transfers (%u replayed, %u modeled), %.1f%% busy\n", bus.transfers,
+         bus.replayed, bus.modeled, wallUs ? bus.bus_us * 100.0 / wallUs : 0.0);
+  printf("cache      %u hits, %u misses\n", cache.hits, cache.misses);
+  printf("\n%-10s %8s %8s %8s %8s %8s\n", "stage_us", "mean", "p50", "p90", "p99", "max");
+  for (size_t i = 0; i < (size_t)BridgeStage::COUNT; i++) {
+    const BridgeHistogram& h = snap.stages[i];
+    printf("%-10s %8llu %8u %8u %8u %8u\n", bridgeStageToStr((BridgeStage)i),
+           h.count ? (unsigned long long)(h.sum_us / h.count) : 0ULL, h.percentile(50),
+           h.percentile(90), h.percentile(99), h.max_us);
+  }
+}
+
+// ===================================================================================
+// Entry point
+// ===================================================================================
+static void usage() {
+  fprintf(stderr,
+          "usage: bridge_replay capture.wbc [--speed X] [--model] [--clock HZ] [--batch N] "
+          "[--cache MS]\n");
+}
+
+static bool parseArgs(int argc, char** argv, ReplayOptions& opt) {
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (strcmp(a, "--model") == 0) {
+      opt.model = true;
+    } else if (strcmp(a, "--speed") == 0 && hasValue) {
+      opt.speed = atof(argv[++i]);
+    } else if (strcmp(a, "--clock") == 0 && hasValue) {
+      opt.clock = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(a, "--batch") == 0 && hasValue) {
+      opt.batch = atoi(argv[++i]);
+    } else if (strcmp(a, "--cache") == 0 && hasValue) {
+      opt.cache_ms = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (a[0] != '-' && !opt.path) {
+      opt.path = a;
+    } else {
+      return false;
+    }
+  }
+  return opt.path != nullptr && opt.speed >= 0;
+}
+
+int main(int argc, char** argv) {
+  ReplayOptions opt;
+  if (!parseArgs(argc, argv, opt)) {
+    usage();
+    return 2;
+  }
+
+  std::vector<ReplayRequest> reqs;
+  uint32_t captureClock = 0;
+  if (!loadCapture(opt.path, reqs, captureClock)) return 1;
+
+  Wire.setClock(opt.clock ? opt.clock : captureClock);
+  simWombatUseModelTiming(opt.model);
+  BridgeReadCache::getInstance().configure(opt.cache_ms);
+
+  if (!I2cEngine::getInstance().begin(0, 10) ||
+      !BridgeEngine::getInstance().begin(xTaskGetCurrentTaskHandle())) {
+    fprintf(stderr, "engine start failed\n");
+    return 1;
+  }
+
+  runReplay(reqs, opt);
+  return 0;
+}
@@ -0,0 +1,22 @@
+#!/bin/sh
+# Build the bridge replay tool for the host (Linux/macOS, g++ or clang++).
+#   ./build.sh            -> ./bridge_replay
+#   CXX=clang++ ./build.sh
+set -e
+cd "$(dirname "$0")"
+
+SRC=../../src
+${CXX:-g++} -std=gnu++17 -O2 -Wall -pthread -I../host \
+  bridge_replay.cpp \
+  ../host/host_rtos.cpp \
+  ../host/sim_wombat.cpp \
+  $SRC/services/tcp_bridge/bridge_engine.cpp \
+  $SRC/services/tcp_bridge/bridge_macro.cpp \
+  $SRC/services/tcp_bridge/bridge_cache.cpp \
+  $SRC/services/tcp_bridge/bridge_capture.cpp \
+  $SRC/services/tcp_bridge/bridge_stats.cpp \
+  $SRC/services/i2c_manager/i2c_engine.cpp \
+  $SRC/services/i2c_manager/i2c_clock.cpp \
+  $SRC/services/i2c_manager/i2c_trace.cpp \
+  $SRC/core/i2c_monitor.cpp \
+  -o bridge_replay
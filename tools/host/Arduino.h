@@ -0,0 +1,36 @@
+/*
+ * Host Arduino Shim - Header
+ *
+ * Just enough of the Arduino/ESP32 API to build the bridge sources (bridge
+ * engine, TCP bridge, I2C engine) on Linux/macOS for tools and benchmarks.
+ * FreeRTOS primitives are emulated with threads (host_rtos.cpp), WiFi
+ * sockets with BSD sockets (host_wifi.cpp) and the I2C bus with a simulated
+ * SerialWombat (sim_wombat.h).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#ifdef __cplusplus
+#  include "WString.h"
+#endif
+
+// Monotonic time since process start
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// BSD string helper provided by the ESP32 newlib
+size_t hostStrlcpy(char* dst, const char* src, size_t size);
+#define strlcpy hostStrlcpy
@@ -0,0 +1,22 @@
+/*
+ * Host Arduino Shim - IPAddress
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "WString.h"
+
+class IPAddress {
+ public:
+  IPAddress() : addr_(0) {}
+  // Address in network byte order, as stored in sockaddr_in
+  explicit IPAddress(uint32_t addr) : addr_(addr) {}
+
+  uint32_t raw() const { return addr_; }
+  String toString() const;
+
+ private:
+  uint32_t addr_;
+};
@@ -0,0 +1,35 @@
+/*
+ * Host Arduino Shim - String
+ *
+ * Minimal Arduino String over std::string (construction, concatenation and
+ * c_str(), which is all the bridge sources use).
+ */
+
+#pragma once
+
+#include <string>
+
+class String {
+ public:
+  String() {}
+  String(const char* s) : s_(s ? s : "") {}
+  String(const std::string& s) : s_(s) {}
+  String(int v) : s_(std::to_string(v)) {}
+  String(unsigned int v) : s_(std::to_string(v)) {}
+  String(long v) : s_(std::to_string(v)) {}
+  String(unsigned long v) : s_(std::to_string(v)) {}
+
+  const char* c_str() const { return s_.c_str(); }
+  unsigned int length() const { return (unsigned int)s_.size(); }
+
+  String& operator+=(const String& rhs) {
+    s_ += rhs.s_;
+    return *this;
+  }
+  friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+  friend String operator+(const String& a, const char* b) { return String(a.s_ + b); }
+  bool operator==(const String& rhs) const { return s_ == rhs.s_; }
+
+ private:
+  std::string s_;
+};
@@ -0,0 +1,37 @@
+/*
+ * Host Arduino Shim - WiFiClient
+ *
+ * Non-blocking TCP connection over a BSD socket. Copies share the socket, as
+ * on the ESP32 core; it is closed by stop() or when the last copy goes away.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "IPAddress.h"
+
+class WiFiClient {
+ public:
+  WiFiClient() {}
+  explicit WiFiClient(int fd);
+
+  bool connected();
+  int available();
+  int read(uint8_t* buf, size_t size);
+  // Writes what the socket buffer accepts; returns bytes written
+  size_t write(const uint8_t* buf, size_t size);
+  void stop();
+  void setNoDelay(bool nodelay);
+
+  IPAddress remoteIP() const;
+  uint16_t remotePort() const;
+
+  explicit operator bool() const { return fd_ && *fd_ >= 0; }
+
+ private:
+  std::shared_ptr<int> fd_;
+};
@@ -0,0 +1,30 @@
+/*
+ * Host Arduino Shim - WiFiServer
+ *
+ * Non-blocking listening socket on all interfaces.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "WiFiClient.h"
+
+class WiFiServer {
+ public:
+  explicit WiFiServer(uint16_t port) : port_(port), fd_(-1), pending_(-1) {}
+  ~WiFiServer();
+
+  // Listen on port, or on the constructor's port when 0
+  void begin(uint16_t port = 0);
+  bool hasClient();
+  // Takes the connection found by hasClient()
+  WiFiClient available();
+
+  explicit operator bool() const { return fd_ >= 0; }
+
+ private:
+  uint16_t port_;
+  int fd_;
+  int pending_;
+};
@@ -0,0 +1,32 @@
+/*
+ * Host Arduino Shim - Wire
+ *
+ * Bus clock holder for the simulated SerialWombat. Transfers themselves go
+ * through i2cBusTransfer() (sim_wombat.cpp), as in the firmware.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+class TwoWire {
+ public:
+  TwoWire() : clock_(100000) {}
+
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) {
+    (void)sda;
+    (void)scl;
+    if (frequency) clock_ = frequency;
+    return true;
+  }
+  bool setClock(uint32_t frequency) {
+    if (frequency) clock_ = frequency;
+    return true;
+  }
+  uint32_t getClock() { return clock_; }
+
+ private:
+  uint32_t clock_;
+};
+
+extern TwoWire Wire;
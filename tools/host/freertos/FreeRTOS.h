@@ -0,0 +1,25 @@
+/*
+ * Host FreeRTOS Shim - Core types
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdFAIL pdFALSE
+
+// One tick is one millisecond, as on the ESP32 Arduino core
+#define portMAX_DELAY 0xFFFFFFFFUL
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#define portNUM_PROCESSORS 2
+#define configMAX_PRIORITIES 25
+#define tskNO_AFFINITY 0x7FFFFFFF
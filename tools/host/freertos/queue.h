@@ -0,0 +1,14 @@
+/*
+ * Host FreeRTOS Shim - Queues
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct HostQueue;
+typedef HostQueue* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks);
@@ -0,0 +1,14 @@
+/*
+ * Host FreeRTOS Shim - Mutexes
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct HostMutex;
+typedef HostMutex* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
@@ -0,0 +1,26 @@
+/*
+ * Host FreeRTOS Shim - Tasks and direct-to-task notifications
+ *
+ * Tasks run as threads. Priority is accepted and ignored; the core a task was
+ * pinned to is only reported back by xPortGetCoreID() (unpinned: core 0).
+ */
+
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xPortGetCoreID();
+TickType_t xTaskGetTickCount();
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
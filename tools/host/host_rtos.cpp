@@ -0,0 +1,199 @@
+/*
+ * Host FreeRTOS Shim - Implementation
+ *
+ * Threads, condition variables and timed mutexes standing in for FreeRTOS
+ * tasks, notifications, queues and mutexes.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Arduino.h"
+
+// ===================================================================================
+// Time
+// ===================================================================================
+static const auto s_epoch = std::chrono::steady_clock::now();
+
+unsigned long micros() {
+  auto d = std::chrono::steady_clock::now() - s_epoch;
+  return (unsigned long)(uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+unsigned long millis() {
+  auto d = std::chrono::steady_clock::now() - s_epoch;
+  return (unsigned long)(uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+  // Spin: sleep granularity on Linux is far coarser than a bus transfer
+  auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+  while (std::chrono::steady_clock::now() < until) {
+  }
+}
+
+size_t hostStrlcpy(char* dst, const char* src, size_t size) {
+  size_t len = strlen(src);
+  if (size) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+
+// Waits for pred with a FreeRTOS-style tick timeout; returns pred()
+template <typename Pred>
+static bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lock,
+                    TickType_t ticks, Pred pred) {
+  if (ticks == portMAX_DELAY) {
+    cv.wait(lock, pred);
+    return true;
+  }
+  return cv.wait_for(lock, std::chrono::milliseconds(ticks), pred);
+}
+
+// ===================================================================================
+// Tasks
+// ===================================================================================
+struct HostTask {
+  std::mutex mutex;
+  std::condition_variable cv;
+  uint32_t notify = 0;
+  BaseType_t core = 0;
+};
+
+static thread_local HostTask* t_current = nullptr;
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  // Threads not created through the shim (e.g. main) get a handle on first use
+  if (!t_current) t_current = new HostTask();
+  return t_current;
+}
+
+BaseType_t xPortGetCoreID() {
+  return xTaskGetCurrentTaskHandle()->core;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+  (void)name;
+  (void)stack;
+  (void)priority;
+
+  HostTask* task = new HostTask();
+  if (core >= 0 && core < portNUM_PROCESSORS) task->core = core;
+  if (handle) *handle = task;
+  std::thread([fn, arg, task]() {
+    t_current = task;
+    fn(arg);
+  }).detach();
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  // Tasks only delete others during failed start-up; leaking the handle is fine
+  (void)task;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)millis();
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  if (!task) return pdFAIL;
+  {
+    std::lock_guard<std::mutex> lock(task->mutex);
+    task->notify++;
+  }
+  task->cv.notify_one();
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  HostTask* self = xTaskGetCurrentTaskHandle();
+  std::unique_lock<std::mutex> lock(self->mutex);
+  if (!waitFor(self->cv, lock, ticks, [self]() { return self->notify > 0; })) return 0;
+
+  uint32_t value = self->notify;
+  self->notify = clearOnExit ? 0 : value - 1;
+  return value;
+}
+
+// ===================================================================================
+// Queues
+// ===================================================================================
+struct HostQueue {
+  std::mutex mutex;
+  std::condition_variable not_empty;
+  std::condition_variable not_full;
+  std::deque<std::vector<uint8_t>> items;
+  size_t length;
+  size_t item_size;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  HostQueue* q = new HostQueue();
+  q->length = length;
+  q->item_size = itemSize;
+  return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(q->mutex);
+  if (!waitFor(q->not_full, lock, ticks, [q]() { return q->items.size() < q->length; })) {
+    return pdFALSE;
+  }
+  const uint8_t* p = static_cast<const uint8_t*>(item);
+  q->items.emplace_back(p, p + q->item_size);
+  q->not_empty.notify_one();
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(q->mutex);
+  if (!waitFor(q->not_empty, lock, ticks, [q]() { return !q->items.empty(); })) {
+    return pdFALSE;
+  }
+  memcpy(item, q->items.front().data(), q->item_size);
+  q->items.pop_front();
+  q->not_full.notify_one();
+  return pdTRUE;
+}
+
+// ===================================================================================
+// Mutexes
+// ===================================================================================
+struct HostMutex {
+  std::timed_mutex mutex;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return new HostMutex();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+  if (ticks == portMAX_DELAY) {
+    sem->mutex.lock();
+    return pdTRUE;
+  }
+  return sem->mutex.try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  sem->mutex.unlock();
+  return pdTRUE;
+}
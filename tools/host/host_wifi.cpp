@@ -0,0 +1,146 @@
+/*
+ * Host Arduino Shim - WiFi sockets
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "Arduino.h"
+#include "WiFiServer.h"
+
+#ifndef MSG_NOSIGNAL
+#  define MSG_NOSIGNAL 0
+#endif
+
+static void setNonBlocking(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+// ===================================================================================
+// IPAddress
+// ===================================================================================
+String IPAddress::toString() const {
+  char buf[INET_ADDRSTRLEN];
+  struct in_addr a;
+  a.s_addr = addr_;
+  inet_ntop(AF_INET, &a, buf, sizeof(buf));
+  return String(buf);
+}
+
+// ===================================================================================
+// WiFiClient
+// ===================================================================================
+static void closeFd(int* fd) {
+  if (*fd >= 0) close(*fd);
+  delete fd;
+}
+
+WiFiClient::WiFiClient(int fd) : fd_(new int(fd), closeFd) {
+  setNonBlocking(fd);
+#ifdef SO_NOSIGPIPE
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+bool WiFiClient::connected() {
+  if (!*this) return false;
+  uint8_t b;
+  ssize_t n = recv(*fd_, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (n > 0) return true;
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+  return false;
+}
+
+int WiFiClient::available() {
+  if (!*this) return 0;
+  int n = 0;
+  if (ioctl(*fd_, FIONREAD, &n) < 0) return 0;
+  return n;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+  if (!*this) return -1;
+  ssize_t n = recv(*fd_, buf, size, MSG_DONTWAIT);
+  return n < 0 ? -1 : (int)n;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+  if (!*this) return 0;
+  ssize_t n = send(*fd_, buf, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+  return n < 0 ? 0 : (size_t)n;
+}
+
+void WiFiClient::stop() {
+  if (!*this) return;
+  close(*fd_);
+  *fd_ = -1;
+  fd_.reset();
+}
+
+void WiFiClient::setNoDelay(bool nodelay) {
+  if (!*this) return;
+  int v = nodelay ? 1 : 0;
+  setsockopt(*fd_, IPPROTO_TCP, TCP_NODELAY, &v, sizeof(v));
+}
+
+IPAddress WiFiClient::remoteIP() const {
+  struct sockaddr_in sa = {};
+  socklen_t len = sizeof(sa);
+  if (!fd_ || getpeername(*fd_, (struct sockaddr*)&sa, &len) < 0) return IPAddress();
+  return IPAddress(sa.sin_addr.s_addr);
+}
+
+uint16_t WiFiClient::remotePort() const {
+  struct sockaddr_in sa = {};
+  socklen_t len = sizeof(sa);
+  if (!fd_ || getpeername(*fd_, (struct sockaddr*)&sa, &len) < 0) return 0;
+  return ntohs(sa.sin_port);
+}
+
+// ===================================================================================
+// WiFiServer
+// ===================================================================================
+WiFiServer::~WiFiServer() {
+  if (pending_ >= 0) close(pending_);
+  if (fd_ >= 0) close(fd_);
+}
+
+void WiFiServer::begin(uint16_t port) {
+  if (fd_ >= 0) return;
+  if (port) port_ = port;
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return;
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in sa = {};
+  sa.sin_family = AF_INET;
+  sa.sin_addr.s_addr = htonl(INADDR_ANY);
+  sa.sin_port = htons(port_);
+  if (bind(fd, (struct sockaddr*)&sa, sizeof(sa)) < 0 || listen(fd, 8) < 0) {
+    close(fd);
+    return;
+  }
+  setNonBlocking(fd);
+  fd_ = fd;
+}
+
+bool WiFiServer::hasClient() {
+  if (pending_ < 0 && fd_ >= 0) pending_ = accept(fd_, nullptr, nullptr);
+  return pending_ >= 0;
+}
+
+WiFiClient WiFiServer::available() {
+  if (!hasClient()) return WiFiClient();
+  int fd = pending_;
+  pending_ = -1;
+  return WiFiClient(fd);
+}
@@ -0,0 +1,13 @@
+/*
+ * Host Shim - lwIP sockets
+ *
+ * lwIP's BSD socket API is the POSIX one.
+ */
+
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
@@ -0,0 +1,232 @@
+/*
+ * Simulated SerialWombat Bus - Implementation
+ */
+
+#include "sim_wombat.h"
+
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "Arduino.h"
+#include "Wire.h"
+
+TwoWire Wire;
+
+// SerialWombat packet commands understood by the model
+#define SW_CMD_READ_PIN_BUFFER 0x81
+#define SW_CMD_SET_PIN_BUFFER 0x82
+#define SW_CMD_VERSION 'V'
+#define SW_CMD_CONFIGURE_FIRST 200
+#define SW_CMD_CONFIGURE_LAST 219
+#define SW_PAD 0x55
+
+static std::mutex s_mutex;
+static std::map<std::string, std::deque<SimWombatReply>> s_replies;
+static SimWombatStats s_stats = {};
+static uint32_t s_command_us[256];
+static bool s_command_us_init = false;
+static bool s_model_timing = false;
+static uint16_t s_pins[SIM_WOMBAT_PINS];
+static uint32_t s_stable_hz = 0;
+static uint16_t s_fault_permille = 0;
+static uint32_t s_fault_rng = 0x12345678;
+
+static std::string replyKey(uint8_t addr, const uint8_t* tx, size_t txLen) {
+  std::string key(1, (char)addr);
+  key.append(reinterpret_cast<const char*>(tx), txLen);
+  return key;
+}
+
+// Caller holds s_mutex
+static void initCommandUs() {
+  if (s_command_us_init) return;
+  for (int i = 0; i < 256; i++) {
+    bool configure = i >= SW_CMD_CONFIGURE_FIRST && i <= SW_CMD_CONFIGURE_LAST;
+    s_command_us[i] =
+        configure ? SIM_WOMBAT_CONFIGURE_PROCESSING_US : SIM_WOMBAT_DEFAULT_PROCESSING_US;
+  }
+  s_command_us_init = true;
+}
+
+// Fault injection above the stable clock (bus callers only)
+static bool faultNow() {
+  if (!s_fault_permille || Wire.getClock() <= s_stable_hz) return false;
+  s_fault_rng ^= s_fault_rng << 13;
+  s_fault_rng ^= s_fault_rng >> 17;
+  s_fault_rng ^= s_fault_rng << 5;
+  return s_fault_rng % 1000 < s_fault_permille;
+}
+
+// ===================================================================================
+// Configuration
+// ===================================================================================
+void simWombatSetCommandUs(uint8_t cmd, uint32_t us) {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  initCommandUs();
+  s_command_us[cmd] = us;
+}
+
+void simWombatSetStableClock(uint32_t hz, uint16_t permille) {
+  s_stable_hz = hz;
+  s_fault_permille = permille;
+}
+
+void simWombatUseModelTiming(bool enable) {
+  s_model_timing = enable;
+}
+
+void simWombatAddReply(uint8_t addr, const uint8_t* tx, size_t txLen, const SimWombatReply& r) {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  s_replies[replyKey(addr, tx, txLen)].push_back(r);
+}
+
+uint32_t simWombatModelUs(const uint8_t* tx, size_t txLen, size_t rxLen) {
+  // START + address + data, repeated START + address + data, STOP
+  uint32_t bits = 2;
+  if (txLen) bits += (uint32_t)(1 + txLen) * 9;
+  if (rxLen) bits += (uint32_t)(1 + rxLen) * 9 + 1;
+
+  uint32_t clock = Wire.getClock() ? Wire.getClock() : 100000;
+  uint32_t processing = SIM_WOMBAT_DEFAULT_PROCESSING_US;
+  if (txLen) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    initCommandUs();
+    processing = s_command_us[tx[0]];
+  }
+  return (uint32_t)((uint64_t)bits * 1000000ULL / clock) + processing;
+}
+
+SimWombatStats simWombatGetStats() {
+  std::lock_guard<std::mutex> lock(s_mutex);
+  return s_stats;
+}
+
+// ===================================================================================
+// Device model
+// ===================================================================================
+// Caller holds s_mutex
+static void modelPacket(const uint8_t* tx, size_t txLen, SimWombatReply& r) {
+  r.status = I2cStatus::OK;
+  r.len = sizeof(r.rx);
+  memset(r.rx, SW_PAD, sizeof(r.rx));
+  if (txLen == 0) return;
+
+  memcpy(r.rx, tx, txLen < sizeof(r.rx) ? txLen : sizeof(r.rx));
+  uint8_t pin = txLen > 1 ? tx[1] : 0;
+  bool validPin = pin < SIM_WOMBAT_PINS;
+
+  switch (tx[0]) {
+    case SW_CMD_READ_PIN_BUFFER:
+      if (!validPin) break;
+      r.rx[2] = s_pins[pin] & 0xFF;
+      r.rx[3] = s_pins[pin] >> 8;
+      break;
+    case SW_CMD_SET_PIN_BUFFER:
+      if (validPin && txLen >= 4) s_pins[pin] = tx[2] | (tx[3] << 8);
+      break;
+    case SW_CMD_VERSION:
+      memcpy(r.rx, "VS18AB2", 7);
+      break;
+    default:
+      break;
+  }
+}
+
+// ===================================================================================
+// Bus HAL replacement
+// ===================================================================================
+I2cStatus i2cBusTransfer(uint8_t port, uint8_t addr, const uint8_t* tx, size_t txLen,
+                         uint8_t* rx, size_t rxLen, size_t& rxGot, uint32_t timeoutMs) {
+  (void)port;
+  (void)timeoutMs;
+
+  SimWombatReply reply = {};
+  bool replayed = false;
+  {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto it = s_replies.find(replyKey(addr, tx, txLen));
+    if (it != s_replies.end() && !it->second.empty()) {
+      reply = it->second.front();
+      it->second.pop_front();
+      replayed = true;
+    } else {
+      modelPacket(tx, txLen, reply);
+    }
+  }
+
+  uint32_t busUs =
+      (!s_model_timing && reply.bus_us) ? reply.bus_us : simWombatModelUs(tx, txLen, rxLen);
+  delayMicroseconds(busUs);
+  if (faultNow()) {
+    reply.status = I2cStatus::NACK;
+    reply.len = 0;
+  }
+
+  rxGot = reply.len < rxLen ? reply.len : rxLen;
+  memcpy(rx, reply.rx, rxGot);
+
+  std::lock_guard<std::mutex> lock(s_mutex);
+  s_stats.transfers++;
+  if (replayed) {
+    s_stats.replayed++;
+  } else {
+    s_stats.modeled++;
+  }
+  s_stats.bus_us += busUs;
+  return reply.status;
+}
+
+I2cStatus i2cBusProbe(uint8_t port, uint8_t addr, uint32_t timeoutMs) {
+  (void)port;
+  (void)addr;
+  (void)timeoutMs;
+  // Every address ACKs: the model stands in for whichever device is targeted
+  uint32_t clock = Wire.getClock() ? Wire.getClock() : 100000;
+  delayMicroseconds((uint32_t)(11ULL * 1000000ULL / clock));
+  return faultNow() ? I2cStatus::NACK : I2cStatus::OK;
+}
+
+void i2cBusSetPins(uint8_t port, int sda, int scl) {
+  (void)port;
+  (void)sda;
+  (void)scl;
+}
+
+// Nothing drives the simulated bus outside the HAL
+void i2cBusLock(uint8_t port) {
+  (void)port;
+}
+
+void i2cBusUnlock(uint8_t port) {
+  (void)port;
+}
+
+bool i2cBusClear(uint8_t port) {
+  (void)port;
+  // The model never holds SDA; a clear is 9 clocks and a STOP at 100 kHz
+  delayMicroseconds(100);
+  return true;
+}
+
+const char* i2cStatusToStr(I2cStatus s) {
+  switch (s) {
+    case I2cStatus::OK:
+      return "ok";
+    case I2cStatus::NACK:
+      return "nack";
+    case I2cStatus::TIMEOUT:
+      return "timeout";
+    case I2cStatus::BUS_ERROR:
+      return "bus_error";
+    case I2cStatus::ARB_LOST:
+      return "arb_lost";
+    case I2cStatus::SHORT_READ:
+      return "short_read";
+    case I2cStatus::BUS_STUCK:
+      return "bus_stuck";
+    default:
+      return "unknown";
+  }
+}
@@ -0,0 +1,69 @@
+/*
+ * Simulated SerialWombat Bus - Header
+ *
+ * Host replacement for the I2C bus HAL (hal/i2c/i2c_bus.h).
+ *
+ * Responses come from a replay table of recorded responses, keyed by target
+ * address and request bytes and consumed in recording order, when one
+ * matches. Otherwise a SerialWombat model answers: every packet echoes its
+ * command byte and pads with 0x55, 0x81/0x82 read and write a 16-bit public
+ * data value per pin, and 'V' returns a version string.
+ *
+ * Each transfer holds the calling thread for its bus time: the recorded time
+ * when available, otherwise 9 bit clocks per byte (including the address
+ * bytes) at Wire's clock plus the device's processing time for the command,
+ * during which a real SerialWombat stretches the clock.
+ *
+ * Address-only probes (i2cBusProbe) are ACKed for every address. The bus never
+ * gets stuck, so i2cBusClear() always succeeds.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../../src/hal/i2c/i2c_bus.h"
+
+// Device processing time for ordinary packets (us)
+#define SIM_WOMBAT_DEFAULT_PROCESSING_US 40
+
+// Pin mode configuration commands (200..219) re-initialise the pin (us)
+#define SIM_WOMBAT_CONFIGURE_PROCESSING_US 300
+
+// Pins modelled (SerialWombat 18AB)
+#define SIM_WOMBAT_PINS 20
+
+// Recorded outcome of one transfer
+struct SimWombatReply {
+  I2cStatus status;
+  uint8_t rx[32];
+  uint8_t len;
+  uint16_t bus_us;  // 0 = use the timing model
+};
+
+struct SimWombatStats {
+  uint32_t transfers;
+  uint32_t replayed;  // Answered from the replay table
+  uint32_t modeled;   // Answered by the device model
+  uint64_t bus_us;    // Total simulated bus time
+};
+
+// Processing time for one command byte (overrides the defaults above)
+void simWombatSetCommandUs(uint8_t cmd, uint32_t us);
+
+// Make transfers NACK with the given probability (per mille) while Wire's
+// clock is above hz, like a bus with too much capacitance (hz 0: at any
+// clock); permille 0 disables
+void simWombatSetStableClock(uint32_t hz, uint16_t permille);
+
+// Ignore recorded bus times and time every transfer with the model
+void simWombatUseModelTiming(bool enable);
+
+// Queue a recorded response for the next matching request
+void simWombatAddReply(uint8_t addr, const uint8_t* tx, size_t txLen, const SimWombatReply& r);
+
+// Bus time of one transfer under the timing model (us)
+uint32_t simWombatModelUs(const uint8_t* tx, size_t txLen, size_t rxLen);
+
+SimWombatStats simWombatGetStats();
@@ -0,0 +1,12 @@
+#!/bin/sh
+# Build the I2C trace benchmark for the host (Linux/macOS, g++ or clang++).
+#   ./build.sh            -> ./i2c_trace_bench
+#   CXX=clang++ ./build.sh
+set -e
+cd "$(dirname "$0")"
+
+SRC=../../src
+${CXX:-g++} -std=gnu++17 -O2 -Wall -pthread -I../host \
+  i2c_trace_bench.cpp \
+  $SRC/services/i2c_manager/i2c_trace.cpp \
+  -o i2c_trace_bench
@@ -0,0 +1,10 @@
+#!/bin/sh
+# Build the I2C trace dump tool for the host (Linux/macOS, g++ or clang++).
+#   ./build.sh            -> ./i2c_trace_dump
+#   CXX=clang++ ./build.sh
+set -e
+cd "$(dirname "$0")"
+
+${CXX:-g++} -std=gnu++17 -O2 -Wall \
+  i2c_trace_dump.cpp \
+  -o i2c_trace_dump
@@ -0,0 +1,129 @@
+/*
+ * I2C Trace Dump
+ *
+ * Reads an I2C transaction trace downloaded from /api/i2c/trace
+ * (src/services/i2c_manager/i2c_trace_format.h) and prints either every
+ * record or a per-device summary of transfer times, retries and failures:
+ *
+ *   i2c_trace_dump trace.wbt [--csv]
+ *
+ *   --csv   One line per record instead of the summary
+ *
+ *   curl -u admin:PASS -o trace.wbt http://DEVICE/api/i2c/trace
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "../../src/hal/i2c/i2c_bus.h"
+#include "../../src/services/i2c_manager/i2c_trace_format.h"
+
+static const char* const statusNames[] = {"OK",       "NACK",       "TIMEOUT",  "BUS_ERROR",
+                                          "ARB_LOST", "SHORT_READ", "BUS_STUCK"};
+#define STATUS_COUNT (sizeof(statusNames) / sizeof(statusNames[0]))
+
+static const char* statusName(uint8_t s) {
+  return s < STATUS_COUNT ? statusNames[s] : "UNKNOWN";
+}
+
+// Per-address totals
+struct DeviceSummary {
+  std::vector<uint16_t> dur_us;
+  uint32_t probes = 0;
+  uint32_t retries = 0;
+  uint32_t status[STATUS_COUNT + 1] = {0};  // Last slot: unknown codes
+};
+
+static bool readTrace(const char* path, I2cTraceFileHeader& hdr,
+                      std::vector<I2cTraceRecord>& records) {
+  FILE* f = fopen(path, "rb");
+  if (!f) return false;
+  bool ok = fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+            memcmp(hdr.magic, I2C_TRACE_MAGIC, sizeof(hdr.magic)) == 0 &&
+            hdr.version == I2C_TRACE_VERSION && hdr.record_size == sizeof(I2cTraceRecord);
+  I2cTraceRecord rec;
+  while (ok && fread(&rec, sizeof(rec), 1, f) == 1) records.push_back(rec);
+  fclose(f);
+  return ok;
+}
+
+static void printCsv(const std::vector<I2cTraceRecord>& records) {
+  printf("seq,t_us,dur_us,bus,addr,status,tx_len,rx_len,rx_got,attempts,tx,rx\n");
+  for (const auto& r : records) {
+    printf("%u,%u,%u,%u,0x%02X,%s,%u,%u,%u,%u,", r.seq, r.t_us, r.dur_us, i2cAddrBus(r.addr),
+           i2cAddr7(r.addr), statusName(r.status), r.tx_len, r.rx_len, r.rx_got, r.attempts);
+    for (int i = 0; i < I2C_TRACE_DATA_BYTES && i < r.tx_len; i++) printf("%02x", r.tx[i]);
+    printf(",");
+    for (int i = 0; i < I2C_TRACE_DATA_BYTES && i < r.rx_got; i++) printf("%02x", r.rx[i]);
+    printf("\n");
+  }
+}
+
+static uint16_t percentile(const std::vector<uint16_t>& sorted, int p) {
+  if (sorted.empty()) return 0;
+  return sorted[(sorted.size() - 1) * p / 100];
+}
+
+static void printSummary(const I2cTraceFileHeader& hdr,
+                         const std::vector<I2cTraceRecord>& records) {
+  uint32_t skipped = 0;
+  for (size_t i = 1; i < records.size(); i++) skipped += records[i].seq - records[i - 1].seq - 1;
+  uint32_t span = records.empty() ? 0 : records.back().t_us - records.front().t_us;
+
+  printf("records      %zu of %u since boot (ring %u), %u overwritten while reading\n",
+         records.size(), hdr.recorded, hdr.depth, skipped);
+  printf("span         %.3f s at %u Hz\n", span / 1e6, hdr.i2c_clock);
+
+  std::map<uint8_t, DeviceSummary> devices;
+  for (const auto& r : records) {
+    DeviceSummary& d = devices[r.addr];
+    if (r.tx_len == 0 && r.rx_len == 0) {
+      d.probes++;
+      continue;
+    }
+    d.dur_us.push_back(r.dur_us);
+    if (r.attempts > 1) d.retries += r.attempts - 1;
+    d.status[r.status < STATUS_COUNT ? r.status : STATUS_COUNT]++;
+  }
+
+  printf("\n%-10s %6s %6s %6s %6s %6s %6s %7s  %s\n", "device", "xfers", "probes", "p50",
+         "p90", "p99", "max", "retries", "failures");
+  for (auto& entry : devices) {
+    DeviceSummary& d = entry.second;
+    std::sort(d.dur_us.begin(), d.dur_us.end());
+    char name[16];
+    snprintf(name, sizeof(name), "%u:0x%02X", i2cAddrBus(entry.first), i2cAddr7(entry.first));
+    printf("%-10s %6zu %6u %6u %6u %6u %6u %7u ", name, d.dur_us.size(), d.probes,
+           percentile(d.dur_us, 50), percentile(d.dur_us, 90), percentile(d.dur_us, 99),
+           d.dur_us.empty() ? 0 : d.dur_us.back(), d.retries);
+    for (size_t s = 1; s <= STATUS_COUNT; s++) {
+      if (d.status[s]) printf(" %s=%u", statusName((uint8_t)s), d.status[s]);
+    }
+    printf("\n");
+  }
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2 || (argc == 3 && strcmp(argv[2], "--csv") != 0) || argc > 3) {
+    fprintf(stderr, "usage: i2c_trace_dump trace.wbt [--csv]\n");
+    return 2;
+  }
+
+  I2cTraceFileHeader hdr;
+  std::vector<I2cTraceRecord> records;
+  if (!readTrace(argv[1], hdr, records)) {
+    fprintf(stderr, "%s: not a version %d I2C trace\n", argv[1], I2C_TRACE_VERSION);
+    return 1;
+  }
+
+  if (argc == 3) {
+    printCsv(records);
+  } else {
+    printSummary(hdr, records);
+  }
+  return 0;
+}